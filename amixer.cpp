@@ -31,6 +31,13 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 ///      Ensure your compiler supports C++23 and is configured accordingly.
 
 #include "amixer.hpp"
+#include "amixer_balance.hpp"
+#include "amixer_health.hpp"
+#include "amixer_scheduler.hpp"
+#include "amixer_seqlock.hpp"
+#include "amixer_metrics.hpp"
+#include "amixer_probes.hpp"
+#include "amixer_trace.hpp"
 
 #include <string>
 #include <cstdio>
@@ -39,9 +46,92 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include <alsa/asoundlib.h>
 #include <print>
 #include <cmath>
+#include <cstdlib>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <chrono>
+#include <mutex>
+#include <optional>
+#include <map>
+#include <set>
+#include <functional>
+#include <future>
+#include <thread>
+#include <utility>
+#include <cerrno>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#include <expected>
+#include <system_error>
+
+/// @brief Table of ALSA simple mixer element functions for one stream direction.
+/// ALSA provides the same set of functions for playback and capture (snd_mixer_selem_*_playback_* and
+/// snd_mixer_selem_*_capture_*). The table lets the controllers and volumes work with both directions
+/// using the same code paths.
+struct SelemOps {
+    bool capture;
+    int (*hasVolume)(snd_mixer_elem_t *elem);
+    int (*hasSwitch)(snd_mixer_elem_t *elem);
+    int (*hasChannel)(snd_mixer_elem_t *elem, snd_mixer_selem_channel_id_t ch);
+    int (*isMono)(snd_mixer_elem_t *elem);
+    int (*getDbRange)(snd_mixer_elem_t *elem, long *min, long *max);
+    int (*getDb)(snd_mixer_elem_t *elem, snd_mixer_selem_channel_id_t ch, long *value);
+    int (*setDb)(snd_mixer_elem_t *elem, snd_mixer_selem_channel_id_t ch, long value, int dir);
+    int (*setDbAll)(snd_mixer_elem_t *elem, long value, int dir);
+    int (*askDbVolume)(snd_mixer_elem_t *elem, long dB, int dir, long *value);
+    int (*getVolumeRange)(snd_mixer_elem_t *elem, long *min, long *max);
+    int (*getVolume)(snd_mixer_elem_t *elem, snd_mixer_selem_channel_id_t ch, long *value);
+    int (*setVolume)(snd_mixer_elem_t *elem, snd_mixer_selem_channel_id_t ch, long value);
+    int (*setVolumeAll)(snd_mixer_elem_t *elem, long value);
+    int (*getSwitch)(snd_mixer_elem_t *elem, snd_mixer_selem_channel_id_t ch, int *value);
+    int (*setSwitchAll)(snd_mixer_elem_t *elem, int value);
+};
+
+/// @brief Playback (output) direction functions.
+static const SelemOps playbackOps{
+    false,
+    snd_mixer_selem_has_playback_volume,
+    snd_mixer_selem_has_playback_switch,
+    snd_mixer_selem_has_playback_channel,
+    snd_mixer_selem_is_playback_mono,
+    snd_mixer_selem_get_playback_dB_range,
+    snd_mixer_selem_get_playback_dB,
+    snd_mixer_selem_set_playback_dB,
+    snd_mixer_selem_set_playback_dB_all,
+    snd_mixer_selem_ask_playback_dB_vol,
+    snd_mixer_selem_get_playback_volume_range,
+    snd_mixer_selem_get_playback_volume,
+    snd_mixer_selem_set_playback_volume,
+    snd_mixer_selem_set_playback_volume_all,
+    snd_mixer_selem_get_playback_switch,
+    snd_mixer_selem_set_playback_switch_all,
+};
+
+/// @brief Capture (input) direction functions.
+static const SelemOps captureOps{
+    true,
+    snd_mixer_selem_has_capture_volume,
+    snd_mixer_selem_has_capture_switch,
+    snd_mixer_selem_has_capture_channel,
+    snd_mixer_selem_is_capture_mono,
+    snd_mixer_selem_get_capture_dB_range,
+    snd_mixer_selem_get_capture_dB,
+    snd_mixer_selem_set_capture_dB,
+    snd_mixer_selem_set_capture_dB_all,
+    snd_mixer_selem_ask_capture_dB_vol,
+    snd_mixer_selem_get_capture_volume_range,
+    snd_mixer_selem_get_capture_volume,
+    snd_mixer_selem_set_capture_volume,
+    snd_mixer_selem_set_capture_volume_all,
+    snd_mixer_selem_get_capture_switch,
+    snd_mixer_selem_set_capture_switch_all,
+};
 
 /// @brief Volume controller base class for different volume control methods (Decibel, Linear, Dummy).
-/// Each channel (left, right, mono) has its own controller instance.
+/// Each channel of the element (mono, front left/right, rear, center, woofer, side ...) has its own controller instance.
 /// The controller is created based on the capabilities of the ALSA mixer element.
 /// The controller provides methods to set and get volume in percentage (0..100).
 /// The actual implementation depends on the capabilities of the ALSA mixer element.
@@ -56,15 +146,65 @@ class VolumeController {
 protected:
     snd_mixer_elem_t *mixer_elem;
     snd_mixer_selem_channel_id_t channel;
+    const SelemOps &ops;
     
-    explicit VolumeController(snd_mixer_elem_t *elem, snd_mixer_selem_channel_id_t ch) : mixer_elem(elem), channel(ch) {}
+    explicit VolumeController(snd_mixer_elem_t *elem, snd_mixer_selem_channel_id_t ch, const SelemOps &ops) : mixer_elem(elem), channel(ch), ops(ops) {}
+
+    /// @brief Write raw value with set_volume probes around the ALSA call.
+    /// @param ch Channel written, SND_MIXER_SCHN_UNKNOWN for all channels
+    template <class Op>
+    int probedSet(snd_mixer_selem_channel_id_t ch, int volume, long raw, Op op) {
+        AMIXER_PROBE4(set_volume_entry, mixer_elem, static_cast<int>(ch), volume, raw);
+        int err = op();
+        AMIXER_PROBE3(set_volume_return, mixer_elem, static_cast<int>(ch), err);
+        return err;
+    }
+
+    /// @brief Read raw value with get_volume probes around the ALSA call.
+    template <class Op>
+    int probedGet(long &raw, Op op) {
+        AMIXER_PROBE2(get_volume_entry, mixer_elem, static_cast<int>(channel));
+        int err = op();
+        AMIXER_PROBE4(get_volume_return, mixer_elem, static_cast<int>(channel), raw, err);
+        return err;
+    }
 
 public:
-    static std::shared_ptr<VolumeController> create(snd_mixer_elem_t *elem, snd_mixer_selem_channel_id_t ch);
+    static std::shared_ptr<VolumeController> create(snd_mixer_elem_t *elem, snd_mixer_selem_channel_id_t ch, const SelemOps &ops = playbackOps);
 
     virtual ~VolumeController() = default;
-    virtual void setVolume(int volume) = 0; // 0..100 percentage
-    virtual int getVolume() = 0;            // 0..100 percentage
+
+    // Hardware access returns 0 on success or a negative ALSA error code.
+    virtual int setVolume(int volume) = 0;       // 0..100 percentage
+    virtual int getVolume(int &volume) = 0;      // 0..100 percentage
+
+    /// @brief Set the same volume on all channels of the element with a single control write.
+    /// @param volume Volume percentage (0..100)
+    /// @return 0 on success, negative ALSA error code on failure.
+    virtual int setVolumeAll(int volume) = 0;
+
+    /// @brief Get volume which is given number of dB louder or quieter than the volume.
+    /// @param volume Volume percentage (0..100)
+    /// @param gainDb Gain in dB, negative for attenuation
+    /// @return Volume percentage (0..100)
+    virtual int gainVolume(int volume, double gainDb) = 0;
+
+    /// @brief Get level of a volume on the dB scale of the element.
+    /// @param volume Volume percentage (0..100)
+    /// @return Level in 1/100 dB, or std::nullopt if the element has no dB scale.
+    virtual std::optional<long> volumeDb(int volume) = 0;
+
+    /// @brief Get volume of a level on the dB scale of the element.
+    /// @param dB Level in 1/100 dB
+    /// @return Volume percentage (0..100), or std::nullopt if the element has no dB scale.
+    virtual std::optional<int> dbVolume(long dB) = 0;
+
+    /// @brief Get raw control value written for a volume, for writes bypassing the simple mixer.
+    /// @param volume Volume percentage (0..100)
+    /// @return Raw value, or std::nullopt if the element has no volume range.
+    virtual std::optional<long> rawVolume(int volume) = 0;
+
+    snd_mixer_selem_channel_id_t getChannel() const { return channel; }
 };
 
 /// @brief Volume controller using Decibel scale.
@@ -76,9 +216,9 @@ private:
     long dbMax;
     long dbRange;
 public:
-    explicit VolumeControllerDb(snd_mixer_elem_t *elem, snd_mixer_selem_channel_id_t ch) : VolumeController(elem, ch), dbMin(0), dbMax(0), dbRange(0) {
+    explicit VolumeControllerDb(snd_mixer_elem_t *elem, snd_mixer_selem_channel_id_t ch, const SelemOps &ops) : VolumeController(elem, ch, ops), dbMin(0), dbMax(0), dbRange(0) {
         if (mixer_elem) {
-            if (snd_mixer_selem_get_playback_dB_range(elem, &dbMin, &dbMax) == 0) {
+            if (ops.getDbRange(elem, &dbMin, &dbMax) == 0) {
                 dbRange = dbMax - dbMin;
             } else {
                 dbMin = dbMax = dbRange = 0;
@@ -86,23 +226,59 @@ public:
         }
     }
 
-    void setVolume(int volume) override {
+    int setVolume(int volume) override {
         if (!mixer_elem || dbRange <= 0)
-            return;
+            return 0;
         double volumeNorm = std::clamp(volume/100.0, 0.0, 1.0); // 0..1
         long dB = dbMin + lround(volumeNorm * dbRange);
-        snd_mixer_selem_set_playback_dB(mixer_elem, channel, dB, 0);
+        return probedSet(channel, volume, dB, [&] { return ops.setDb(mixer_elem, channel, dB, 0); });
     }
 
-    int getVolume() override {
+    int setVolumeAll(int volume) override {
         if (!mixer_elem || dbRange <= 0)
             return 0;
-        long dB;
-        if (snd_mixer_selem_get_playback_dB(mixer_elem, channel, &dB) != 0)
+        double volumeNorm = std::clamp(volume/100.0, 0.0, 1.0); // 0..1
+        long dB = dbMin + lround(volumeNorm * dbRange);
+        return probedSet(SND_MIXER_SCHN_UNKNOWN, volume, dB, [&] { return ops.setDbAll(mixer_elem, dB, 0); });
+    }
+
+    int gainVolume(int volume, double gainDb) override {
+        if (dbRange <= 0)
+            return volume;
+        // dB range is in 1/100 dB units and percentage maps linearly to it
+        return std::clamp(volume + static_cast<int>(lround(gainDb * 10000.0 / dbRange)), 0, 100);
+    }
+
+    std::optional<long> volumeDb(int volume) override {
+        if (dbRange <= 0)
+            return std::nullopt;
+        return dbMin + lround(std::clamp(volume / 100.0, 0.0, 1.0) * dbRange);
+    }
+
+    std::optional<int> dbVolume(long dB) override {
+        if (dbRange <= 0)
+            return std::nullopt;
+        return std::clamp(static_cast<int>(lround(100.0 * static_cast<double>(dB - dbMin) / static_cast<double>(dbRange))), 0, 100);
+    }
+
+    std::optional<long> rawVolume(int volume) override {
+        auto dB = volumeDb(volume);
+        long raw = 0;
+        if (!mixer_elem || !dB || ops.askDbVolume(mixer_elem, *dB, 0, &raw) < 0)
+            return std::nullopt;
+        return raw;
+    }
+
+    int getVolume(int &volume) override {
+        volume = 0;
+        if (!mixer_elem || dbRange <= 0)
             return 0;
+        long dB = 0;
+        if (int err = probedGet(dB, [&] { return ops.getDb(mixer_elem, channel, &dB); }); err < 0)
+            return err;
         double volumeNorm = static_cast<double>(dB - dbMin) / static_cast<double>(dbRange);
-        int volume = std::clamp(static_cast<int>(lround(volumeNorm * 100.0)), 0, 100);
-        return volume;
+        volume = std::clamp(static_cast<int>(lround(volumeNorm * 100.0)), 0, 100);
+        return 0;
     }
 
 };
@@ -119,9 +295,9 @@ private:
     long volMax;
     long volRange;
 public:
-    explicit VolumeControllerLinear(snd_mixer_elem_t *elem, snd_mixer_selem_channel_id_t ch) : VolumeController(elem, ch), volMin(0), volMax(0), volRange(0) {
+    explicit VolumeControllerLinear(snd_mixer_elem_t *elem, snd_mixer_selem_channel_id_t ch, const SelemOps &ops) : VolumeController(elem, ch, ops), volMin(0), volMax(0), volRange(0) {
         if (mixer_elem) {
-            if (snd_mixer_selem_get_playback_volume_range(elem, &volMin, &volMax) == 0) {
+            if (ops.getVolumeRange(elem, &volMin, &volMax) == 0) {
                 volRange = volMax - volMin;
             } else {
                 volMin = volMax = volRange = 0;
@@ -129,23 +305,46 @@ public:
         }
     }
 
-    void setVolume(int volume) override {
+    int setVolume(int volume) override {
         if (!mixer_elem || volRange <= 0)
-            return;
+            return 0;
         double volumeNorm = std::clamp(volume/100.0, 0.0, 1.0); // 0..1
         long vol = volMin + lround(volumeNorm * volRange);
-        snd_mixer_selem_set_playback_volume(mixer_elem, channel, vol);
+        return probedSet(channel, volume, vol, [&] { return ops.setVolume(mixer_elem, channel, vol); });
     }
 
-    int getVolume() override {
+    int setVolumeAll(int volume) override {
         if (!mixer_elem || volRange <= 0)
             return 0;
-        long vol;
-        if (snd_mixer_selem_get_playback_volume(mixer_elem, channel, &vol) != 0)
+        double volumeNorm = std::clamp(volume/100.0, 0.0, 1.0); // 0..1
+        long vol = volMin + lround(volumeNorm * volRange);
+        return probedSet(SND_MIXER_SCHN_UNKNOWN, volume, vol, [&] { return ops.setVolumeAll(mixer_elem, vol); });
+    }
+
+    int gainVolume(int volume, double gainDb) override {
+        // treat raw linear volume as amplitude
+        return std::clamp(static_cast<int>(lround(volume * std::pow(10.0, gainDb / 20.0))), 0, 100);
+    }
+
+    std::optional<long> volumeDb([[maybe_unused]] int volume) override { return std::nullopt; }
+    std::optional<int> dbVolume([[maybe_unused]] long dB) override { return std::nullopt; }
+
+    std::optional<long> rawVolume(int volume) override {
+        if (!mixer_elem || volRange <= 0)
+            return std::nullopt;
+        return volMin + lround(std::clamp(volume / 100.0, 0.0, 1.0) * volRange);
+    }
+
+    int getVolume(int &volume) override {
+        volume = 0;
+        if (!mixer_elem || volRange <= 0)
             return 0;
+        long vol = 0;
+        if (int err = probedGet(vol, [&] { return ops.getVolume(mixer_elem, channel, &vol); }); err < 0)
+            return err;
         double volumeNorm = static_cast<double>(vol - volMin) / static_cast<double>(volRange);
-        int volume = std::clamp(static_cast<int>(lround(volumeNorm * 100.0)), 0, 100);
-        return volume;
+        volume = std::clamp(static_cast<int>(lround(volumeNorm * 100.0)), 0, 100);
+        return 0;
     }
 };
 
@@ -156,86 +355,752 @@ public:
 /// Note: This controller is not very useful in practice, but it provides a fallback mechanism.
 class VolumeControllerDummy : public VolumeController {
 public:
-    explicit VolumeControllerDummy(snd_mixer_elem_t *elem, snd_mixer_selem_channel_id_t ch) : VolumeController(elem, ch) {}
-    void setVolume([[maybe_unused]] int volume) override {}
-    int getVolume() override { 
-        return 0; 
+    explicit VolumeControllerDummy(snd_mixer_elem_t *elem, snd_mixer_selem_channel_id_t ch, const SelemOps &ops) : VolumeController(elem, ch, ops) {}
+    int setVolume([[maybe_unused]] int volume) override { return 0; }
+    int setVolumeAll([[maybe_unused]] int volume) override { return 0; }
+    int gainVolume(int volume, [[maybe_unused]] double gainDb) override {
+        return volume;
+    }
+    std::optional<long> volumeDb([[maybe_unused]] int volume) override { return std::nullopt; }
+    std::optional<int> dbVolume([[maybe_unused]] long dB) override { return std::nullopt; }
+    std::optional<long> rawVolume([[maybe_unused]] int volume) override { return std::nullopt; }
+    int getVolume(int &volume) override {
+        volume = 0;
+        return 0;
     }
 };
 
 /// @brief Factory method to create appropriate VolumeController based on ALSA mixer element capabilities.
 /// @param elem ALSA mixer element
 /// @param ch ALSA channel ID
+/// @param ops ALSA functions for the direction (playbackOps or captureOps)
 /// @return Shared pointer to VolumeController instance (e.g. VolumeControllerDb, VolumeControllerLinear, or VolumeControllerDummy)
-std::shared_ptr<VolumeController> VolumeController::create(snd_mixer_elem_t *elem, snd_mixer_selem_channel_id_t ch) {
+std::shared_ptr<VolumeController> VolumeController::create(snd_mixer_elem_t *elem, snd_mixer_selem_channel_id_t ch, const SelemOps &ops) {
     if (!elem)
-        return std::shared_ptr<VolumeController>(new VolumeControllerDummy(elem, ch));
+        return std::shared_ptr<VolumeController>(new VolumeControllerDummy(elem, ch, ops));
     long dBMin, dBMax;
-    if (snd_mixer_selem_get_playback_dB_range(elem, &dBMin, &dBMax) == 0 && dBMax > dBMin) {
-        return std::shared_ptr<VolumeController>(new VolumeControllerDb(elem, ch));
+    if (ops.getDbRange(elem, &dBMin, &dBMax) == 0 && dBMax > dBMin) {
+        return std::shared_ptr<VolumeController>(new VolumeControllerDb(elem, ch, ops));
     }
     long volMin, volMax;
-    if (snd_mixer_selem_get_playback_volume_range(elem, &volMin, &volMax) == 0 && volMax > volMin) {
-        return std::shared_ptr<VolumeController>(new VolumeControllerLinear(elem, ch));
+    if (ops.getVolumeRange(elem, &volMin, &volMax) == 0 && volMax > volMin) {
+        return std::shared_ptr<VolumeController>(new VolumeControllerLinear(elem, ch, ops));
     }
-    return std::shared_ptr<VolumeController>(new VolumeControllerDummy(elem, ch));
+    return std::shared_ptr<VolumeController>(new VolumeControllerDummy(elem, ch, ops));
 }
 
+/// @brief Find the control element behind one direction of a simple mixer element.
+/// Simple elements are built from controls named e.g. "Master Playback Volume" or "Capture Volume".
+/// @return Control element, or nullptr if not found.
+static snd_hctl_elem_t *volumeControl(snd_hctl_t *hctl, snd_mixer_elem_t *elem, bool capture)
+{
+    std::string name = snd_mixer_selem_get_name(elem);
+    snd_ctl_elem_id_t *id;
+    snd_ctl_elem_id_alloca(&id);
+    snd_ctl_elem_id_set_interface(id, SND_CTL_ELEM_IFACE_MIXER);
+    snd_ctl_elem_id_set_index(id, snd_mixer_selem_get_index(elem));
+    for (const char *suffix : {capture ? " Capture Volume" : " Playback Volume", " Volume"})
+    {
+        snd_ctl_elem_id_set_name(id, (name + suffix).c_str());
+        if (auto *control = snd_hctl_find_elem(hctl, id))
+            return control;
+    }
+    return nullptr;
+}
+
+/// @brief Mutex serializing access to ALSA mixer handle of a card.
+/// ALSA mixer handles are not thread safe, and the volumes are accessed both from the caller threads
+/// and from the Scheduler threads (fades). Each card has its own mixer handle, so different cards
+/// can be accessed in parallel. The mutex is recursive, so public methods may call each other.
+/// @param card ALSA card number
+static std::recursive_mutex &cardMutex(int card)
+{
+    static std::array<std::recursive_mutex, 32> mutexes; // SNDRV_CARDS
+    return mutexes[static_cast<unsigned>(card) % mutexes.size()];
+}
+
+/// @brief Lock of a card mutex, counting the card mutexes held by the calling thread.
+/// The count lets CardLock::sleep() release the mutex while a call waits out a transient card error.
+/// Pinned locks are never released: they are taken on the event thread, around event dispatch and
+/// card moves, which must not interleave with other callers.
+class CardLock {
+public:
+    enum Mode { Releasable, Pinned };
+
+    explicit CardLock(int card, Mode mode = Releasable) : slot(static_cast<unsigned>(card) % 32), mode(mode) {
+        cardMutex(card).lock();
+        enter();
+    }
+
+    /// @brief Take over a card mutex already locked by the calling thread (e.g. by std::lock()).
+    CardLock(int card, Mode mode, std::adopt_lock_t) : slot(static_cast<unsigned>(card) % 32), mode(mode) {
+        enter();
+    }
+
+    ~CardLock() {
+        --held.depth[slot];
+        --held.total;
+        if (mode == Pinned)
+            --held.pinned;
+        cardMutex(static_cast<int>(slot)).unlock();
+    }
+
+    CardLock(const CardLock &) = delete;
+    CardLock &operator=(const CardLock &) = delete;
+
+    /// @brief Check whether the calling thread holds the mutex of a card.
+    static bool isHeld(int card) {
+        return held.depth[static_cast<unsigned>(card) % 32] > 0;
+    }
+
+    /// @brief Sleep, releasing the mutex of the card meanwhile.
+    /// The mutex stays locked if the calling thread holds a pinned lock or the mutex of another card,
+    /// as releasing one of several mutexes and locking it again could deadlock.
+    /// @return true if the mutex has been released, so the state it protects may have changed.
+    static bool sleep(int card, std::chrono::nanoseconds delay) {
+        auto slot = static_cast<unsigned>(card) % 32;
+        unsigned depth = held.depth[slot];
+        if (held.pinned || depth == 0 || depth != held.total) {
+            std::this_thread::sleep_for(delay);
+            return false;
+        }
+        for (unsigned i = 0; i < depth; ++i)
+            cardMutex(card).unlock();
+        std::this_thread::sleep_for(delay);
+        for (unsigned i = 0; i < depth; ++i)
+            cardMutex(card).lock();
+        return true;
+    }
+
+private:
+    struct Held {
+        std::array<unsigned, 32> depth{}; // SNDRV_CARDS
+        unsigned total{0};
+        unsigned pinned{0};
+    };
+    static thread_local Held held;
+
+    unsigned slot;
+    Mode mode;
+
+    void enter() {
+        ++held.depth[slot];
+        ++held.total;
+        if (mode == Pinned)
+            ++held.pinned;
+    }
+};
+
+thread_local CardLock::Held CardLock::held;
+
+/// @brief Published state of all channels of the mixer.
+/// Volume setters publish the resulting state here, and IMixer::getSnapshot() copies it under the
+/// sequence lock, so readers never block writers and never touch ALSA. Writers from different
+/// card threads are serialized by a mutex, which readers never take.
+class StateTable {
+public:
+    struct Entry {
+        std::atomic<int> volume{0};
+        std::atomic<int> balance{0};
+        std::atomic<bool> muted{false};
+        std::atomic<std::uint64_t> generation{0};
+    };
+
+    explicit StateTable(std::size_t size) : entries(size) {}
+
+    /// @brief Publish state of one channel; bumps generations only if the state has changed.
+    /// @return true if the state has changed.
+    bool publish(std::size_t index, int volume, int balance, bool muted) {
+        std::lock_guard guard(writeMutex);
+        auto &entry = entries[index];
+        if (entry.volume.load(std::memory_order_relaxed) == volume &&
+            entry.balance.load(std::memory_order_relaxed) == balance &&
+            entry.muted.load(std::memory_order_relaxed) == muted)
+            return false;
+        lock.write([&] {
+            auto next = generation.load(std::memory_order_relaxed) + 1;
+            entry.volume.store(volume, std::memory_order_relaxed);
+            entry.balance.store(balance, std::memory_order_relaxed);
+            entry.muted.store(muted, std::memory_order_relaxed);
+            entry.generation.store(next, std::memory_order_relaxed);
+            generation.store(next, std::memory_order_relaxed);
+        });
+        return true;
+    }
+
+    /// @brief Copy consistent state of one channel.
+    /// @param index Entry index
+    /// @param channel Snapshot with volume already set
+    void readOne(std::size_t index, ChannelSnapshot &channel) const {
+        const auto &entry = entries[index];
+        lock.read([&] {
+            channel.volumeLevel = entry.volume.load(std::memory_order_relaxed);
+            channel.balance = entry.balance.load(std::memory_order_relaxed);
+            channel.muted = entry.muted.load(std::memory_order_relaxed);
+            channel.generation = entry.generation.load(std::memory_order_relaxed);
+        });
+    }
+
+    /// @brief Get published mute state of one channel.
+    bool isMuted(std::size_t index) const {
+        return entries[index].muted.load(std::memory_order_relaxed);
+    }
+
+    /// @brief Hook called after state of an entry has changed, set once by the mixer.
+    std::function<void(std::size_t)> onChange;
+
+    /// @brief Copy consistent state of channels changed after the generation.
+    /// @param channels Channel list of all entries, with volume set
+    /// @param since Generation of the previous query
+    /// @param snapshot Snapshot to fill with current generation and changed channels
+    void readChanged(const std::vector<ChannelSnapshot> &channels, std::uint64_t since, MixerSnapshot &snapshot) const {
+        snapshot.channels.reserve(entries.size());
+        lock.read([&] {
+            snapshot.channels.clear();
+            for (std::size_t i = 0; i < entries.size(); ++i) {
+                auto changed = entries[i].generation.load(std::memory_order_relaxed);
+                if (changed <= since)
+                    continue;
+                auto &channel = snapshot.channels.emplace_back(channels[i]);
+                channel.volumeLevel = entries[i].volume.load(std::memory_order_relaxed);
+                channel.balance = entries[i].balance.load(std::memory_order_relaxed);
+                channel.muted = entries[i].muted.load(std::memory_order_relaxed);
+                channel.generation = changed;
+            }
+            snapshot.generation = generation.load(std::memory_order_relaxed);
+        });
+    }
+
+    /// @brief Copy consistent state of all channels into the snapshot.
+    /// @param snapshot Snapshot with channels[i].volume already set for every entry
+    void read(MixerSnapshot &snapshot) const {
+        lock.read([&] {
+            for (std::size_t i = 0; i < entries.size(); ++i) {
+                auto &channel = snapshot.channels[i];
+                channel.volumeLevel = entries[i].volume.load(std::memory_order_relaxed);
+                channel.balance = entries[i].balance.load(std::memory_order_relaxed);
+                channel.muted = entries[i].muted.load(std::memory_order_relaxed);
+                channel.generation = entries[i].generation.load(std::memory_order_relaxed);
+            }
+            snapshot.generation = generation.load(std::memory_order_relaxed);
+        });
+    }
+
+private:
+    std::vector<Entry> entries;
+    SeqLock lock;
+    std::mutex writeMutex;
+    std::atomic<std::uint64_t> generation{0};
+};
+
 /// @brief ALSA Volume implementation
 /// This class implements the IVolume interface using ALSA mixer elements.
-/// It supports setting and getting volume and balance for stereo and mono channels.
-/// It uses VolumeController instances for each channel (left, right, mono) to handle the actual volume control.
-class AMVolume : public IVolume {
+/// It supports setting and getting volume and balance for mono, stereo and multichannel (5.1, 7.1) elements,
+/// both for playback (output) and capture (input) direction of the element.
+/// Every channel of the direction reported by the element gets its own VolumeController instance,
+/// stored in a compact array in ALSA channel order (front left, front right, rear left, ...).
+/// Balance is applied to the left side channels (front/rear/side left) against the right side ones,
+/// while center and woofer channels always follow the overall volume.
+///
+/// Mute uses the element switch when available, so the volume levels stay untouched in hardware.
+/// Elements without a switch are muted by writing zero volume, while the levels are held in memory
+/// and reported by getVolume()/getBalance() as if the element was not muted.
+class AMVolume : public IVolume, public std::enable_shared_from_this<AMVolume> {
 private:
     std::string name;
     bool hasLeft{false};
     bool hasRight{false};
 
-    int card;
+    std::atomic<int> card; // changes only when a removed card reappears under another number
 
-    std::shared_ptr<VolumeController> leftVolumeController;
-    std::shared_ptr<VolumeController> rightVolumeController;
-    std::shared_ptr<VolumeController> monoVolumeController;
+    snd_mixer_elem_t *mixer_elem; // nullptr while the card is gone
+    const SelemOps &ops;
+    std::vector<std::shared_ptr<VolumeController>> controllers; // one per channel, in ALSA channel order
+    std::vector<int> known;                  // last levels read from or written to hardware, per channel
+    BalanceSetting balanceSetting;           // balance kept while only the volume is set
 
-public:
-    AMVolume(int card, snd_mixer_elem_t *elem) : card(card) {
-        name=snd_mixer_selem_get_name(elem);
-        hasLeft = snd_mixer_selem_has_playback_channel(elem, SND_MIXER_SCHN_FRONT_LEFT);
-        hasRight = snd_mixer_selem_has_playback_channel(elem, SND_MIXER_SCHN_FRONT_RIGHT);
-        leftVolumeController = VolumeController::create(elem, SND_MIXER_SCHN_FRONT_LEFT);
-        rightVolumeController = VolumeController::create(elem, SND_MIXER_SCHN_FRONT_RIGHT);
-        monoVolumeController = VolumeController::create(elem, SND_MIXER_SCHN_MONO);
+    // control element behind the volume, written in one piece; nullptr to write through the simple mixer
+    snd_hctl_elem_t *control{nullptr};
+    // the control has been written and the simple mixer caches the old value until the ALSA event
+    bool controlWritten{false};
+
+    static constexpr auto fadeStepInterval = std::chrono::milliseconds(5); // until the card latency is measured
+
+    bool muted{false};                       // mute state while levels are held
+    std::optional<std::vector<int>> held;    // levels held in memory while soft muted or fading
+    bool fading{false};                      // mute/unmute fade in progress
+    double fadeLevel{1.0};                   // fraction of held levels currently written to hardware
+    double fadeDelta{0.0};                   // fadeLevel change per fade step
+    std::uint64_t fadeGeneration{0};         // incremented by every setMute(), stops outdated fades
+    Scheduler::Clock::duration fadeInterval{fadeStepInterval}; // step interval of the fade, per card latency
+
+    static constexpr auto writeEventTimeout = std::chrono::milliseconds(200); // longer is not a round trip
+
+    // start of the oldest library write whose ALSA event has not arrived, in clock ticks, 0 if none
+    std::atomic<Scheduler::Clock::rep> writtenAt{0};
+
+    StateTable *stateTable{nullptr};
+    std::size_t stateIndex{0};
+    Metrics::Id metricsId;
+
+    /// @brief Find index of controller for given ALSA channel.
+    /// @return Index into controllers, or controllers.size() if the element does not have such channel.
+    std::size_t indexOf(snd_mixer_selem_channel_id_t ch) const {
+        for (std::size_t i = 0; i < controllers.size(); ++i) {
+            if (controllers[i]->getChannel() == ch)
+                return i;
+        }
+        return controllers.size();
     }
 
-    /// @brief Set volume for the channel.
-    /// If the channel is stereo (has both left and right), the volume is set according to the current balance.
-    /// If the channel is mono, the volume is set directly.
-    /// @param volume Volume percentage (0..100)
-    void setVolume(int volume) override {
+    /// @brief Lock the mutex of the card of the volume.
+    /// reattach() may move the volume to another card while the caller waits for the mutex of the old
+    /// card, so the card is checked again once the mutex is locked.
+    CardLock lockCard() {
+        for (;;) {
+            int current = card.load();
+            cardMutex(current).lock();
+            if (card.load() == current)
+                return CardLock(current, CardLock::Releasable, std::adopt_lock);
+            cardMutex(current).unlock();
+        }
+    }
 
-        volume = std::clamp(volume, 0, 100);
-        if (hasLeft && hasRight) {
-            auto balance = getBalance();                         // -100..100
-            double balanceNorm = 1.0 - (abs(balance) / 100.0); // 0..1
-
-            if (balance < 0) {
-                // left louder
-                leftVolumeController->setVolume(volume);
-                rightVolumeController->setVolume(lround(volume * balanceNorm));
+    /// @brief Check whether the element has a switch; called with the card mutex locked.
+    bool hasSwitchLocked() const {
+        return mixer_elem && ops.hasSwitch(mixer_elem);
+    }
+
+    /// @brief Run ALSA call through the health state of the card, recording its metrics and trace events.
+    /// Retries wait with the card mutex released (see CardLock::sleep()); a retry is dropped when the
+    /// volume has been detached or moved meanwhile, and later calls of the same operation fail with
+    /// ENODEV if the volume is no longer on the card whose mutex the caller holds.
+    template <class Op>
+    int alsa(Metrics::Kind kind, Op &&op) {
+        int current = card.load();
+        if (!CardLock::isHeld(current))
+            return -ENODEV;
+        return CardHealthState::of(current).call([&] {
+            auto start = Scheduler::Clock::now();
+            int err = op();
+            auto latency = Scheduler::Clock::now() - start;
+            if (kind == Metrics::Write && err >= 0) {
+                Scheduler::Clock::rep none = 0;
+                writtenAt.compare_exchange_strong(none, start.time_since_epoch().count());
             }
-            else if (balance > 0) {
-                // right louder
-                leftVolumeController->setVolume(lround(volume * balanceNorm));
-                rightVolumeController->setVolume(volume);
+            Metrics::instance().record(metricsId, kind, latency, err >= 0);
+            Trace::instance().record(kind == Metrics::Write ? "write" : "read", "alsa", start, latency, card, err, name.c_str());
+            return err;
+        }, [&](Scheduler::Clock::duration delay) {
+            auto elem = mixer_elem;
+            return !CardLock::sleep(current, delay) || (card.load() == current && mixer_elem == elem);
+        });
+    }
+
+    static std::error_code errorCode(int err) {
+        return std::error_code(-err, std::generic_category());
+    }
+
+    /// @brief Read channel levels from hardware.
+    /// Channels which cannot be read report their last known level rather than zero.
+    /// @return 0 on success, negative ALSA error code of the first failed read.
+    int readHardware(std::span<int> volumes) {
+        if (controlWritten) {
+            auto count = std::min(volumes.size(), known.size());
+            std::copy_n(known.begin(), count, volumes.begin());
+            return 0;
+        }
+        int result = 0;
+        auto count = std::min(volumes.size(), controllers.size());
+        for (std::size_t i = 0; i < count; ++i) {
+            int err = alsa(Metrics::Read, [&] { return controllers[i]->getVolume(volumes[i]); });
+            if (err < 0) {
+                volumes[i] = known[i];
+                result = result < 0 ? result : err;
             } else {
-                // balanced
-                leftVolumeController->setVolume(volume);
-                rightVolumeController->setVolume(volume);
+                known[i] = volumes[i];
+            }
+        }
+        return result;
+    }
+
+    /// @brief Write channel levels to the control element behind the volume with a single write.
+    /// Channels missing in volumes are written with their last known level.
+    /// @return 0 on success, negative ALSA error code on failure.
+    int writeControl(std::span<const int> volumes) {
+        std::vector<int> levels(known);
+        for (std::size_t i = 0; i < std::min(volumes.size(), levels.size()); ++i)
+            levels[i] = std::clamp(volumes[i], 0, 100);
+
+        snd_ctl_elem_value_t *value;
+        snd_ctl_elem_value_alloca(&value);
+        long first = 0;
+        for (std::size_t i = 0; i < controllers.size(); ++i) {
+            auto raw = controllers[i]->rawVolume(levels[i]);
+            if (!raw)
+                return -EINVAL; // checked by bindControl(), the element cannot lose its range
+            snd_ctl_elem_value_set_integer(value, controllers[i]->getChannel(), *raw);
+            if (i == 0)
+                first = *raw;
+        }
+
+        AMIXER_PROBE4(set_volume_entry, mixer_elem, static_cast<int>(SND_MIXER_SCHN_UNKNOWN), levels.front(), first);
+        int err = alsa(Metrics::Write, [&] { return snd_hctl_elem_write(control, value); });
+        AMIXER_PROBE3(set_volume_return, mixer_elem, static_cast<int>(SND_MIXER_SCHN_UNKNOWN), err);
+        if (err >= 0) {
+            known = std::move(levels);
+            controlWritten = true;
+        }
+        return err < 0 ? err : 0;
+    }
+
+    /// @brief Bind the control element behind the volume, for writes of all channels in one piece.
+    /// Left unbound (writes go through the simple mixer) unless the control is an integer control
+    /// whose values are exactly the channels of the volume, each with a raw volume range.
+    void bindControl(snd_hctl_t *hctl) {
+        control = nullptr;
+        controlWritten = false;
+        auto *candidate = hctl && mixer_elem ? volumeControl(hctl, mixer_elem, ops.capture) : nullptr;
+        if (!candidate)
+            return;
+        snd_ctl_elem_info_t *info;
+        snd_ctl_elem_info_alloca(&info);
+        if (snd_hctl_elem_info(candidate, info) < 0 || snd_ctl_elem_info_get_type(info) != SND_CTL_ELEM_TYPE_INTEGER ||
+            snd_ctl_elem_info_get_count(info) != controllers.size())
+            return;
+        for (const auto &controller : controllers) {
+            if (static_cast<std::size_t>(controller->getChannel()) >= controllers.size() || !controller->rawVolume(0))
+                return;
+        }
+        control = candidate;
+    }
+
+    /// @brief Write channel levels to hardware.
+    /// With the control element bound, all channels go out in one control write. Otherwise, when all
+    /// channels get the same value, a single control write is issued for the whole element, and
+    /// channels with different values are written one by one, skipping those already at their value.
+    /// @return 0 on success, negative ALSA error code of the first failed write.
+    int writeHardware(std::span<const int> volumes) {
+        if (volumes.empty() || controllers.empty())
+            return 0;
+        if (control)
+            return writeControl(volumes);
+
+        auto count = std::min(volumes.size(), controllers.size());
+        bool uniform = count == controllers.size() &&
+            std::ranges::all_of(volumes.first(count), [&](int v) { return v == volumes.front(); });
+        if (uniform) {
+            int volume = std::clamp(volumes.front(), 0, 100);
+            int err = alsa(Metrics::Write, [&] { return controllers.front()->setVolumeAll(volume); });
+            if (err >= 0)
+                std::ranges::fill(known, volume);
+            return err;
+        }
+
+        int result = 0;
+        for (std::size_t i = 0; i < count; ++i) {
+            int volume = std::clamp(volumes[i], 0, 100);
+            int current = 0;
+            int err = alsa(Metrics::Read, [&] { return controllers[i]->getVolume(current); });
+            if (err < 0 || current != volume)
+                err = alsa(Metrics::Write, [&] { return controllers[i]->setVolume(volume); });
+            else
+                Metrics::instance().recordElided(metricsId);
+            if (err < 0)
+                result = result < 0 ? result : err;
+            else
+                known[i] = volume;
+        }
+        return result;
+    }
+
+    /// @brief Read channel levels, either held in memory or from hardware.
+    /// @return 0 on success, negative ALSA error code on failure.
+    int readLevels(std::span<int> volumes) {
+        if (held) {
+            auto count = std::min(volumes.size(), held->size());
+            std::copy_n(held->begin(), count, volumes.begin());
+            return 0;
+        }
+        return readHardware(volumes);
+    }
+
+    /// @brief Write channel levels, either to the levels held in memory or to hardware.
+    /// @return 0 on success, negative ALSA error code on failure.
+    int writeLevels(std::span<const int> volumes) {
+        if (held) {
+            auto count = std::min(volumes.size(), held->size());
+            for (std::size_t i = 0; i < count; ++i) {
+                (*held)[i] = std::clamp(volumes[i], 0, 100);
             }
+            return 0;
+        }
+        return writeHardware(volumes);
+    }
+
+    std::vector<int> levels() {
+        std::vector<int> volumes(controllers.size());
+        readLevels(volumes);
+        return volumes;
+    }
+
+    /// @brief Apply volume to all channels, attenuating the quieter side according to balance.
+    /// The balance is kept for later changes of the volume alone (balanceToKeep()).
+    /// @param volume Volume percentage (0..100)
+    /// @param balance Balance (-100..100)
+    /// @return 0 on success, negative ALSA error code on failure.
+    int applyVolume(int volume, int balance) {
+        int err = writeLevels(balancedLevels(positions(), volume, balance));
+        balanceSetting = {balance, levels()};
+        return err;
+    }
+
+    /// @brief Get ALSA channel position of every channel, in ALSA channel order.
+    std::vector<int> positions() const {
+        std::vector<int> result(controllers.size());
+        for (std::size_t i = 0; i < controllers.size(); ++i)
+            result[i] = controllers[i]->getChannel();
+        return result;
+    }
+
+    /// @brief Get balance to keep when only the volume is set (see keptBalance()).
+    int balanceToKeep() {
+        return keptBalance(positions(), levels(), balanceSetting);
+    }
+
+    /// @brief Mute immediately, keeping given levels.
+    /// With switch: one switch write, levels are written back only if a fade has changed them.
+    /// Without switch: levels are held in memory and zero volume is written.
+    void muteNow(std::vector<int> volumes, bool restoreLevels) {
+        if (hasSwitchLocked()) {
+            alsa(Metrics::Write, [&] { return ops.setSwitchAll(mixer_elem, 0); });
+            held.reset();
+            if (restoreLevels)
+                writeHardware(volumes);
+        } else {
+            held = std::move(volumes);
+            writeHardware(std::vector<int>(controllers.size(), 0));
+        }
+        muted = true;
+    }
+
+    /// @brief Unmute immediately.
+    void unmuteNow() {
+        if (!mixer_elem) {
+            muted = false; // card is gone, levels stay held until it returns
+            return;
+        }
+        if (hasSwitchLocked()) {
+            alsa(Metrics::Write, [&] { return ops.setSwitchAll(mixer_elem, 1); });
+        } else if (held) {
+            auto volumes = std::move(*held);
+            held.reset();
+            writeHardware(volumes);
+        }
+        muted = false;
+    }
+
+    /// @brief Run one step of mute/unmute fade and schedule the next one.
+    /// The held levels are the fade target, so volume changes during the fade are not lost.
+    void fadeStep(std::uint64_t generation) {
+        auto lock = lockCard();
+        if (generation != fadeGeneration || !fading)
+            return;
+
+        fadeLevel = std::clamp(fadeLevel + (muted ? -fadeDelta : fadeDelta), 0.0, 1.0);
+        if ((muted && fadeLevel <= 0.0) || (!muted && fadeLevel >= 1.0)) {
+            fading = false;
+            auto volumes = std::move(*held);
+            held.reset();
+            if (muted)
+                muteNow(std::move(volumes), true);
+            else
+                writeHardware(volumes);
+            publishState();
+            return;
+        }
+
+        std::vector<int> volumes(held->size());
+        for (std::size_t i = 0; i < volumes.size(); ++i) {
+            volumes[i] = lround((*held)[i] * fadeLevel);
+        }
+        AMIXER_PROBE3(fade_step, card.load(), mixer_elem, static_cast<int>(lround(fadeLevel * 1000)));
+        writeHardware(volumes);
+
+        std::weak_ptr<AMVolume> self = weak_from_this();
+        Scheduler::forCard(card).scheduleAfter(fadeInterval, [self, generation] {
+            if (auto volume = self.lock())
+                volume->fadeStep(generation);
+        });
+    }
+
+    /// @brief Publish current state to the mixer state table.
+    void publishState() {
+        if (!stateTable)
+            return;
+        // reads may release the card mutex while backing off, so check the table again after them
+        int volume = getVolume();
+        int balance = getBalance();
+        bool mute = isMuted();
+        if (stateTable && stateTable->publish(stateIndex, volume, balance, mute) && stateTable->onChange)
+            stateTable->onChange(stateIndex);
+    }
+
+    /// @brief Create controllers for every channel of the element.
+    void createControllers(snd_mixer_elem_t *elem) {
+        controllers.clear();
+        for (int ch = SND_MIXER_SCHN_FRONT_LEFT; ch <= SND_MIXER_SCHN_LAST; ++ch) {
+            auto id = static_cast<snd_mixer_selem_channel_id_t>(ch);
+            if (ops.hasChannel(elem, id))
+                controllers.push_back(VolumeController::create(elem, id, ops));
+        }
+        if (controllers.empty()) // should not happen for elements with volume, but keep a fallback
+            controllers.push_back(VolumeController::create(elem, SND_MIXER_SCHN_MONO, ops));
+        controllers.shrink_to_fit();
+        known.assign(controllers.size(), 0);
+
+        hasLeft = !ops.isMono(elem) && indexOf(SND_MIXER_SCHN_FRONT_LEFT) < controllers.size();
+        hasRight = !ops.isMono(elem) && indexOf(SND_MIXER_SCHN_FRONT_RIGHT) < controllers.size();
+    }
+
+public:
+    AMVolume(int card, snd_mixer_elem_t *elem, const SelemOps &ops = playbackOps, snd_hctl_t *hctl = nullptr) : card(card), mixer_elem(elem), ops(ops) {
+        name=snd_mixer_selem_get_name(elem);
+        createControllers(elem);
+        bindControl(hctl);
+        metricsId = Metrics::instance().registerElement(card, name, ops.capture);
+    }
 
+    /// @brief Drop the element of a removed card, keeping the last state in memory.
+    /// Until reattach(), the levels and the mute state are held in memory: getters report them and
+    /// setters change them, so the state requested while the card is gone is applied when it returns.
+    void detach() {
+        auto lock = lockCard();
+        ++fadeGeneration;
+        bool wasMuted = held ? muted : (stateTable && stateTable->isMuted(stateIndex));
+        if (!held)
+            held = known;
+        fading = false;
+        muted = wasMuted;
+        mixer_elem = nullptr;
+        control = nullptr;
+        controlWritten = false;
+        for (auto &controller : controllers)
+            controller = VolumeController::create(nullptr, controller->getChannel(), ops);
+    }
+
+    /// @brief Bind the volume to the element of the reappeared card and apply the held state.
+    /// Levels are written before anything else, so the card does not stay at its default volume.
+    /// @param newCard ALSA card number of the reappeared card
+    /// @param elem Element of the same name on the reappeared card
+    /// @param hctl Control handle of the reappeared card, nullptr to write through the simple mixer only
+    void reattach(int newCard, snd_mixer_elem_t *elem, snd_hctl_t *hctl) {
+        std::lock(cardMutex(card), cardMutex(newCard));
+        CardLock oldLock(card, CardLock::Pinned, std::adopt_lock);
+        CardLock newLock(newCard, CardLock::Pinned, std::adopt_lock);
+        auto volumes = held ? std::move(*held) : known;
+        held.reset();
+        card = newCard;
+        Metrics::instance().setCard(metricsId, newCard);
+        mixer_elem = elem;
+        createControllers(elem);
+        bindControl(hctl);
+        volumes.resize(controllers.size(), volumes.empty() ? 0 : volumes.front());
+
+        if (muted) {
+            muteNow(std::move(volumes), true);
         } else {
-            monoVolumeController->setVolume(volume);
+            writeHardware(volumes);
+            if (hasSwitchLocked())
+                alsa(Metrics::Write, [&] { return ops.setSwitchAll(mixer_elem, 1); });
+        }
+        publishState();
+    }
+
+    /// @brief Get ALSA mixer element of the volume; called on the event thread, which alone replaces it.
+    snd_mixer_elem_t *element() const { return mixer_elem; }
+
+    /// @brief Measure the round trip of the oldest library write of the element from its ALSA event.
+    /// Called on the event thread for every value event of the element, before its state is refreshed.
+    /// Writes whose event does not come in writeEventTimeout are dropped: alsa-lib skips writes of an
+    /// unchanged value, which produce no event, and an event that late is not caused by the write.
+    void writeEvent() {
+        auto written = writtenAt.exchange(0);
+        if (written == 0)
+            return;
+        auto roundTrip = Scheduler::Clock::now() - Scheduler::Clock::time_point(Scheduler::Clock::duration(written));
+        if (roundTrip < writeEventTimeout)
+            ControlLatency::instance().record(card, roundTrip);
+    }
+
+    /// @brief Get element name without copying; lives as long as the volume (trace events).
+    const char *elementName() const { return name.c_str(); }
+
+    /// @brief Re-read state from hardware and publish it if it has changed.
+    /// Called on ALSA element events, which report changes made by other programs.
+    void refreshState() {
+        auto lock = lockCard();
+        controlWritten = false; // the simple mixer has re-read the element before reporting the event
+        if (fading)
+            return; // fade step publishes its own state
+        publishState();
+    }
+
+    /// @brief Get level of a volume on the dB scale of the element.
+    /// @return Level in 1/100 dB, or std::nullopt if the element has no dB scale or its card is gone.
+    std::optional<long> volumeDb(int volume) {
+        auto lock = lockCard();
+        return controllers.front()->volumeDb(volume);
+    }
+
+    /// @brief Follow the state of the master channel of a link.
+    /// The level is computed on the dB scales of both elements; when either has none, the offset is
+    /// applied to the master volume as by volumeForGain(). Nothing is written while the card is gone,
+    /// the mixer makes the volume follow again when the card reappears.
+    /// @param volume Master volume percentage (0..100)
+    /// @param masterDb Master volume in 1/100 dB, std::nullopt if the master has no dB scale
+    /// @param balance Master balance as reported by getBalance() (-100..100)
+    /// @param mute Master mute state
+    /// @param offsetDb Offset of the link in dB
+    void follow(int volume, std::optional<long> masterDb, int balance, bool mute, double offsetDb) {
+        auto lock = lockCard();
+        if (!mixer_elem)
+            return;
+        int level = 0;
+        if (volume > 0) {
+            auto dB = masterDb ? controllers.front()->dbVolume(*masterDb + lround(offsetDb * 100.0)) : std::nullopt;
+            level = dB ? *dB : controllers.front()->gainVolume(volume, offsetDb);
         }
+        applyVolume(level, appliedBalance(volume, balance));
+        if (mute != isMuted())
+            setMute(mute, 0);
+        publishState();
+    }
+
+    /// @brief Attach the volume to the mixer state table and publish its initial state.
+    void attachState(StateTable *table, std::size_t index) {
+        auto lock = lockCard();
+        stateTable = table;
+        stateIndex = index;
+        publishState();
+    }
+
+    /// @brief Detach the volume from the mixer state table, which is destroyed with the mixer.
+    /// The volume may outlive the mixer in queued fade steps or in the hands of callers; it no longer publishes.
+    void detachState() {
+        auto lock = lockCard();
+        stateTable = nullptr;
+    }
+
+    /// @brief Set volume for the channel.
+    /// If the channel is stereo or multichannel, the volume is set keeping the current balance (balanceToKeep()).
+    /// If the channel is mono, the volume is set directly.
+    /// @param volume Volume percentage (0..100)
+    void setVolume(int volume) override {
+        auto lock = lockCard();
+        volume = std::clamp(volume, 0, 100);
+        applyVolume(volume, balanceToKeep());
+        publishState();
     }
 
     const std::string getName() override {
@@ -243,64 +1108,209 @@ public:
     }
 
     /// @brief Get current volume for the channel.
-    /// If the channel is stereo (has both left and right), the maximum of left and right volumes is returned.
-    /// If the channel is mono, the mono volume is returned.
+    /// The maximum volume across all channels is returned.
     /// @return Current volume (0..100)
     int getVolume() override {
-        int left = leftVolumeController->getVolume();
-        int right = rightVolumeController->getVolume();
-        int mono = monoVolumeController->getVolume();
-
-        int resultInt = std::max(std::max(left, right), mono);
-
-        return resultInt;
+        auto lock = lockCard();
+        auto volumes = levels();
+        return volumes.empty() ? 0 : std::ranges::max(volumes);
     }
 
     /// @brief Set balance for the channel.
-    /// Balance is only applicable for stereo channels (has both left and right).
+    /// Balance is only applicable for stereo and multichannel elements (has both front left and right).
     /// Balance is in the range -100 (left only) to +100 (right only), with 0 being centered.
     /// The volume is adjusted accordingly to maintain the overall volume level
     /// @param balance Balance value (-100..100)
     void setBalance(int balance) override {
         // balance: -100 (left only) .. 0 (center) .. +100 (right only)
+        auto lock = lockCard();
         if (!hasLeft || !hasRight)
             return;
 
         balance = std::clamp(balance, -100, 100);
-
-        double balanceNorm = (100.0 - abs(balance)) / 100.0; // 0..1
-        int volume = getVolume(); // current volume 0..100
-
-        if (balance < 0) {
-            // left louder
-            leftVolumeController->setVolume(volume);
-            rightVolumeController->setVolume(lround(volume * balanceNorm));
-        }
-        else if (balance > 0) {
-            // right louder
-            leftVolumeController->setVolume(lround(volume * balanceNorm));
-            rightVolumeController->setVolume(volume);
-        } else {
-            // balanced
-            leftVolumeController->setVolume(volume);
-            rightVolumeController->setVolume(volume);
-        }
+        applyVolume(getVolume(), balance);
+        publishState();
     }
 
     /// @brief Get current balance for the channel.
-    /// Balance is only applicable for stereo channels (has both left and right).
+    /// Balance is only applicable for stereo and multichannel elements (has both front left and right).
     /// Balance is in the range -100 (left only) to +100 (right only), with 0 being centered.
     /// @return Current balance (-100..100)
     int getBalance() override {
+        auto lock = lockCard();
         if (!hasLeft || !hasRight)
             return 0;
 
-        auto left = leftVolumeController->getVolume();
-        auto right = rightVolumeController->getVolume();
+        auto volumes = levels();
+        auto left = volumes[indexOf(SND_MIXER_SCHN_FRONT_LEFT)];
+        auto right = volumes[indexOf(SND_MIXER_SCHN_FRONT_RIGHT)];
 
         auto delta = right - left; // -100..100
         return delta;
     }
+
+    std::size_t channelCount() override {
+        auto lock = lockCard();
+        return controllers.size();
+    }
+
+    const std::string getChannelName(std::size_t index) override {
+        auto lock = lockCard();
+        if (index >= controllers.size())
+            return {};
+        return snd_mixer_selem_channel_name(controllers[index]->getChannel());
+    }
+
+    int getChannelPosition(std::size_t index) override {
+        auto lock = lockCard();
+        return index < controllers.size() ? controllers[index]->getChannel() : -1;
+    }
+
+    /// @brief Get volume of every channel in one call.
+    /// @param volumes Output span, filled in ALSA channel order.
+    void getChannelVolumes(std::span<int> volumes) override {
+        auto lock = lockCard();
+        readLevels(volumes);
+    }
+
+    /// @brief Set volume of every channel in one call.
+    /// When all channels get the same value, a single control write is issued for the whole element.
+    /// Otherwise only the channels whose value differs from the current one are written.
+    /// @param volumes Per-channel volumes in ALSA channel order (0..100)
+    void setChannelVolumes(std::span<const int> volumes) override {
+        auto lock = lockCard();
+        writeLevels(volumes);
+        publishState();
+    }
+
+    bool isCapture() override {
+        return ops.capture;
+    }
+
+    int getCard() override {
+        return card;
+    }
+
+    int volumeForGain(int volume, double gainDb) override {
+        auto lock = lockCard();
+        return controllers.front()->gainVolume(std::clamp(volume, 0, 100), gainDb);
+    }
+
+    /// @brief Set volume, reporting failure.
+    /// @param volume Volume percentage (0..100)
+    /// @return Nothing on success, error code on failure.
+    std::expected<void, std::error_code> trySetVolume(int volume) override {
+        auto lock = lockCard();
+        int err = applyVolume(std::clamp(volume, 0, 100), balanceToKeep());
+        publishState();
+        if (err < 0)
+            return std::unexpected(errorCode(err));
+        return {};
+    }
+
+    /// @brief Get volume, reporting failure.
+    /// @return Volume percentage (0..100), or error code on failure.
+    std::expected<int, std::error_code> tryGetVolume() override {
+        auto lock = lockCard();
+        std::vector<int> volumes(controllers.size());
+        if (int err = readLevels(volumes); err < 0)
+            return std::unexpected(errorCode(err));
+        return volumes.empty() ? 0 : std::ranges::max(volumes);
+    }
+
+    bool hasSwitch() override {
+        auto lock = lockCard();
+        return hasSwitchLocked();
+    }
+
+    /// @brief Turn the element switch on or off for all channels with a single control write.
+    /// @param on true to enable (unmute playback / enable capture), false to disable
+    void setSwitch(bool on) override {
+        auto lock = lockCard();
+        if (!hasSwitchLocked())
+            return;
+        alsa(Metrics::Write, [&] { return ops.setSwitchAll(mixer_elem, on ? 1 : 0); });
+        publishState();
+    }
+
+    /// @brief Get state of the element switch.
+    /// @return true if any channel is switched on, or if the element has no switch at all.
+    bool getSwitch() override {
+        auto lock = lockCard();
+        if (!hasSwitchLocked())
+            return true;
+        for (const auto &c : controllers) {
+            int value = 0;
+            if (alsa(Metrics::Read, [&] { return ops.getSwitch(mixer_elem, c->getChannel(), &value); }) == 0 && value)
+                return true;
+        }
+        return false;
+    }
+
+    /// @brief Mute or unmute the channel.
+    /// Without fade, mute takes effect immediately with a single switch write (or a single zero volume
+    /// write for elements without switch). With fade, the volume is ramped on the Scheduler thread of the card
+    /// and the call returns immediately; isMuted() reports the requested state from the start.
+    /// @param mute true to mute, false to unmute
+    /// @param fadeMs Fade duration in milliseconds, 0 for instant change
+    void setMute(bool mute, int fadeMs) override {
+        auto lock = lockCard();
+        auto generation = ++fadeGeneration;
+        if (!fading && mute == isMuted())
+            return;
+        if (!mixer_elem)
+            fadeMs = 0; // card is gone, only the held state changes
+
+        auto volumes = levels();
+        if (!fading)
+            fadeInterval = ControlLatency::instance().stepInterval(card, fadeStepInterval);
+        if (fadeMs < 2 * std::chrono::duration<double, std::milli>(fadeInterval).count()) {
+            bool wasFading = fading;
+            if (wasFading) {
+                // abort fade in progress, hardware levels are partially ramped and the switch is on
+                fading = false;
+                held.reset();
+                if (!mute)
+                    writeHardware(volumes);
+            }
+            if (mute)
+                muteNow(std::move(volumes), wasFading);
+            else
+                unmuteNow();
+            publishState();
+            return;
+        }
+
+        if (!fading) {
+            if (mute) {
+                fadeLevel = 1.0;
+            } else {
+                fadeLevel = 0.0;
+                held.reset();
+                writeHardware(std::vector<int>(controllers.size(), 0));
+                if (hasSwitchLocked())
+                    alsa(Metrics::Write, [&] { return ops.setSwitchAll(mixer_elem, 1); });
+            }
+            held = std::move(volumes);
+        }
+        // a fade in progress continues from its current level in the new direction
+        fading = true;
+        muted = mute;
+        fadeDelta = std::chrono::duration<double, std::milli>(fadeInterval).count() / fadeMs;
+        publishState();
+        fadeStep(generation);
+    }
+
+    /// @brief Get mute state of the channel.
+    /// @return true if muted (or being faded out), false otherwise.
+    bool isMuted() override {
+        auto lock = lockCard();
+        if (held)
+            return muted;
+        if (hasSwitchLocked())
+            return !getSwitch();
+        return false;
+    }
 };
 
 /// @brief ALSA Mixer implementation
@@ -315,60 +1325,101 @@ public:
 
     /// @brief Constructor
     /// Enumerates all ALSA cards and their mixer elements.
-    /// Creates AMVolume instances for each mixer element that supports playback volume.
+    /// Creates AMVolume instances for each mixer element that supports playback volume,
+    /// and separately for each mixer element that supports capture volume.
     AMixer()
     {
+        // Construct the schedulers first, so they outlive the mixer and its event thread; links
+        // propagated while the mixer is destroyed still reach the card schedulers
+        Scheduler::instance();
+        Scheduler::prepareCards();
+        auto enumerationStart = Scheduler::Clock::now();
+
         int card = -1;
         if (snd_card_next(&card) < 0)
             return;
         while (card >= 0)
         {
-            std::string hwname = std::format("hw:{}", card);
-
-            snd_mixer_t *mixer = nullptr;
-            if (snd_mixer_open(&mixer, 0) == 0 && mixer)
+            Trace::Scope trace("enumerate_card", "enumeration", card);
+            if (snd_mixer_t *mixer = openMixer(card))
             {
-                bool attached = (snd_mixer_attach(mixer, hwname.c_str()) == 0);
-                if (attached &&
-                    snd_mixer_selem_register(mixer, nullptr, nullptr) == 0 &&
-                    snd_mixer_load(mixer) == 0)
-                {
-                    // Keep mixer alive
-                    mixers.push_back(mixer);
-
-                    for (snd_mixer_elem_t *elem = snd_mixer_first_elem(mixer); elem; elem = snd_mixer_elem_next(elem))
-                    {
-                        if (!snd_mixer_selem_is_active(elem))
-                            continue;
-                        if (!snd_mixer_selem_has_playback_volume(elem))
-                            continue;
+                AMIXER_PROBE1(enumerate_card_entry, card);
+                // Keep mixer alive
+                auto &cardMixer = mixers.emplace_back(CardMixer{card, mixer, {}, {}, {}, Metrics::instance().registerElement(card, {}, false)});
+                identify(cardMixer);
+                auto *hctl = mixerControls(mixer, card);
 
-                        auto vol = std::shared_ptr<AMVolume>(new AMVolume(card, elem));
+                for (snd_mixer_elem_t *elem = snd_mixer_first_elem(mixer); elem; elem = snd_mixer_elem_next(elem))
+                {
+                    if (!snd_mixer_selem_is_active(elem))
+                        continue;
+                    if (playbackOps.hasVolume(elem)) {
+                        AMIXER_PROBE4(enumerate_element, card, elem, snd_mixer_selem_get_name(elem), 0);
+                        auto vol = std::shared_ptr<AMVolume>(new AMVolume(card, elem, playbackOps, hctl));
                         channelsList.push_back(vol);
+                        cardMixer.volumes.push_back(vol.get());
                     }
-                }
-                else
-                {
-                    if (mixer)
-                    {
-                        snd_mixer_close(mixer);
+                    if (captureOps.hasVolume(elem)) {
+                        AMIXER_PROBE4(enumerate_element, card, elem, snd_mixer_selem_get_name(elem), 1);
+                        auto vol = std::shared_ptr<AMVolume>(new AMVolume(card, elem, captureOps, hctl));
+                        captureChannelsList.push_back(vol);
+                        cardMixer.volumes.push_back(vol.get());
                     }
                 }
+                AMIXER_PROBE2(enumerate_card_return, card, static_cast<int>(cardMixer.volumes.size()));
             }
 
             if (snd_card_next(&card) < 0)
                 break;
         }
+
+        std::size_t count = channelsList.size() + captureChannelsList.size();
+        stateTable = std::make_unique<StateTable>(count);
+        stateTable->onChange = [this](std::size_t index) { notify(index); };
+        snapshotTemplate.channels.reserve(count);
+        for (const auto *list : {&channelsList, &captureChannelsList})
+        {
+            for (const auto &vol : *list)
+            {
+                std::static_pointer_cast<AMVolume>(vol)->attachState(stateTable.get(), snapshotTemplate.channels.size());
+                snapshotTemplate.channels.push_back(ChannelSnapshot{vol, 0, 0, false, 0});
+            }
+        }
+        Metrics::instance().setEnumerationTime(Scheduler::Clock::now() - enumerationStart);
+        startEvents();
     }
 
     /// @brief Destructor
-    /// Closes all ALSA mixers to release resources.
+    /// Stops the event thread and closes all ALSA mixers to release resources.
     ~AMixer() override
     {
-        for (auto *m : mixers)
+        if (eventThread.joinable())
+        {
+            std::uint64_t one = 1;
+            if (write(stopFd, &one, sizeof(one)) < 0) {}
+            eventThread.join();
+        }
+        // no change is published after this, so no notification is queued
+        for (auto &m : mixers)
+        {
+            for (auto *volume : m.volumes)
+                volume->detachState();
+        }
+        // deliver the notifications queued so far, which use the mixer
+        if (!Scheduler::instance().isSchedulerThread())
         {
-            if (m)
-                snd_mixer_close(m);
+            std::promise<void> drained;
+            Scheduler::instance().post([&drained] { drained.set_value(); });
+            drained.get_future().wait();
+        }
+        if (stopFd >= 0)
+            close(stopFd);
+        if (watchFd >= 0)
+            close(watchFd);
+        for (auto &m : mixers)
+        {
+            if (m.mixer)
+                snd_mixer_close(m.mixer);
         }
         mixers.clear();
     }
@@ -379,9 +1430,564 @@ public:
         return const_cast<std::list<std::shared_ptr<IVolume>> &>(this->channelsList);
     }
 
+    /// @brief Get list of available capture (input) volume channels.
+    /// @return List of shared pointers to IVolume instances.
+    const std::list<std::shared_ptr<IVolume>> &captureChannels() const override {
+        return captureChannelsList;
+    }
+
+    /// @brief Get consistent state of all channels.
+    /// @return Snapshot of playback and capture channels.
+    MixerSnapshot getSnapshot() const override {
+        MixerSnapshot snapshot = snapshotTemplate;
+        stateTable->read(snapshot);
+        return snapshot;
+    }
+
+    /// @brief Get state of channels changed after the given generation.
+    /// @param generation Generation returned by previous query
+    /// @return Snapshot with current generation and changed channels only.
+    MixerSnapshot changedSince(std::uint64_t generation) const override {
+        MixerSnapshot snapshot;
+        stateTable->readChanged(snapshotTemplate.channels, generation, snapshot);
+        return snapshot;
+    }
+
+    /// @brief Register listener called after state of a channel has changed.
+    /// @param listener Listener to call
+    /// @return Listener id.
+    std::uint64_t addChangeListener(ChangeListener listener) override {
+        std::lock_guard lock(listenersMutex);
+        auto id = ++lastListenerId;
+        listeners.emplace(id, std::move(listener));
+        listenerCount.store(listeners.size(), std::memory_order_relaxed);
+        return id;
+    }
+
+    /// @brief Unregister listener.
+    /// @param id Listener id
+    void removeChangeListener(std::uint64_t id) override {
+        std::lock_guard lock(listenersMutex);
+        listeners.erase(id);
+        listenerCount.store(listeners.size(), std::memory_order_relaxed);
+    }
+
+    /// @brief Get health of a sound card.
+    /// @param card ALSA card number
+    CardHealth cardHealth(int card) const override {
+        return CardHealthState::of(card).state();
+    }
+
+    /// @brief Get identity of a card; matches the identity used to re-apply state to reappeared cards.
+    CardIdentity cardIdentity(int card) const override {
+        std::lock_guard lock(identityMutex);
+        for (const auto &m : mixers)
+        {
+            if (m.card == card)
+                return CardIdentity{m.id, m.longName};
+        }
+        return {};
+    }
+
+    /// @brief Get statistics of re-applying state to reappeared cards.
+    ReapplyStats reapplyStats() const override {
+        std::lock_guard lock(statsMutex);
+        return stats;
+    }
+
+    /// @brief Get generation of the channel layout, incremented by card removal and appearance.
+    std::uint64_t layoutGeneration() const override {
+        return layout.load();
+    }
+
+    /// @brief Link a slave channel to a master channel with a fixed dB offset.
+    /// @return false if a channel does not belong to the mixer or the link would form a loop (errno is set to EINVAL).
+    bool link(const std::shared_ptr<IVolume> &master, const std::shared_ptr<IVolume> &slave, double offsetDb) override {
+        auto masterIndex = stateIndexOf(master.get());
+        auto slaveIndex = stateIndexOf(slave.get());
+        if (!masterIndex || !slaveIndex) {
+            errno = EINVAL;
+            return false;
+        }
+        {
+            std::lock_guard lock(linksMutex);
+            // the master must not follow the slave, directly or through other links
+            for (auto index = *masterIndex;;) {
+                if (index == *slaveIndex) {
+                    errno = EINVAL;
+                    return false;
+                }
+                auto it = masters.find(index);
+                if (it == masters.end())
+                    break;
+                index = it->second;
+            }
+            removeLink(*slaveIndex);
+            links[*masterIndex].push_back(Link{std::static_pointer_cast<AMVolume>(slave), *slaveIndex, offsetDb});
+            masters[*slaveIndex] = *masterIndex;
+            linkCount.store(masters.size(), std::memory_order_relaxed);
+        }
+        propagate(*masterIndex);
+        return true;
+    }
+
+    /// @brief Remove the link of a slave channel.
+    /// @return false if the channel is not linked.
+    bool unlink(const std::shared_ptr<IVolume> &slave) override {
+        auto slaveIndex = stateIndexOf(slave.get());
+        std::lock_guard lock(linksMutex);
+        if (!slaveIndex || !removeLink(*slaveIndex))
+            return false;
+        linkCount.store(masters.size(), std::memory_order_relaxed);
+        return true;
+    }
+
 private:
+    /// @brief Mixer of one card and the identity of the card, kept while the card is gone.
+    struct CardMixer {
+        int card;                     // changed by the event thread under identityMutex
+        snd_mixer_t *mixer;           // nullptr while the card is gone
+        std::string id;               // ALSA card id, e.g. "DAC"
+        std::string longName;         // e.g. "... at usb-0000:00:14.0-2, high speed", includes the USB path
+        std::vector<AMVolume *> volumes;
+        Metrics::Id metricsId;        // calls of the mixer itself
+    };
+
+    /// @brief Card which has appeared and waits for its mixer to become accessible.
+    struct PendingCard {
+        int card;
+        Scheduler::Clock::time_point detected;
+    };
+
+    static constexpr auto pendingRetryInterval = std::chrono::milliseconds(10);
+    static constexpr auto pendingTimeout = std::chrono::seconds(2);
+
+    /// @brief Open and load mixer of the card.
+    /// @return Mixer handle, or nullptr on failure.
+    static snd_mixer_t *openMixer(int card)
+    {
+        std::string hwname = std::format("hw:{}", card);
+        snd_mixer_t *mixer = nullptr;
+        if (snd_mixer_open(&mixer, 0) != 0 || !mixer)
+            return nullptr;
+        if (snd_mixer_attach(mixer, hwname.c_str()) == 0 &&
+            snd_mixer_selem_register(mixer, nullptr, nullptr) == 0 &&
+            snd_mixer_load(mixer) == 0)
+            return mixer;
+        snd_mixer_close(mixer);
+        return nullptr;
+    }
+
+    /// @brief Get control handle of a mixer opened by openMixer(), for writes bypassing the simple mixer.
+    /// @return Control handle owned by the mixer, or nullptr if not available.
+    static snd_hctl_t *mixerControls(snd_mixer_t *mixer, int card)
+    {
+        snd_hctl_t *hctl = nullptr;
+        if (snd_mixer_get_hctl(mixer, std::format("hw:{}", card).c_str(), &hctl) != 0)
+            return nullptr;
+        return hctl;
+    }
+
+    /// @brief Read id and long name of the card.
+    /// @return false if the card control cannot be opened.
+    static bool identify(CardMixer &m)
+    {
+        snd_ctl_t *ctl = nullptr;
+        if (snd_ctl_open(&ctl, std::format("hw:{}", m.card).c_str(), 0) != 0)
+            return false;
+        snd_ctl_card_info_t *info = nullptr;
+        bool ok = snd_ctl_card_info_malloc(&info) == 0 && snd_ctl_card_info(ctl, info) == 0;
+        if (ok)
+        {
+            m.id = snd_ctl_card_info_get_id(info);
+            m.longName = snd_ctl_card_info_get_longname(info);
+        }
+        if (info)
+            snd_ctl_card_info_free(info);
+        snd_ctl_close(ctl);
+        return ok;
+    }
+
+    /// @brief Slave channel of a link.
+    struct Link {
+        std::shared_ptr<AMVolume> slave;
+        std::size_t index; // state table index of the slave
+        double offsetDb;
+    };
+
+    /// @brief Find the state table index of a channel of the mixer.
+    std::optional<std::size_t> stateIndexOf(const IVolume *volume) const
+    {
+        if (!volume)
+            return std::nullopt;
+        auto it = std::ranges::find(snapshotTemplate.channels, volume,
+                                    [](const ChannelSnapshot &channel) { return channel.volume.get(); });
+        if (it == snapshotTemplate.channels.end())
+            return std::nullopt;
+        return static_cast<std::size_t>(it - snapshotTemplate.channels.begin());
+    }
+
+    /// @brief Remove the link of a slave; called with linksMutex locked.
+    bool removeLink(std::size_t slaveIndex)
+    {
+        auto it = masters.find(slaveIndex);
+        if (it == masters.end())
+            return false;
+        auto &slaves = links[it->second];
+        std::erase_if(slaves, [&](const Link &link) { return link.index == slaveIndex; });
+        if (slaves.empty())
+            links.erase(it->second);
+        masters.erase(it);
+        return true;
+    }
+
+    /// @brief Make the slaves linked to a channel follow its published state.
+    /// Called by the writer of the master with its card lock held. Slaves on the card of the master are
+    /// written at once, in the same call as the master; slaves on other cards are written on their card
+    /// Scheduler thread, in parallel, so that two card locks are never taken in opposite order.
+    void propagate(std::size_t index)
+    {
+        std::vector<Link> slaves;
+        {
+            std::lock_guard lock(linksMutex);
+            auto it = links.find(index);
+            if (it == links.end())
+                return;
+            slaves = it->second;
+        }
+        ChannelSnapshot channel = snapshotTemplate.channels[index];
+        stateTable->readOne(index, channel);
+        auto master = std::static_pointer_cast<AMVolume>(channel.volume);
+        int card = master->getCard();
+        auto masterDb = master->volumeDb(channel.volumeLevel);
+        for (const auto &link : slaves)
+        {
+            if (link.slave->getCard() == card)
+            {
+                link.slave->follow(channel.volumeLevel, masterDb, channel.balance, channel.muted, link.offsetDb);
+                continue;
+            }
+            std::weak_ptr<AMVolume> slave = link.slave;
+            Scheduler::forCard(link.slave->getCard()).post([slave, channel, masterDb, offsetDb = link.offsetDb] {
+                if (auto volume = slave.lock())
+                    volume->follow(channel.volumeLevel, masterDb, channel.balance, channel.muted, offsetDb);
+            });
+        }
+    }
+
+    /// @brief Make slaves on a reappeared card follow their masters again.
+    /// Slaves are not written while their card is gone, so masters may have changed meanwhile.
+    void refollow(const CardMixer &m)
+    {
+        if (linkCount.load(std::memory_order_relaxed) == 0)
+            return;
+        std::set<std::size_t> followed;
+        {
+            std::lock_guard lock(linksMutex);
+            for (const auto &[masterIndex, slaves] : links)
+            {
+                for (const auto &link : slaves)
+                {
+                    if (std::ranges::find(m.volumes, link.slave.get()) != m.volumes.end())
+                        followed.insert(masterIndex);
+                }
+            }
+        }
+        for (auto index : followed)
+            propagate(index);
+    }
+
+    /// @brief Deliver change of a state table entry to linked slaves and to listeners.
+    /// Called by writers, so delivery to listeners is only queued on the scheduler thread, and only
+    /// when there are listeners.
+    void notify(std::size_t index)
+    {
+        if (linkCount.load(std::memory_order_relaxed) != 0)
+            propagate(index);
+        if (listenerCount.load(std::memory_order_relaxed) == 0)
+            return;
+        Scheduler::instance().post([this, index] {
+            ChannelSnapshot channel = snapshotTemplate.channels[index];
+            stateTable->readOne(index, channel);
+            std::vector<ChangeListener> current;
+            {
+                std::lock_guard lock(listenersMutex);
+                for (const auto &[id, listener] : listeners)
+                    current.push_back(listener);
+            }
+            for (const auto &listener : current)
+                listener(channel);
+        });
+    }
+
+    /// @brief ALSA element callback; refreshes volumes of the element when its value changes.
+    static int onElementEvent(snd_mixer_elem_t *elem, unsigned int mask)
+    {
+        AMIXER_PROBE2(element_event, elem, mask);
+        if (mask == SND_CTL_EVENT_MASK_REMOVE || !(mask & SND_CTL_EVENT_MASK_VALUE))
+            return 0;
+        auto *volumes = static_cast<std::vector<AMVolume *> *>(snd_mixer_elem_get_callback_private(elem));
+        if (volumes)
+        {
+            for (auto *volume : *volumes)
+            {
+                volume->writeEvent();
+                Trace::Scope trace("element_event", "event", volume->getCard(), volume->elementName());
+                volume->refreshState();
+            }
+        }
+        return 0;
+    }
+
+    /// @brief Register callbacks of the elements of one card.
+    void registerElements(CardMixer &m)
+    {
+        for (auto *volume : m.volumes)
+            elementVolumes[volume->element()].push_back(volume);
+        for (auto *volume : m.volumes)
+        {
+            auto *elem = volume->element();
+            snd_mixer_elem_set_callback_private(elem, &elementVolumes[elem]);
+            snd_mixer_elem_set_callback(elem, onElementEvent);
+        }
+    }
+
+    /// @brief Register element callbacks and start the thread handling ALSA events of all cards.
+    void startEvents()
+    {
+        for (auto &m : mixers)
+            registerElements(m);
+
+        if (mixers.empty())
+            return;
+        stopFd = eventfd(0, EFD_CLOEXEC);
+        if (stopFd < 0)
+            return;
+        watchFd = inotify_init1(IN_CLOEXEC | IN_NONBLOCK);
+        if (watchFd >= 0 && inotify_add_watch(watchFd, "/dev/snd", IN_CREATE | IN_DELETE) < 0)
+        {
+            close(watchFd);
+            watchFd = -1;
+        }
+        eventThread = std::thread([this] { handleEvents(); });
+    }
+
+    /// @brief Handle removal of a card.
+    /// The volumes of the card keep their state in memory, and the mixer is closed right away,
+    /// so the card number is released for the card when it comes back.
+    void removeCard(CardMixer &m)
+    {
+        if (!m.mixer)
+            return;
+        CardLock lock(m.card, CardLock::Pinned);
+        CardHealthState::of(m.card).markGone();
+        for (auto *volume : m.volumes)
+        {
+            elementVolumes.erase(volume->element());
+            volume->detach();
+        }
+        snd_mixer_close(m.mixer);
+        m.mixer = nullptr;
+        ++layout;
+    }
+
+    /// @brief Handle appearance of a card; re-applies the state of a removed card with the same identity.
+    /// The identity is the card id and the long name, which includes the USB path; when no removed card
+    /// has both, the first one with the same id is taken.
+    /// @return false if the card is not accessible yet and the attempt should be repeated.
+    bool addCard(const PendingCard &pending)
+    {
+        CardMixer identity{pending.card, nullptr, {}, {}, {}, Metrics::invalidId};
+        if (!identify(identity))
+            return false;
+
+        CardMixer *match = nullptr;
+        for (auto &m : mixers)
+        {
+            if (m.mixer || m.id != identity.id)
+                continue;
+            if (m.longName == identity.longName)
+            {
+                match = &m;
+                break;
+            }
+            if (!match)
+                match = &m;
+        }
+        if (!match)
+        {
+            ++layout; // new card, channel lists are fixed at enumeration
+            return true;
+        }
+
+        snd_mixer_t *mixer = openMixer(pending.card);
+        if (!mixer)
+            return false;
+
+        {
+            std::lock(cardMutex(match->card), cardMutex(pending.card));
+            CardLock oldLock(match->card, CardLock::Pinned, std::adopt_lock);
+            CardLock newLock(pending.card, CardLock::Pinned, std::adopt_lock);
+            CardHealthState::of(pending.card).reset();
+            {
+                std::lock_guard identityLock(identityMutex);
+                match->card = pending.card;
+                match->longName = identity.longName;
+            }
+            match->mixer = mixer;
+            Metrics::instance().setCard(match->metricsId, pending.card);
+            auto *hctl = mixerControls(mixer, pending.card);
+            for (auto *volume : match->volumes)
+            {
+                for (snd_mixer_elem_t *elem = snd_mixer_first_elem(mixer); elem; elem = snd_mixer_elem_next(elem))
+                {
+                    const auto &ops = volume->isCapture() ? captureOps : playbackOps;
+                    if (snd_mixer_selem_is_active(elem) && ops.hasVolume(elem) &&
+                        volume->getName() == snd_mixer_selem_get_name(elem))
+                    {
+                        volume->reattach(pending.card, elem, hctl);
+                        break;
+                    }
+                }
+            }
+            registerElements(*match);
+        }
+        ++layout;
+        refollow(*match);
+
+        auto latency = std::chrono::duration_cast<std::chrono::nanoseconds>(Scheduler::Clock::now() - pending.detected);
+        std::lock_guard lock(statsMutex);
+        ++stats.count;
+        stats.last = latency;
+        stats.max = std::max(stats.max, latency);
+        return true;
+    }
+
+    /// @brief Read card control device events from the /dev/snd watch.
+    void readWatch(std::vector<PendingCard> &pending)
+    {
+        alignas(inotify_event) char buffer[4096];
+        for (;;)
+        {
+            auto length = read(watchFd, buffer, sizeof(buffer));
+            if (length <= 0)
+                return;
+            for (char *p = buffer; p < buffer + length; )
+            {
+                auto *event = reinterpret_cast<inotify_event *>(p);
+                p += sizeof(inotify_event) + event->len;
+                int card;
+                if (event->len == 0 || std::sscanf(event->name, "controlC%d", &card) != 1)
+                    continue;
+                if (event->mask & IN_CREATE)
+                    pending.push_back(PendingCard{card, Scheduler::Clock::now()});
+                for (auto &m : mixers)
+                {
+                    if ((event->mask & IN_DELETE) && m.card == card)
+                        removeCard(m);
+                }
+            }
+        }
+    }
+
+    /// @brief Wait for ALSA events of all cards and card (re)appearance, and dispatch them.
+    void handleEvents()
+    {
+        std::vector<pollfd> fds;
+        std::vector<std::size_t> first; // index of the first descriptor of each mixer
+        std::vector<PendingCard> pending;
+        bool rebuild = true;
+
+        for (;;)
+        {
+            if (rebuild)
+            {
+                fds.assign({pollfd{stopFd, POLLIN, 0}, pollfd{watchFd, POLLIN, 0}});
+                first.clear();
+                for (auto &m : mixers)
+                {
+                    first.push_back(fds.size());
+                    int count = m.mixer ? snd_mixer_poll_descriptors_count(m.mixer) : 0;
+                    if (count <= 0)
+                        continue;
+                    fds.resize(fds.size() + count);
+                    snd_mixer_poll_descriptors(m.mixer, &fds[first.back()], count);
+                }
+                first.push_back(fds.size());
+                rebuild = false;
+            }
+
+            int timeout = pending.empty() ? -1 : static_cast<int>(pendingRetryInterval.count());
+            if (poll(fds.data(), fds.size(), timeout) < 0)
+            {
+                if (errno == EINTR)
+                    continue;
+                return;
+            }
+            if (fds[0].revents)
+                return;
+            if (fds[1].revents)
+                readWatch(pending);
+
+            for (std::size_t i = 0; i < mixers.size(); ++i)
+            {
+                auto nfds = static_cast<unsigned int>(first[i + 1] - first[i]);
+                if (nfds == 0 || !mixers[i].mixer)
+                    continue;
+                unsigned short revents = 0;
+                snd_mixer_poll_descriptors_revents(mixers[i].mixer, &fds[first[i]], nfds, &revents);
+                if (!revents)
+                    continue;
+                int err = 0;
+                if (!(revents & (POLLERR | POLLHUP | POLLNVAL)))
+                {
+                    CardLock lock(mixers[i].card, CardLock::Pinned);
+                    auto start = Scheduler::Clock::now();
+                    AMIXER_PROBE1(event_dispatch_entry, mixers[i].card);
+                    Trace::Scope trace("handle_events", "event", mixers[i].card);
+                    err = snd_mixer_handle_events(mixers[i].mixer);
+                    trace.setValue(err);
+                    AMIXER_PROBE2(event_dispatch_return, mixers[i].card, err);
+                    Metrics::instance().record(mixers[i].metricsId, Metrics::Read, Scheduler::Clock::now() - start, err >= 0);
+                }
+                if (err < 0 || (revents & (POLLERR | POLLHUP | POLLNVAL)))
+                    removeCard(mixers[i]);
+            }
+
+            std::erase_if(pending, [this](const PendingCard &card) {
+                return addCard(card) || Scheduler::Clock::now() - card.detected > pendingTimeout;
+            });
+
+            // descriptors change when a card is removed or reopened
+            bool open = false;
+            for (std::size_t i = 0; i < mixers.size(); ++i)
+                open = open || (first[i + 1] > first[i]) != (mixers[i].mixer != nullptr);
+            rebuild = open;
+        }
+    }
+
     std::list<std::shared_ptr<IVolume>> channelsList;
-    std::vector<snd_mixer_t *> mixers; // keep mixers alive
+    std::list<std::shared_ptr<IVolume>> captureChannelsList;
+    std::unique_ptr<StateTable> stateTable;
+    MixerSnapshot snapshotTemplate; // channel list of snapshots, states are filled from stateTable
+    std::vector<CardMixer> mixers; // keep mixers alive
+    // card numbers and identities of the mixers, changed by the event thread and read by cardIdentity()
+    mutable std::mutex identityMutex;
+    std::map<snd_mixer_elem_t *, std::vector<AMVolume *>> elementVolumes; // callback data of elements
+    std::mutex listenersMutex;
+    std::map<std::uint64_t, ChangeListener> listeners;
+    std::uint64_t lastListenerId{0};
+    std::atomic<std::size_t> listenerCount{0};
+    std::mutex linksMutex;
+    std::map<std::size_t, std::vector<Link>> links; // slaves by state table index of their master
+    std::map<std::size_t, std::size_t> masters;     // master index by slave index
+    std::atomic<std::size_t> linkCount{0};
+    mutable std::mutex statsMutex;
+    ReapplyStats stats;
+    std::atomic<std::uint64_t> layout{0};
+    int stopFd{-1};
+    int watchFd{-1}; // inotify watch of /dev/snd, reports cards appearing and disappearing
+    std::thread eventThread;
 };
 
 /// @brief Get singleton instance of ALSA mixer.
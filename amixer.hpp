@@ -35,6 +35,14 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include <memory>
 #include <string>
 #include <ranges>
+#include <span>
+#include <chrono>
+#include <cstddef>
+#include <expected>
+#include <system_error>
+#include <cstdint>
+#include <functional>
+#include <vector>
 
 /// @brief Interface for volume control of a single channel (e.g., "Speaker", "Headphone").
 /// The channel may be mono (only mono controller) or stereo (left and right controllers).
@@ -45,11 +53,131 @@ public:
     virtual void setVolume(int volume) =0; // 0..100 percentage
     virtual void setBalance(int balance) =0; // -100 (left only) .. 0 (center) .. +100 (right only)
     virtual const std::string getName() = 0; 
+
+    /// @brief Get number of the sound card the channel belongs to (as in "hw:N").
+    virtual int getCard() = 0;
     virtual int getVolume() = 0; // 0..100 percentage
     virtual int getBalance() = 0; // -100 (left only) .. 0 (center) .. +100 (right only
+
+    /// @brief Get number of discrete channels of the element.
+    /// @return 1 for mono, 2 for stereo, 6 for 5.1, 8 for 7.1 etc.
+    virtual std::size_t channelCount() = 0;
+
+    /// @brief Get human readable name of a channel (e.g. "Front Left", "Woofer").
+    /// @param index Channel index (0..channelCount()-1)
+    /// @return Channel name, or empty string if index is out of range.
+    virtual const std::string getChannelName(std::size_t index) = 0;
+
+    /// @brief Get position of a channel in the ALSA channel map.
+    /// @param index Channel index (0..channelCount()-1)
+    /// @return ALSA channel position (snd_mixer_selem_channel_id_t, 0 front left .. 8 rear center),
+    ///         or -1 if index is out of range.
+    virtual int getChannelPosition(std::size_t index) = 0;
+
+    /// @brief Get volume of every channel in one call.
+    /// Entries beyond channelCount() are left untouched.
+    /// @param volumes Output span of per-channel volumes (0..100 percentage)
+    virtual void getChannelVolumes(std::span<int> volumes) = 0;
+
+    /// @brief Set volume of every channel in one call.
+    /// Missing entries (span shorter than channelCount()) keep their current value.
+    /// @param volumes Per-channel volumes (0..100 percentage)
+    virtual void setChannelVolumes(std::span<const int> volumes) = 0;
+
+    /// @brief Check direction of the volume control.
+    /// @return true for capture (input, e.g. "Mic", "Line"), false for playback (output).
+    virtual bool isCapture() = 0;
+
+    /// @brief Check whether the element has a hardware switch for this direction.
+    virtual bool hasSwitch() = 0;
+
+    /// @brief Turn the hardware switch on or off.
+    /// For playback it is the unmute switch, for capture it enables recording from the source.
+    /// Does nothing if the element has no switch.
+    /// @param on true to switch on, false to switch off
+    virtual void setSwitch(bool on) = 0;
+
+    /// @brief Get state of the hardware switch.
+    /// @return true if switched on (or if there is no switch), false if switched off.
+    virtual bool getSwitch() = 0;
+
+    /// @brief Mute or unmute the channel, keeping its volume and balance.
+    /// Uses the hardware switch when the element has one, otherwise zero volume is written
+    /// while the previous levels are kept and restored on unmute.
+    /// @param mute true to mute, false to unmute
+    /// @param fadeMs Optional fade duration in milliseconds to avoid clicks, 0 for instant change.
+    ///               The fade runs in background, the call does not wait for it.
+    virtual void setMute(bool mute, int fadeMs = 0) = 0;
+
+    /// @brief Get mute state of the channel.
+    /// @return true if muted, false otherwise.
+    virtual bool isMuted() = 0;
+
+    /// @brief Get volume which is given number of dB louder or quieter than the volume.
+    /// Uses the dB scale of the element if available, otherwise treats linear volume as amplitude.
+    /// @param volume Volume percentage (0..100)
+    /// @param gainDb Gain in dB, negative for attenuation (e.g. -12.0)
+    /// @return Volume percentage (0..100)
+    virtual int volumeForGain(int volume, double gainDb) = 0;
+
+    /// @brief Set volume, reporting failure.
+    /// Transient card errors (e.g. EBUSY) are retried with backoff; a card known to be gone fails
+    /// immediately with ENODEV.
+    /// @param volume Volume percentage (0..100)
+    /// @return Nothing on success, error code (errno value, generic category) on failure.
+    virtual std::expected<void, std::error_code> trySetVolume(int volume) = 0;
+
+    /// @brief Get volume, reporting failure instead of returning a made-up value.
+    /// getVolume() reports the last known volume when the card fails.
+    /// @return Volume percentage (0..100), or error code (errno value, generic category) on failure.
+    virtual std::expected<int, std::error_code> tryGetVolume() = 0;
+};
+
+/// @brief Statistics of re-applying the last state to cards which have reappeared (e.g. USB DAC reset).
+struct ReapplyStats {
+    std::uint64_t count{0};       // number of cards re-applied
+    std::chrono::nanoseconds last{}; // time from the card appearing to its state being written
+    std::chrono::nanoseconds max{};
+};
+
+/// @brief Health of a sound card, tracked from the results of its ALSA calls.
+enum class CardHealth {
+    Healthy,  // last call succeeded
+    Degraded, // transient errors persisted after retries; calls fail fast until the backoff expires
+    Gone,     // card has been removed; calls fail immediately
+};
+
+/// @brief Identity of a sound card, stable across restarts and card renumbering.
+struct CardIdentity {
+    std::string id;       // ALSA card id, e.g. "DAC"
+    std::string longName; // ALSA long name, includes the USB path, e.g. "... at usb-0000:00:14.0-2, high speed"
+
+    bool operator==(const CardIdentity &) const = default;
+};
+
+/// @brief Volume of one channel in a batch of writes.
+struct VolumeLevel {
+    std::shared_ptr<IVolume> volume;
+    int level; // 0..100 percentage
+};
+
+/// @brief State of one volume channel captured by IMixer::getSnapshot().
+struct ChannelSnapshot {
+    std::shared_ptr<IVolume> volume;
+    int volumeLevel;           // 0..100 percentage
+    int balance;               // -100..100
+    bool muted;
+    std::uint64_t generation;  // mixer generation of the last change of the channel, never decreases
+};
+
+/// @brief Consistent state of all volume channels of the mixer.
+struct MixerSnapshot {
+    std::uint64_t generation{0};           // incremented on every change of any channel
+    std::vector<ChannelSnapshot> channels; // playback channels followed by capture channels
 };
 
 /// @brief Interface for mixer providing access to available volume channels.
+/// Playback (output) and capture (input) channels are listed separately.
 class IMixer{
 public:
     virtual ~IMixer()=default;
@@ -58,6 +186,72 @@ public:
     /// @return List of shared pointers to IVolume instances.
     virtual const std::list<std::shared_ptr<IVolume>> &channels() const = 0;
 
+    /// @brief Get list of available capture (input) volume channels, e.g. microphone or line-in gain.
+    /// @return List of shared pointers to IVolume instances.
+    virtual const std::list<std::shared_ptr<IVolume>> &captureChannels() const = 0;
+
+    /// @brief Get consistent state of all channels.
+    /// The state is kept up to date by the volume setters, so taking a snapshot does not touch hardware.
+    /// Readers never block writers and writers never wait for readers.
+    /// @return Snapshot of playback and capture channels.
+    virtual MixerSnapshot getSnapshot() const = 0;
+
+    /// @brief Get state of channels changed after the given generation.
+    /// Channel generations are bumped by changes made through this library and by changes made
+    /// by other programs, reported by ALSA element events.
+    /// @param generation Generation returned by previous getSnapshot() or changedSince(), 0 for all channels
+    /// @return Snapshot with current mixer generation and only the channels changed since generation.
+    virtual MixerSnapshot changedSince(std::uint64_t generation) const = 0;
+
+    using ChangeListener = std::function<void(const ChannelSnapshot &)>;
+
+    /// @brief Register listener called after state of a channel has changed.
+    /// Listeners are called on the library scheduler thread (Scheduler::instance()), never on the
+    /// thread making the change, and receive the channel state current at the time of the call.
+    /// @param listener Listener to call
+    /// @return Listener id for removeChangeListener().
+    virtual std::uint64_t addChangeListener(ChangeListener listener) = 0;
+
+    /// @brief Unregister listener; may be called from the listener itself.
+    /// @param id Listener id returned by addChangeListener()
+    virtual void removeChangeListener(std::uint64_t id) = 0;
+
+    /// @brief Get health of a sound card.
+    /// @param card ALSA card number
+    virtual CardHealth cardHealth(int card) const = 0;
+
+    /// @brief Get identity of a sound card.
+    /// @param card ALSA card number
+    /// @return Card id and long name, empty if the card is not known to the mixer.
+    virtual CardIdentity cardIdentity(int card) const = 0;
+
+    /// @brief Get statistics of re-applying state to reappeared cards.
+    /// A card which disappears keeps its volumes; their state is held in memory and written to the card
+    /// as soon as a card with the same id and USB path appears again.
+    virtual ReapplyStats reapplyStats() const = 0;
+
+    /// @brief Get generation of the channel layout.
+    /// Incremented whenever a card is removed or appears, as channels then become unavailable or move
+    /// to another card number. Code caching channel lookups (e.g. SceneRegistry) resolves them again
+    /// when it changes.
+    virtual std::uint64_t layoutGeneration() const = 0;
+
+    /// @brief Link a slave channel to a master channel with a fixed dB offset.
+    /// Whenever the state of the master changes, through this library or by other programs (reported
+    /// by ALSA element events), the slave is set to the volume the offset away from the master on the
+    /// dB scale, and follows the balance and the mute state of the master. The published master state
+    /// is used, so the master is not read again. A master at zero volume sets the slave to zero.
+    /// The slave is set to follow the current master state at once.
+    /// @param master Master channel, e.g. "Speaker"
+    /// @param slave Slave channel, e.g. a subwoofer element, possibly on another card
+    /// @param offsetDb Offset in dB, e.g. -6.0; linking a slave again replaces its previous link
+    /// @return false if a channel does not belong to the mixer or the link would form a loop (errno is set to EINVAL).
+    virtual bool link(const std::shared_ptr<IVolume> &master, const std::shared_ptr<IVolume> &slave, double offsetDb) = 0;
+
+    /// @brief Remove the link of a slave channel; the slave keeps its current state.
+    /// @return false if the channel is not linked.
+    virtual bool unlink(const std::shared_ptr<IVolume> &slave) = 0;
+
     /// @brief Get singleton instance of ALSA mixer
     /// @return Reference to IMixer instance supporting ALSA
     static IMixer& alsaInstance();
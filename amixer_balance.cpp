@@ -0,0 +1,103 @@
+/*
+
+Copyright (c) 2025 Pawel Sklarow https://github.com/psklarow
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+of the Software, and to permit persons to whom the Software is furnished to do
+so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+ */
+
+/// @file amixer_balance.cpp
+/// @brief Balance implementation.
+///
+/// Note: this code has been developed with AI assistance.
+
+#include "amixer_balance.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+int channelSide(int position)
+{
+    switch (position) {
+    case 0: // front left
+    case 2: // rear left
+    case 6: // side left
+        return -1;
+    case 1: // front right
+    case 3: // rear right
+    case 7: // side right
+        return 1;
+    default:
+        return 0;
+    }
+}
+
+std::vector<int> balancedLevels(std::span<const int> positions, int level, int balance)
+{
+    level = std::clamp(level, 0, 100);
+    balance = std::clamp(balance, -100, 100);
+    std::vector<int> levels(positions.size(), level);
+    bool left = std::ranges::any_of(positions, [](int p) { return channelSide(p) < 0; });
+    bool right = std::ranges::any_of(positions, [](int p) { return channelSide(p) > 0; });
+    if (balance == 0 || !left || !right)
+        return levels;
+
+    int attenuated = lround(level * (1.0 - (abs(balance) / 100.0)));
+    int quietSide = balance < 0 ? 1 : -1; // left louder -> attenuate right side
+    for (std::size_t i = 0; i < positions.size(); ++i)
+    {
+        if (channelSide(positions[i]) == quietSide)
+            levels[i] = attenuated;
+    }
+    return levels;
+}
+
+int appliedBalance(int level, int reported)
+{
+    if (level <= 0)
+        return 0;
+    return std::clamp(static_cast<int>(lround(100.0 * reported / level)), -100, 100);
+}
+
+int keptBalance(std::span<const int> positions, std::span<const int> levels, const BalanceSetting &setting)
+{
+    if (std::ranges::equal(levels, setting.levels))
+        return setting.balance;
+    int left = -1, right = -1, level = 0;
+    for (std::size_t i = 0; i < std::min(positions.size(), levels.size()); ++i)
+    {
+        int side = channelSide(positions[i]);
+        if (side < 0)
+            left = std::max(left, levels[i]);
+        else if (side > 0)
+            right = std::max(right, levels[i]);
+        level = std::max(level, levels[i]);
+    }
+    if (left < 0 || right < 0)
+        return 0;
+    return appliedBalance(level, right - left);
+}
+
+std::vector<int> balancedLevels(IVolume &volume, int level, int balance)
+{
+    std::vector<int> positions(volume.channelCount());
+    for (std::size_t i = 0; i < positions.size(); ++i)
+        positions[i] = volume.getChannelPosition(i);
+    return balancedLevels(positions, level, balance);
+}
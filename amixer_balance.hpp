@@ -0,0 +1,82 @@
+/*
+
+Copyright (c) 2025 Pawel Sklarow https://github.com/psklarow
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+of the Software, and to permit persons to whom the Software is furnished to do
+so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+ */
+
+ // Note: this code has been developed with AI assistance.
+
+/// @file amixer_balance.hpp
+/// @brief Per-channel levels of a volume and balance, shared by all volume implementations.
+
+#ifndef __AMIXER_BALANCE_HPP__
+#define __AMIXER_BALANCE_HPP__
+
+#include "amixer.hpp"
+
+#include <span>
+#include <vector>
+
+/// @brief Get side of the listening position an ALSA channel position belongs to.
+/// @param position ALSA channel position (snd_mixer_selem_channel_id_t, 0 front left .. 8 rear center)
+/// @return -1 for left side channels, +1 for right side channels, 0 for center, woofer and mono.
+int channelSide(int position);
+
+/// @brief Compute per-channel levels for volume and balance, attenuating the quieter side.
+/// Balance applies only when there are channels on both sides; other channels get the volume.
+/// @param positions ALSA channel position of every channel
+/// @param level Volume percentage (0..100)
+/// @param balance Balance (-100..100)
+/// @return Levels in the order of positions.
+std::vector<int> balancedLevels(std::span<const int> positions, int level, int balance);
+
+/// @brief Convert balance reported by IVolume::getBalance() to balance taken by IVolume::setBalance().
+/// getBalance() reports the level of the right side minus the level of the left side, while setBalance()
+/// and balancedLevels() take the attenuation of the quieter side in percent of the volume, so a balance
+/// read back has to be converted before it is applied again.
+/// @param level Volume percentage (0..100), the level of the louder side
+/// @param reported Balance as reported by getBalance() (-100..100)
+/// @return Balance as taken by setBalance() (-100..100).
+int appliedBalance(int level, int reported);
+
+/// @brief Balance last applied to a volume, kept while only its volume is set.
+struct BalanceSetting {
+    int balance{0};          // as setBalance() takes it (-100..100)
+    std::vector<int> levels; // levels read back after the balance was applied, per channel
+};
+
+/// @brief Get balance to apply when only the volume of an element is set.
+/// The balance last applied is kept while the levels are still those it has produced, so rounding to
+/// hardware steps and volume 0 do not wear it away. After other changes (per-channel writes, other
+/// programs) it is derived from the levels: the louder channel of each side, as by appliedBalance().
+/// @param positions ALSA channel position of every channel
+/// @param levels Current levels in the order of positions
+/// @param setting Balance last applied
+/// @return Balance as taken by setBalance() (-100..100).
+int keptBalance(std::span<const int> positions, std::span<const int> levels, const BalanceSetting &setting);
+
+/// @brief Compute per-channel levels of a volume for volume and balance, as IVolume::setVolume() writes them.
+/// @param volume Volume channel, only its channel positions are used
+/// @param level Volume percentage (0..100)
+/// @param balance Balance (-100..100)
+/// @return Levels in the channel order of the volume.
+std::vector<int> balancedLevels(IVolume &volume, int level, int balance);
+
+#endif // __AMIXER_BALANCE_HPP__
@@ -0,0 +1,129 @@
+/*
+
+Copyright (c) 2025 Pawel Sklarow https://github.com/psklarow
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+of the Software, and to permit persons to whom the Software is furnished to do
+so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+ */
+
+/// @file amixer_coro.cpp
+/// @brief C++20 coroutine awaitables implementation.
+///
+/// Note: this code has been developed with AI assistance.
+
+#include "amixer_coro.hpp"
+#include "amixer_balance.hpp"
+#include "amixer_probes.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <mutex>
+
+void SetVolumeAwaitable::await_suspend(std::coroutine_handle<> handle)
+{
+    Scheduler::forCard(volume->getCard()).post([this, handle] {
+        volume->setVolume(level);
+        handle.resume();
+    });
+}
+
+FadeAwaitable::FadeAwaitable(std::shared_ptr<IVolume> volume, int target, Duration duration, Duration stepInterval)
+    : volume(std::move(volume)), target(std::clamp(target, 0, 100)),
+      stepInterval(ControlLatency::instance().resolve(this->volume->getCard(), stepInterval, Duration(10))),
+      steps(static_cast<std::size_t>(std::max<Duration::rep>(duration / this->stepInterval, 0)))
+{
+}
+
+void FadeAwaitable::await_suspend(std::coroutine_handle<> handle)
+{
+    this->handle = handle;
+    Scheduler::forCard(volume->getCard()).post([this] {
+        from = volume->getVolume();
+        balance = appliedBalance(from, volume->getBalance());
+        positions.resize(volume->channelCount());
+        for (std::size_t i = 0; i < positions.size(); ++i)
+            positions[i] = volume->getChannelPosition(i);
+        start = Scheduler::Clock::now();
+        step(1);
+    });
+}
+
+/// @brief Write one step and schedule the next one; the awaitable lives until the coroutine is resumed.
+/// Missed steps are skipped, so a slow card does not stretch the fade.
+void FadeAwaitable::step(std::size_t index)
+{
+    index = std::min(index, steps);
+    double progress = steps == 0 ? 1.0 : static_cast<double>(index) / steps;
+    int level = lround(from + (target - from) * progress);
+    AMIXER_PROBE3(fade_step_volume, volume->getCard(), volume.get(), level);
+    volume->setChannelVolumes(balancedLevels(positions, level, balance));
+    if (index >= steps)
+    {
+        handle.resume();
+        return;
+    }
+    auto behind = static_cast<std::size_t>((Scheduler::Clock::now() - start) / stepInterval) + 1;
+    auto next = std::max(index + 1, behind);
+    Scheduler::forCard(volume->getCard()).schedule(start + stepInterval * static_cast<Duration::rep>(next), [this, next] {
+        step(next);
+    });
+}
+
+/// @brief State shared by the awaitable and its change listener.
+/// The listener may run after the coroutine has been resumed and the awaitable destroyed.
+struct ChangeAwaitable::Wait {
+    std::mutex mutex;
+    bool done{false};
+    std::uint64_t listener{0};
+    std::coroutine_handle<> handle;
+};
+
+ChangeAwaitable::ChangeAwaitable(IMixer &mixer, std::shared_ptr<IVolume> volume, Predicate predicate)
+    : mixer(mixer), volume(std::move(volume)), predicate(std::move(predicate))
+{
+}
+
+bool ChangeAwaitable::await_suspend(std::coroutine_handle<> handle)
+{
+    auto wait = std::make_shared<Wait>();
+    wait->handle = handle;
+    auto &mixer = this->mixer;
+
+    std::unique_lock lock(wait->mutex);
+    wait->listener = mixer.addChangeListener([this, wait, &mixer](const ChannelSnapshot &channel) {
+        {
+            std::lock_guard lock(wait->mutex);
+            if (wait->done || channel.volume != volume || !predicate(channel))
+                return;
+            wait->done = true;
+            result = channel;
+        }
+        mixer.removeChangeListener(wait->listener);
+        wait->handle.resume();
+    });
+
+    auto snapshot = mixer.getSnapshot();
+    auto it = std::ranges::find(snapshot.channels, volume, &ChannelSnapshot::volume);
+    if (it == snapshot.channels.end() || !predicate(*it))
+        return true; // the listener waits for the lock, released on return
+    wait->done = true;
+    result = *it;
+    lock.unlock();
+    mixer.removeChangeListener(wait->listener);
+    return false;
+}
@@ -0,0 +1,142 @@
+/*
+
+Copyright (c) 2025 Pawel Sklarow https://github.com/psklarow
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+of the Software, and to permit persons to whom the Software is furnished to do
+so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+ */
+
+ // Note: this code has been developed with AI assistance.
+
+/// @file amixer_coro.hpp
+/// @brief C++20 coroutine awaitables for volume operations.
+/// Hardware writes run on the card Scheduler thread and change notifications come from the mixer
+/// event thread, so a coroutine never blocks its own thread inside libasound. The coroutine is
+/// resumed on the library thread which completed the operation; it should hop to its own executor
+/// before doing anything long.
+///
+/// Example:
+///     co_await setVolumeAsync(volume, 40);
+///     co_await fadeTo(volume, 80, std::chrono::milliseconds(300));
+///     auto state = co_await waitForChange(mixer, volume, [](const ChannelSnapshot &c) { return c.muted; });
+
+#ifndef __AMIXER_CORO_HPP__
+#define __AMIXER_CORO_HPP__
+
+#include "amixer.hpp"
+#include "amixer_scheduler.hpp"
+
+#include <chrono>
+#include <coroutine>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <vector>
+
+/// @brief Awaitable setting volume of a channel on its card scheduler thread.
+class SetVolumeAwaitable {
+public:
+    SetVolumeAwaitable(std::shared_ptr<IVolume> volume, int level)
+        : volume(std::move(volume)), level(level) {}
+
+    bool await_ready() const noexcept { return false; }
+    void await_suspend(std::coroutine_handle<> handle);
+    void await_resume() const noexcept {}
+
+private:
+    std::shared_ptr<IVolume> volume;
+    int level;
+};
+
+/// @brief Awaitable fading a channel from its current volume to the target volume.
+/// The coroutine is resumed after the final step has been written.
+class FadeAwaitable {
+public:
+    using Duration = std::chrono::milliseconds;
+
+    FadeAwaitable(std::shared_ptr<IVolume> volume, int target, Duration duration, Duration stepInterval);
+
+    bool await_ready() const noexcept { return false; }
+    void await_suspend(std::coroutine_handle<> handle);
+    void await_resume() const noexcept {}
+
+private:
+    void step(std::size_t index);
+
+    std::shared_ptr<IVolume> volume;
+    int target;
+    int from{0};
+    int balance{0};
+    std::vector<int> positions; // ALSA channel positions, so steps write all channels keeping the balance
+    Scheduler::Clock::time_point start;
+    Duration stepInterval;
+    std::size_t steps;
+    std::coroutine_handle<> handle;
+};
+
+/// @brief Awaitable waiting until state of a channel satisfies a predicate.
+/// The predicate is checked against the current state first, so a condition which already holds
+/// does not suspend, and a change made between the check and the suspension is not lost.
+/// The result is the channel state which satisfied the predicate.
+class ChangeAwaitable {
+public:
+    using Predicate = std::function<bool(const ChannelSnapshot &)>;
+
+    ChangeAwaitable(IMixer &mixer, std::shared_ptr<IVolume> volume, Predicate predicate);
+
+    bool await_ready() const noexcept { return false; }
+    bool await_suspend(std::coroutine_handle<> handle);
+    ChannelSnapshot await_resume() const noexcept { return result; }
+
+private:
+    struct Wait;
+
+    IMixer &mixer;
+    std::shared_ptr<IVolume> volume;
+    Predicate predicate;
+    ChannelSnapshot result{};
+};
+
+/// @brief Set volume without blocking the calling thread.
+/// @param volume Volume channel
+/// @param level Volume percentage (0..100)
+inline SetVolumeAwaitable setVolumeAsync(std::shared_ptr<IVolume> volume, int level) {
+    return SetVolumeAwaitable(std::move(volume), level);
+}
+
+/// @brief Fade volume to the target level.
+/// @param volume Volume channel
+/// @param target Target volume percentage (0..100)
+/// @param duration Fade duration
+/// @param stepInterval Interval between fade steps, zero for the interval suitable for the card
+///                     (ControlLatency::stepInterval())
+inline FadeAwaitable fadeTo(std::shared_ptr<IVolume> volume, int target, std::chrono::milliseconds duration,
+                            std::chrono::milliseconds stepInterval = std::chrono::milliseconds::zero()) {
+    return FadeAwaitable(std::move(volume), target, duration, stepInterval);
+}
+
+/// @brief Wait until state of the channel satisfies the predicate.
+/// Changes made by other programs are seen through ALSA element events.
+/// @param mixer Mixer owning the channel
+/// @param volume Volume channel
+/// @param predicate Condition on the channel state
+inline ChangeAwaitable waitForChange(IMixer &mixer, std::shared_ptr<IVolume> volume, ChangeAwaitable::Predicate predicate) {
+    return ChangeAwaitable(mixer, std::move(volume), std::move(predicate));
+}
+
+#endif // __AMIXER_CORO_HPP__
@@ -0,0 +1,151 @@
+/*
+
+Copyright (c) 2025 Pawel Sklarow https://github.com/psklarow
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+of the Software, and to permit persons to whom the Software is furnished to do
+so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+ */
+
+/// @file amixer_deadline.cpp
+/// @brief Volume calls bounded by a deadline implementation.
+///
+/// Note: this code has been developed with AI assistance.
+
+#include "amixer_deadline.hpp"
+
+#include <future>
+#include <map>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+/// @brief Sequence numbers of the latest calls per channel.
+/// An entry lives only while calls for the channel are queued: each queued call holds the channel,
+/// so its address cannot be reused by another channel before the entry is erased.
+struct DeadlineCaller::State {
+    struct Latest {
+        std::uint64_t write{0};
+        std::uint64_t read{0};
+        std::size_t queued{0}; // calls claimed and not started yet
+    };
+
+    std::mutex mutex;
+    std::uint64_t nextSequence{0};
+    std::unordered_map<const IVolume *, Latest> latest;
+
+    std::uint64_t claim(const IVolume *volume, std::uint64_t Latest::*kind) {
+        std::lock_guard lock(mutex);
+        auto &entry = latest[volume];
+        ++entry.queued;
+        return entry.*kind = ++nextSequence;
+    }
+
+    /// @brief Start a claimed call, erasing the entry of the channel with its last queued call.
+    /// @return true if the call is still the latest of its kind, false if superseded.
+    bool start(const IVolume *volume, std::uint64_t Latest::*kind, std::uint64_t sequence) {
+        std::lock_guard lock(mutex);
+        auto entry = latest.find(volume);
+        bool isLatest = entry->second.*kind == sequence;
+        if (--entry->second.queued == 0)
+            latest.erase(entry);
+        return isLatest;
+    }
+};
+
+DeadlineCaller::DeadlineCaller() : state(std::make_shared<State>())
+{
+}
+
+DeadlineCaller::~DeadlineCaller() = default;
+
+CallResult DeadlineCaller::setVolume(const std::shared_ptr<IVolume> &volume, int level, Clock::time_point deadline)
+{
+    auto sequence = state->claim(volume.get(), &State::Latest::write);
+    auto done = std::make_shared<std::promise<CallStatus>>();
+    auto result = done->get_future();
+    Scheduler::forCard(volume->getCard()).post([state = state, volume, level, sequence, done] {
+        if (!state->start(volume.get(), &State::Latest::write, sequence)) {
+            done->set_value(CallStatus::Superseded);
+            return;
+        }
+        volume->setVolume(level);
+        done->set_value(CallStatus::Ok);
+    });
+    if (result.wait_until(deadline) != std::future_status::ready)
+        return CallResult{CallStatus::Timeout, 0};
+    return CallResult{result.get(), 0};
+}
+
+CallResult DeadlineCaller::getVolume(const std::shared_ptr<IVolume> &volume, Clock::time_point deadline)
+{
+    auto sequence = state->claim(volume.get(), &State::Latest::read);
+    auto done = std::make_shared<std::promise<CallResult>>();
+    auto result = done->get_future();
+    Scheduler::forCard(volume->getCard()).post([state = state, volume, sequence, done] {
+        if (!state->start(volume.get(), &State::Latest::read, sequence)) {
+            done->set_value(CallResult{CallStatus::Superseded, 0});
+            return;
+        }
+        done->set_value(CallResult{CallStatus::Ok, volume->getVolume()});
+    });
+    if (result.wait_until(deadline) != std::future_status::ready)
+        return CallResult{CallStatus::Timeout, 0};
+    return result.get();
+}
+
+CallStatus DeadlineCaller::commit(std::span<const VolumeLevel> levels, Clock::time_point deadline)
+{
+    struct Write {
+        VolumeLevel level;
+        std::uint64_t sequence;
+    };
+
+    std::map<int, std::vector<Write>> cards;
+    for (const auto &level : levels)
+        cards[level.volume->getCard()].push_back(Write{level, state->claim(level.volume.get(), &State::Latest::write)});
+
+    std::vector<std::future<void>> results;
+    for (auto &[card, writes] : cards)
+    {
+        auto done = std::make_shared<std::promise<void>>();
+        results.push_back(done->get_future());
+        Scheduler::forCard(card).post([state = state, writes = std::move(writes), done] {
+            for (const auto &write : writes)
+            {
+                if (state->start(write.level.volume.get(), &State::Latest::write, write.sequence))
+                    write.level.volume->setVolume(write.level.level);
+            }
+            done->set_value();
+        });
+    }
+
+    for (auto &result : results)
+    {
+        if (result.wait_until(deadline) != std::future_status::ready)
+            return CallStatus::Timeout;
+    }
+    return CallStatus::Ok;
+}
+
+/// @brief Get the library wide instance.
+/// @return Reference to the DeadlineCaller instance.
+DeadlineCaller &DeadlineCaller::instance()
+{
+    static DeadlineCaller caller;
+    return caller;
+}
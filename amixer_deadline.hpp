@@ -0,0 +1,107 @@
+/*
+
+Copyright (c) 2025 Pawel Sklarow https://github.com/psklarow
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+of the Software, and to permit persons to whom the Software is furnished to do
+so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+ */
+
+ // Note: this code has been developed with AI assistance.
+
+/// @file amixer_deadline.hpp
+/// @brief Volume calls bounded by a deadline.
+/// A misbehaving (e.g. USB) card may block an ALSA call for hundreds of milliseconds. The calls below
+/// run the hardware I/O on the card Scheduler thread and wait for it only until the deadline, so the
+/// caller's time budget is kept even when the card is slow.
+
+#ifndef __AMIXER_DEADLINE_HPP__
+#define __AMIXER_DEADLINE_HPP__
+
+#include "amixer.hpp"
+#include "amixer_scheduler.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <span>
+
+/// @brief Status of a call bounded by a deadline.
+enum class CallStatus {
+    Ok,         // completed before the deadline
+    Timeout,    // not completed before the deadline; it still runs later unless superseded
+    Superseded, // skipped, as a later call for the same channel was made before it started
+};
+
+/// @brief Result of a call bounded by a deadline.
+struct CallResult {
+    CallStatus status;
+    int value; // volume read by getVolume(), 0 otherwise
+};
+
+/// @brief Caller of volume operations with deadlines.
+/// Calls for the same channel supersede each other: a write (or read) which has not started yet when
+/// a later write (or read) for the channel is made is skipped, so a slow card catches up with the most
+/// recent request instead of working through stale ones, and late completions never overwrite newer values.
+class DeadlineCaller {
+public:
+    using Clock = Scheduler::Clock;
+
+    DeadlineCaller();
+    ~DeadlineCaller();
+
+    DeadlineCaller(const DeadlineCaller &) = delete;
+    DeadlineCaller &operator=(const DeadlineCaller &) = delete;
+
+    /// @brief Set volume, waiting for the write until the deadline.
+    /// @param volume Volume channel
+    /// @param level Volume percentage (0..100)
+    /// @param deadline Point in time on the monotonic clock
+    CallResult setVolume(const std::shared_ptr<IVolume> &volume, int level, Clock::time_point deadline);
+
+    /// @brief Read volume, waiting for the read until the deadline.
+    /// @param volume Volume channel
+    /// @param deadline Point in time on the monotonic clock
+    CallResult getVolume(const std::shared_ptr<IVolume> &volume, Clock::time_point deadline);
+
+    /// @brief Write a batch of volumes, all cards in parallel, waiting for them until the deadline.
+    /// Writes superseded by later calls count as completed.
+    /// @param levels Channels and their volumes
+    /// @param deadline Point in time on the monotonic clock
+    /// @return Ok if all cards were written in time, Timeout otherwise.
+    CallStatus commit(std::span<const VolumeLevel> levels, Clock::time_point deadline);
+
+    CallResult setVolume(const std::shared_ptr<IVolume> &volume, int level, std::chrono::milliseconds timeout) {
+        return setVolume(volume, level, Clock::now() + timeout);
+    }
+    CallResult getVolume(const std::shared_ptr<IVolume> &volume, std::chrono::milliseconds timeout) {
+        return getVolume(volume, Clock::now() + timeout);
+    }
+    CallStatus commit(std::span<const VolumeLevel> levels, std::chrono::milliseconds timeout) {
+        return commit(levels, Clock::now() + timeout);
+    }
+
+    /// @brief Get the library wide instance.
+    static DeadlineCaller &instance();
+
+private:
+    struct State;
+
+    std::shared_ptr<State> state; // shared with queued calls, which may outlive the caller
+};
+
+#endif // __AMIXER_DEADLINE_HPP__
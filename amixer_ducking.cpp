@@ -0,0 +1,215 @@
+/*
+
+Copyright (c) 2025 Pawel Sklarow https://github.com/psklarow
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+of the Software, and to permit persons to whom the Software is furnished to do
+so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+ */
+
+/// @file amixer_ducking.cpp
+/// @brief Priority based ducking engine implementation.
+///
+/// Note: this code has been developed with AI assistance.
+
+#include "amixer_ducking.hpp"
+#include "amixer_balance.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+Ducker::~Ducker()
+{
+    std::unique_lock lock(mutex);
+    stopping = true;
+    idle.wait(lock, [this] { return ticking.empty(); });
+}
+
+Ducker::DuckId Ducker::duck(std::span<const DuckTarget> targets, int priority, Duration attack, Duration release)
+{
+    auto snapshot = mixer.getSnapshot();
+    std::lock_guard lock(mutex);
+    auto id = nextId++;
+    for (const auto &target : targets)
+    {
+        if (!target.volume)
+            continue;
+        auto [it, inserted] = channels.try_emplace(target.volume.get());
+        auto &channel = it->second;
+        if (inserted)
+        {
+            auto state = std::ranges::find_if(snapshot.channels, [&](const ChannelSnapshot &c) { return c.volume == target.volume; });
+            if (state == snapshot.channels.end())
+            {
+                channels.erase(it);
+                continue;
+            }
+            channel.volume = target.volume;
+            channel.card = target.volume->getCard();
+            channel.level = state->volumeLevel;
+            channel.balance = appliedBalance(state->volumeLevel, state->balance);
+        }
+        channel.ducks.push_back(Duck{id, priority, std::abs(target.depthDb), release});
+        retarget(channel, attack);
+        startTicking(channel.card);
+    }
+    return id;
+}
+
+void Ducker::release(DuckId id)
+{
+    std::lock_guard lock(mutex);
+    for (auto &[key, channel] : channels)
+    {
+        auto duck = std::ranges::find(channel.ducks, id, &Duck::id);
+        if (duck == channel.ducks.end())
+            continue;
+        auto ramp = duck->release;
+        channel.ducks.erase(duck);
+        retarget(channel, ramp);
+        startTicking(channel.card);
+    }
+}
+
+bool Ducker::isDucked(const std::shared_ptr<IVolume> &volume)
+{
+    std::lock_guard lock(mutex);
+    auto it = channels.find(volume.get());
+    return it != channels.end() && !it->second.ducks.empty();
+}
+
+/// @brief Start a new ramp from the current attenuation to the depth of the winning duck.
+/// The winning duck has the highest priority; among equal priorities the deepest one wins.
+void Ducker::retarget(Channel &channel, Duration ramp)
+{
+    double depth = 0.0;
+    int priority = 0;
+    bool found = false;
+    for (const auto &duck : channel.ducks)
+    {
+        if (!found || duck.priority > priority || (duck.priority == priority && duck.depthDb > depth))
+        {
+            depth = duck.depthDb;
+            priority = duck.priority;
+            found = true;
+        }
+    }
+    channel.startDb = channel.currentDb;
+    channel.targetDb = -depth;
+    channel.rampStart = Clock::now();
+    channel.rampLength = ramp;
+}
+
+void Ducker::startTicking(int card)
+{
+    if (stopping || !ticking.insert(card).second)
+        return;
+    Scheduler::forCard(card).post([this, card] { tick(card); });
+}
+
+/// @brief Get progress of the ramp of a channel, 0.0 at its start .. 1.0 when finished.
+static double rampProgress(Scheduler::Clock::time_point now, Scheduler::Clock::time_point start, Scheduler::Clock::duration length)
+{
+    if (length.count() <= 0)
+        return 1.0;
+    return std::clamp(std::chrono::duration<double>(now - start) / std::chrono::duration<double>(length), 0.0, 1.0);
+}
+
+/// @brief Check whether a channel of the card has not reached the end of its ramp or waits to be restored.
+/// The attenuation written last is compared rather than the time, as a slow write may outlast the ramp.
+bool Ducker::pending(int card) const
+{
+    return std::ranges::any_of(channels, [&](const auto &entry) {
+        const auto &channel = entry.second;
+        return channel.card == card && (channel.ducks.empty() || channel.currentDb != channel.targetDb);
+    });
+}
+
+/// @brief Advance the ramps of the channels of one card and write their new levels.
+/// Runs on the card scheduler. The attenuation is computed under the lock from the elapsed time, not
+/// from the number of steps, so a late step catches up instead of stretching the ramp; the levels are
+/// written after the lock is released, so duck() and release() do not wait for the card.
+/// A channel which has no ducks left and has finished its ramp gets its pre-duck levels back.
+void Ducker::tick(int card)
+{
+    struct Write {
+        Channel *channel;           // nullptr once the channel has been restored and removed
+        std::shared_ptr<IVolume> volume;
+        std::vector<int> base;
+        int level;
+        int balance;
+        double db;
+    };
+    std::vector<Write> writes;
+    std::vector<std::pair<std::shared_ptr<IVolume>, std::vector<int>>> restores;
+    {
+        std::lock_guard lock(mutex);
+        auto now = Clock::now();
+        for (auto it = channels.begin(); !stopping && it != channels.end();)
+        {
+            auto &channel = it->second;
+            if (channel.card != card)
+            {
+                ++it;
+                continue;
+            }
+            double progress = rampProgress(now, channel.rampStart, channel.rampLength);
+            if (progress >= 1.0 && channel.ducks.empty())
+            {
+                if (!channel.base.empty()) // nothing to restore if the channel has never been written
+                    restores.emplace_back(std::move(channel.volume), std::move(channel.base));
+                it = channels.erase(it);
+                continue;
+            }
+            double db = progress >= 1.0 ? channel.targetDb : channel.startDb + (channel.targetDb - channel.startDb) * progress;
+            if (db != channel.currentDb)
+            {
+                channel.currentDb = db;
+                writes.push_back(Write{&channel, channel.volume, channel.base, channel.level, channel.balance, db});
+            }
+            ++it;
+        }
+    }
+
+    // only this thread removes the channels of the card, so the written ones stay in the map
+    std::vector<int> volumes;
+    for (auto &write : writes)
+    {
+        if (write.base.empty())
+            write.base = balancedLevels(*write.volume, write.level, write.balance);
+        volumes.resize(write.base.size());
+        for (std::size_t i = 0; i < volumes.size(); ++i)
+            volumes[i] = write.volume->volumeForGain(write.base[i], write.db);
+        write.volume->setChannelVolumes(volumes);
+    }
+    for (const auto &[volume, base] : restores)
+        volume->setChannelVolumes(base);
+
+    std::lock_guard lock(mutex);
+    for (auto &write : writes)
+    {
+        if (write.channel->base.empty())
+            write.channel->base = std::move(write.base);
+    }
+    if (!stopping && pending(card))
+    {
+        Scheduler::forCard(card).scheduleAfter(ControlLatency::instance().stepInterval(card, stepInterval), [this, card] { tick(card); });
+        return;
+    }
+    ticking.erase(card);
+    idle.notify_all();
+}
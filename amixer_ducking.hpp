@@ -0,0 +1,133 @@
+/*
+
+Copyright (c) 2025 Pawel Sklarow https://github.com/psklarow
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+of the Software, and to permit persons to whom the Software is furnished to do
+so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+ */
+
+ // Note: this code has been developed with AI assistance.
+
+/// @file amixer_ducking.hpp
+/// @brief Priority based ducking of volume channels.
+/// Ducking temporarily lowers volume of channels (e.g. music in other rooms) while an announcement
+/// or doorbell plays, and restores them afterwards.
+
+#ifndef __AMIXER_DUCKING_HPP__
+#define __AMIXER_DUCKING_HPP__
+
+#include "amixer.hpp"
+#include "amixer_scheduler.hpp"
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <span>
+#include <vector>
+
+/// @brief Channel to duck and how deep.
+struct DuckTarget {
+    std::shared_ptr<IVolume> volume;
+    double depthDb; // attenuation in dB, e.g. 20.0 lowers the channel by 20 dB
+};
+
+/// @brief Ducking engine.
+/// Each duck() call creates a duck with a priority, affecting a set of channels.
+/// Ducks may overlap and nest: the effective depth of a channel is the depth of the highest priority
+/// duck active on it (the deepest one, if several have the same priority).
+/// When the last duck of a channel is released, the channel returns to the volume and balance it had
+/// before the first duck, regardless of volume changes made meanwhile.
+/// The state before the duck is taken from the mixer snapshot and volume ramps run on the card Scheduler
+/// threads, so duck() and release() never wait for hardware and a slow card does not delay the others.
+class Ducker {
+public:
+    using DuckId = std::uint64_t;
+    using Duration = std::chrono::milliseconds;
+
+    /// @brief Constructor
+    /// @param mixer Mixer the ducked channels belong to
+    explicit Ducker(IMixer &mixer) : mixer(mixer) {}
+
+    /// @brief Destructor
+    /// Waits for the ramps in progress to stop. The card schedulers must outlive the engine.
+    ~Ducker();
+
+    Ducker(const Ducker &) = delete;
+    Ducker &operator=(const Ducker &) = delete;
+
+    /// @brief Start ducking channels.
+    /// @param targets Channels and their duck depths; channels not in the mixer snapshot are skipped
+    /// @param priority Duck priority, higher value wins
+    /// @param attack Duration of the ramp down
+    /// @param release Duration of the ramp back up when the duck is released
+    /// @return Identifier of the duck, to be passed to release()
+    DuckId duck(std::span<const DuckTarget> targets, int priority = 0,
+                Duration attack = Duration(50), Duration release = Duration(500));
+
+    /// @brief Release the duck, ramping the channels to the depth of remaining ducks or restoring them.
+    /// @param id Duck identifier returned by duck()
+    void release(DuckId id);
+
+    /// @brief Check whether the channel is currently ducked.
+    bool isDucked(const std::shared_ptr<IVolume> &volume);
+
+private:
+    using Clock = Scheduler::Clock;
+
+    static constexpr auto stepInterval = std::chrono::milliseconds(5); // for cards with unmeasured latency
+
+    struct Duck {
+        DuckId id;
+        int priority;
+        double depthDb;
+        Duration release;
+    };
+
+    struct Channel {
+        std::shared_ptr<IVolume> volume;
+        int card;
+        int level;                      // volume before the first duck, from the mixer snapshot
+        int balance;                    // balance before the first duck, as setBalance() takes it
+        std::vector<int> base;          // per-channel levels of level and balance, computed on the card thread
+        std::vector<Duck> ducks;        // active ducks
+        double currentDb{0.0};          // attenuation currently written to hardware
+        double startDb{0.0};            // attenuation at start of the ramp
+        double targetDb{0.0};           // attenuation at end of the ramp
+        Clock::time_point rampStart;
+        Clock::duration rampLength{};
+    };
+
+    void retarget(Channel &channel, Duration ramp);
+    void startTicking(int card);
+    void tick(int card);
+    bool pending(int card) const;
+
+    IMixer &mixer;
+    std::mutex mutex;
+    std::condition_variable idle;
+    std::map<IVolume *, Channel> channels;
+    std::set<int> ticking; // cards with a tick scheduled on their card scheduler
+    DuckId nextId{1};
+    bool stopping{false};
+};
+
+#endif // __AMIXER_DUCKING_HPP__
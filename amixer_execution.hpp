@@ -0,0 +1,463 @@
+/*
+
+Copyright (c) 2025 Pawel Sklarow https://github.com/psklarow
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+of the Software, and to permit persons to whom the Software is furnished to do
+so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+ */
+
+ // Note: this code has been developed with AI assistance.
+
+/// @file amixer_execution.hpp
+/// @brief Sender adaptors (P2300, stdexec) for volume operations.
+/// Header only, as senders are templates over their receivers; requires <stdexec/execution.hpp>.
+/// Operation states live in the connected operation. Tasks posted to the library Scheduler capture only
+/// the operation state and an index (smallTask()), which std::function stores inline, so no task is
+/// allocated; ChangeSender allocates its listener registration once per operation.
+///
+/// Every operation has two forms: one running on the card Scheduler of the channel, and one taking
+/// any stdexec scheduler, e.g. of the audio pipeline, to avoid a thread hop:
+///     auto s = stdexec::when_all(setVolumeSender(speaker, 40), fadeSender(sub, 80, 300ms))
+///            | stdexec::then([] { ... });
+///     stdexec::sync_wait(std::move(s));
+///
+/// MixerScheduler wraps library schedulers as stdexec schedulers: MixerScheduler::forCard(card)
+/// runs on the thread writing the card, MixerScheduler::events() on the thread delivering change events.
+
+#ifndef __AMIXER_EXECUTION_HPP__
+#define __AMIXER_EXECUTION_HPP__
+
+#if !__has_include(<stdexec/execution.hpp>)
+#error "amixer_execution.hpp requires stdexec (https://github.com/NVIDIA/stdexec)"
+#endif
+
+#include "amixer.hpp"
+#include "amixer_balance.hpp"
+#include "amixer_scheduler.hpp"
+
+#include <stdexec/execution.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <exception>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/// @brief Wrap a callable posted to the library Scheduler, checking that std::function keeps it inline.
+/// Standard libraries store trivially copyable callables of up to two pointers without allocation.
+template <class F>
+Scheduler::Task smallTask(F f) {
+    static_assert(sizeof(F) <= 2 * sizeof(void *) && std::is_trivially_copyable_v<F>,
+                  "scheduler task must capture at most two pointers");
+    return Scheduler::Task(f);
+}
+
+/// @brief Library Scheduler exposed as a stdexec scheduler.
+class MixerScheduler {
+public:
+    explicit MixerScheduler(Scheduler &scheduler) noexcept : scheduler(&scheduler) {}
+
+    /// @brief Scheduler of the thread writing the card.
+    static MixerScheduler forCard(int card) { return MixerScheduler(Scheduler::forCard(card)); }
+
+    /// @brief Scheduler of the thread delivering change events (IMixer::addChangeListener()).
+    static MixerScheduler events() { return MixerScheduler(Scheduler::instance()); }
+
+    using scheduler_concept = stdexec::scheduler_t;
+
+    template <class Receiver>
+    struct Operation {
+        using operation_state_concept = stdexec::operation_state_t;
+
+        Scheduler *scheduler;
+        Receiver receiver;
+
+        void start() & noexcept {
+            try {
+                scheduler->post(smallTask([this] { complete(); }));
+            } catch (...) {
+                stdexec::set_error(std::move(receiver), std::current_exception());
+            }
+        }
+
+        void complete() noexcept {
+            if (stdexec::get_stop_token(stdexec::get_env(receiver)).stop_requested())
+                stdexec::set_stopped(std::move(receiver));
+            else
+                stdexec::set_value(std::move(receiver));
+        }
+    };
+
+    struct Env {
+        Scheduler *scheduler;
+
+        template <class Tag>
+        MixerScheduler query(stdexec::get_completion_scheduler_t<Tag>) const noexcept {
+            return MixerScheduler(*scheduler);
+        }
+    };
+
+    struct ScheduleSender {
+        using sender_concept = stdexec::sender_t;
+        using completion_signatures = stdexec::completion_signatures<
+            stdexec::set_value_t(), stdexec::set_error_t(std::exception_ptr), stdexec::set_stopped_t()>;
+
+        Scheduler *scheduler;
+
+        template <class Receiver>
+        Operation<Receiver> connect(Receiver receiver) const {
+            return Operation<Receiver>{scheduler, std::move(receiver)};
+        }
+
+        Env get_env() const noexcept { return Env{scheduler}; }
+    };
+
+    ScheduleSender schedule() const noexcept { return ScheduleSender{scheduler}; }
+
+    bool operator==(const MixerScheduler &) const = default;
+
+private:
+    Scheduler *scheduler;
+};
+
+/// @brief Set volume of the channel on the given scheduler.
+template <class Sched>
+auto setVolumeSender(Sched sched, std::shared_ptr<IVolume> volume, int level) {
+    return stdexec::then(stdexec::schedule(sched), [volume = std::move(volume), level] { volume->setVolume(level); });
+}
+
+/// @brief Set volume of the channel on its card scheduler.
+inline auto setVolumeSender(std::shared_ptr<IVolume> volume, int level) {
+    auto sched = MixerScheduler::forCard(volume->getCard());
+    return setVolumeSender(sched, std::move(volume), level);
+}
+
+/// @brief Read volume of the channel on the given scheduler; completes with the volume percentage.
+template <class Sched>
+auto getVolumeSender(Sched sched, std::shared_ptr<IVolume> volume) {
+    return stdexec::then(stdexec::schedule(sched), [volume = std::move(volume)] { return volume->getVolume(); });
+}
+
+/// @brief Read volume of the channel on its card scheduler.
+inline auto getVolumeSender(std::shared_ptr<IVolume> volume) {
+    auto sched = MixerScheduler::forCard(volume->getCard());
+    return getVolumeSender(sched, std::move(volume));
+}
+
+/// @brief Sender setting volumes of many channels, each card on its own card scheduler in parallel.
+/// Completes when all cards have been written.
+class BatchSender {
+public:
+    using sender_concept = stdexec::sender_t;
+    using completion_signatures = stdexec::completion_signatures<
+        stdexec::set_value_t(), stdexec::set_error_t(std::exception_ptr), stdexec::set_stopped_t()>;
+
+    struct Part {
+        int card;
+        std::vector<VolumeLevel> levels;
+    };
+
+    explicit BatchSender(std::vector<VolumeLevel> levels) {
+        std::map<int, std::size_t> partOfCard;
+        for (auto &level : levels) {
+            int card = level.volume->getCard();
+            auto [it, inserted] = partOfCard.try_emplace(card, parts.size());
+            if (inserted)
+                parts.push_back(Part{card, {}});
+            parts[it->second].levels.push_back(std::move(level));
+        }
+    }
+
+    template <class Receiver>
+    struct Operation {
+        using operation_state_concept = stdexec::operation_state_t;
+
+        std::vector<Part> parts;
+        Receiver receiver;
+        std::atomic<std::size_t> remaining{0};
+        std::atomic<bool> failed{false};
+        std::exception_ptr error{};
+
+        void start() & noexcept {
+            if (parts.empty()) {
+                stdexec::set_value(std::move(receiver));
+                return;
+            }
+            remaining = parts.size();
+            for (std::size_t i = 0; i < parts.size(); ++i) {
+                try {
+                    Scheduler::forCard(parts[i].card).post(smallTask([this, i] { write(i); }));
+                } catch (...) {
+                    fail(std::current_exception());
+                    finish(parts.size() - i);
+                    return;
+                }
+            }
+        }
+
+        void write(std::size_t i) noexcept {
+            try {
+                for (const auto &level : parts[i].levels)
+                    level.volume->setVolume(level.level);
+            } catch (...) {
+                fail(std::current_exception());
+            }
+            finish(1);
+        }
+
+        void fail(std::exception_ptr e) noexcept {
+            if (!failed.exchange(true))
+                error = std::move(e);
+        }
+
+        void finish(std::size_t count) noexcept {
+            if (remaining.fetch_sub(count) != count)
+                return;
+            if (failed)
+                stdexec::set_error(std::move(receiver), std::move(error));
+            else
+                stdexec::set_value(std::move(receiver));
+        }
+    };
+
+    template <class Receiver>
+    Operation<Receiver> connect(Receiver receiver) && {
+        return Operation<Receiver>{std::move(parts), std::move(receiver)};
+    }
+
+private:
+    std::vector<Part> parts;
+};
+
+/// @brief Set volumes of many channels in one operation.
+inline BatchSender setVolumesSender(std::vector<VolumeLevel> levels) {
+    return BatchSender(std::move(levels));
+}
+
+/// @brief Sender fading the channel from its current volume to the target volume on its card scheduler.
+/// Steps write all channels at once, keeping the balance. Missed steps are skipped; a stop request ends
+/// the fade at the level reached so far.
+class FadeSender {
+public:
+    using sender_concept = stdexec::sender_t;
+    using completion_signatures = stdexec::completion_signatures<
+        stdexec::set_value_t(), stdexec::set_error_t(std::exception_ptr), stdexec::set_stopped_t()>;
+    using Duration = std::chrono::milliseconds;
+
+    FadeSender(std::shared_ptr<IVolume> volume, int target, Duration duration, Duration stepInterval)
+        : volume(std::move(volume)), target(std::clamp(target, 0, 100)),
+          stepInterval(ControlLatency::instance().resolve(this->volume->getCard(), stepInterval, Duration(10))),
+          steps(static_cast<std::size_t>(std::max<Duration::rep>(duration / this->stepInterval, 0))) {}
+
+    template <class Receiver>
+    struct Operation {
+        using operation_state_concept = stdexec::operation_state_t;
+
+        std::shared_ptr<IVolume> volume;
+        int target;
+        Duration stepInterval;
+        std::size_t steps;
+        Receiver receiver;
+        int from{0};
+        int balance{0};
+        std::vector<int> positions{}; // ALSA channel positions of the volume
+        Scheduler::Clock::time_point origin{};
+
+        void start() & noexcept {
+            try {
+                scheduler().post(smallTask([this] {
+                    from = volume->getVolume();
+                    balance = appliedBalance(from, volume->getBalance());
+                    positions.resize(volume->channelCount());
+                    for (std::size_t i = 0; i < positions.size(); ++i)
+                        positions[i] = volume->getChannelPosition(i);
+                    origin = Scheduler::Clock::now();
+                    step(1);
+                }));
+            } catch (...) {
+                stdexec::set_error(std::move(receiver), std::current_exception());
+            }
+        }
+
+        Scheduler &scheduler() { return Scheduler::forCard(volume->getCard()); }
+
+        void step(std::size_t index) noexcept {
+            if (stdexec::get_stop_token(stdexec::get_env(receiver)).stop_requested()) {
+                stdexec::set_stopped(std::move(receiver));
+                return;
+            }
+            try {
+                index = std::min(index, steps);
+                double progress = steps == 0 ? 1.0 : static_cast<double>(index) / steps;
+                volume->setChannelVolumes(balancedLevels(positions, lround(from + (target - from) * progress), balance));
+                if (index >= steps) {
+                    stdexec::set_value(std::move(receiver));
+                    return;
+                }
+                auto behind = static_cast<std::size_t>((Scheduler::Clock::now() - origin) / stepInterval) + 1;
+                auto next = std::max(index + 1, behind);
+                scheduler().schedule(origin + stepInterval * static_cast<Duration::rep>(next), smallTask([this, next] { step(next); }));
+            } catch (...) {
+                stdexec::set_error(std::move(receiver), std::current_exception());
+            }
+        }
+    };
+
+    template <class Receiver>
+    Operation<Receiver> connect(Receiver receiver) && {
+        return Operation<Receiver>{std::move(volume), target, stepInterval, steps, std::move(receiver)};
+    }
+
+private:
+    std::shared_ptr<IVolume> volume;
+    int target;
+    Duration stepInterval;
+    std::size_t steps;
+};
+
+/// @brief Fade volume of the channel to the target level.
+/// A zero step interval selects the interval suitable for the card (ControlLatency::stepInterval()).
+inline FadeSender fadeSender(std::shared_ptr<IVolume> volume, int target, std::chrono::milliseconds duration,
+                             std::chrono::milliseconds stepInterval = std::chrono::milliseconds::zero()) {
+    return FadeSender(std::move(volume), target, duration, stepInterval);
+}
+
+/// @brief Sender waiting until state of the channel satisfies a predicate.
+/// Completes with the channel state on the events scheduler, or immediately if the predicate already holds.
+/// A stop request completes it with set_stopped.
+class ChangeSender {
+public:
+    using sender_concept = stdexec::sender_t;
+    using completion_signatures = stdexec::completion_signatures<
+        stdexec::set_value_t(ChannelSnapshot), stdexec::set_error_t(std::exception_ptr), stdexec::set_stopped_t()>;
+    using Predicate = std::function<bool(const ChannelSnapshot &)>;
+
+    ChangeSender(IMixer &mixer, std::shared_ptr<IVolume> volume, Predicate predicate)
+        : mixer(&mixer), volume(std::move(volume)), predicate(std::move(predicate)) {}
+
+    template <class Receiver>
+    struct Operation {
+        using operation_state_concept = stdexec::operation_state_t;
+        using StopToken = stdexec::stop_token_of_t<stdexec::env_of_t<Receiver>>;
+
+        /// @brief State shared with the change listener, which may run after the operation has completed.
+        struct Wait {
+            std::mutex mutex;
+            bool done{false};
+            std::uint64_t listener{0};
+        };
+
+        struct OnStop {
+            Operation *operation;
+            void operator()() const noexcept {
+                if (operation->claim())
+                    operation->release();
+            }
+        };
+
+        IMixer *mixer;
+        std::shared_ptr<IVolume> volume;
+        Predicate predicate;
+        Receiver receiver;
+        std::shared_ptr<Wait> wait{std::make_shared<Wait>()};
+        std::optional<ChannelSnapshot> result{};
+        std::exception_ptr error{};
+        std::atomic<int> pending{2}; // start() and the one claiming completion; the last one completes
+        std::optional<stdexec::stop_callback_for_t<StopToken, OnStop>> onStop{}; // destroyed first
+
+        void start() & noexcept {
+            try {
+                wait->listener = mixer->addChangeListener([this, wait = wait](const ChannelSnapshot &channel) {
+                    {
+                        std::lock_guard lock(wait->mutex);
+                        if (wait->done || channel.volume != volume || !predicate(channel))
+                            return;
+                        wait->done = true;
+                        result = channel;
+                    }
+                    release();
+                });
+
+                auto snapshot = mixer->getSnapshot();
+                auto it = std::ranges::find(snapshot.channels, volume, &ChannelSnapshot::volume);
+                bool satisfied = false;
+                {
+                    std::lock_guard lock(wait->mutex);
+                    if (!wait->done && it != snapshot.channels.end() && predicate(*it)) {
+                        wait->done = satisfied = true;
+                        result = *it;
+                    }
+                }
+                if (satisfied)
+                    release();
+                else
+                    onStop.emplace(stdexec::get_stop_token(stdexec::get_env(receiver)), OnStop{this});
+            } catch (...) {
+                if (claim()) {
+                    error = std::current_exception();
+                    release();
+                }
+            }
+            release();
+        }
+
+        /// @brief Mark the wait done; only the first caller may complete the receiver.
+        bool claim() noexcept {
+            std::lock_guard lock(wait->mutex);
+            return !std::exchange(wait->done, true);
+        }
+
+        void release() noexcept {
+            if (pending.fetch_sub(1, std::memory_order_acq_rel) != 1)
+                return;
+            onStop.reset(); // the receiver may be destroyed on completion, with its stop token
+            mixer->removeChangeListener(wait->listener);
+            if (error)
+                stdexec::set_error(std::move(receiver), std::move(error));
+            else if (result)
+                stdexec::set_value(std::move(receiver), std::move(*result));
+            else
+                stdexec::set_stopped(std::move(receiver));
+        }
+    };
+
+    template <class Receiver>
+    Operation<Receiver> connect(Receiver receiver) && {
+        return Operation<Receiver>{mixer, std::move(volume), std::move(predicate), std::move(receiver)};
+    }
+
+private:
+    IMixer *mixer;
+    std::shared_ptr<IVolume> volume;
+    Predicate predicate;
+};
+
+/// @brief Wait until state of the channel satisfies the predicate.
+inline ChangeSender changeSender(IMixer &mixer, std::shared_ptr<IVolume> volume, ChangeSender::Predicate predicate) {
+    return ChangeSender(mixer, std::move(volume), std::move(predicate));
+}
+
+#endif // __AMIXER_EXECUTION_HPP__
@@ -0,0 +1,630 @@
+/*
+
+Copyright (c) 2025 Pawel Sklarow https://github.com/psklarow
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+of the Software, and to permit persons to whom the Software is furnished to do
+so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+ */
+
+/// @file amixer_fake.cpp
+/// @brief In-memory mixer backend implementation.
+///
+/// Note: this code has been developed with AI assistance.
+
+#include "amixer_fake.hpp"
+#include "amixer_balance.hpp"
+#include "amixer_scheduler.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <future>
+#include <iomanip>
+#include <sstream>
+#include <thread>
+#include <utility>
+
+static const char *const channelNames[] = {
+    "Front Left", "Front Right", "Rear Left", "Rear Right", "Front Center", "Woofer", "Side Left", "Side Right",
+    "Rear Center",
+};
+
+FakeVolume::FakeVolume(FakeMixer &mixer, std::size_t index, FakeChannel description)
+    : mixer(mixer), index(index), description(std::move(description))
+{
+    auto &m = mixer.cardMutexes[this->description.card];
+    if (!m)
+        m = std::make_unique<std::mutex>();
+    cardMutex = m.get();
+    auto &positions = this->description.positions;
+    std::erase_if(positions, [](int p) { return p < 0 || p >= static_cast<int>(std::size(channelNames)); });
+    if (positions.empty())
+    {
+        auto count = std::clamp<std::size_t>(this->description.channels, 1, std::size(channelNames));
+        for (std::size_t i = 0; i < count; ++i)
+            positions.push_back(static_cast<int>(i));
+    }
+    this->description.channels = positions.size();
+    levels.assign(this->description.channels, 0);
+}
+
+/// @brief Emulate latency of a hardware access; accesses of one card are serialized as by the card mutex.
+/// Short latencies are spun, as sleeping would overshoot them.
+void FakeVolume::access(bool write)
+{
+    auto latency = write ? description.writeLatency : description.readLatency;
+    if (latency <= std::chrono::nanoseconds::zero())
+        return;
+    std::lock_guard lock(*cardMutex);
+    auto until = std::chrono::steady_clock::now() + latency;
+    if (latency > std::chrono::microseconds(200))
+        std::this_thread::sleep_until(until);
+    while (std::chrono::steady_clock::now() < until)
+        ;
+}
+
+long FakeVolume::dbOf(long raw) const
+{
+    const auto &d = description;
+    if (!d.dbSteps.empty())
+        return d.dbSteps[std::clamp<std::size_t>(static_cast<std::size_t>(raw - d.rawMin), 0, d.dbSteps.size() - 1)];
+    return d.dbMin + (d.dbMax - d.dbMin) * (raw - d.rawMin) / (d.rawMax - d.rawMin);
+}
+
+/// @brief Quantize level to what the hardware would store and report back.
+/// dB elements: percentage maps linearly to the dB range and is rounded down to a raw step.
+/// Elements without dB: percentage maps linearly to the raw range.
+int FakeVolume::quantize(int volume) const
+{
+    const auto &d = description;
+    if (d.rawMax <= d.rawMin)
+        return volume;
+    double norm = volume / 100.0;
+    if (d.dbMax <= d.dbMin)
+    {
+        long raw = d.rawMin + lround(norm * (d.rawMax - d.rawMin));
+        return static_cast<int>(lround(100.0 * (raw - d.rawMin) / (d.rawMax - d.rawMin)));
+    }
+    long dbRange = d.dbMax - d.dbMin;
+    long target = d.dbMin + lround(norm * dbRange);
+    // last raw value not above the target; dB never decreases with raw value
+    long low = d.rawMin, high = d.rawMax;
+    while (low < high)
+    {
+        long middle = low + (high - low + 1) / 2;
+        if (dbOf(middle) <= target)
+            low = middle;
+        else
+            high = middle - 1;
+    }
+    long raw = low;
+    return std::clamp(static_cast<int>(lround(100.0 * (dbOf(raw) - d.dbMin) / dbRange)), 0, 100);
+}
+
+int FakeVolume::volumeLocked() const
+{
+    const auto &current = held.empty() ? levels : held;
+    return std::ranges::max(current);
+}
+
+int FakeVolume::balanceLocked() const
+{
+    if (description.channels < 2)
+        return 0;
+    const auto &current = held.empty() ? levels : held;
+    return current[1] - current[0];
+}
+
+void FakeVolume::writeLocked(std::vector<int> volumes)
+{
+    for (auto &v : volumes)
+        v = quantize(std::clamp(v, 0, 100));
+    if (!held.empty())
+        held = std::move(volumes);
+    else if (volumes != levels)
+    {
+        levels = std::move(volumes);
+        ++writes;
+    }
+    mixer.changed(index);
+}
+
+void FakeVolume::applyLocked(int volume, int balance)
+{
+    writeLocked(balancedLevels(description.positions, volume, balance));
+    balanceSetting = {balance, held.empty() ? levels : held};
+}
+
+void FakeVolume::setVolume(int volume)
+{
+    access(true);
+    std::lock_guard lock(mixer.mutex);
+    const auto &current = held.empty() ? levels : held;
+    applyLocked(std::clamp(volume, 0, 100), keptBalance(description.positions, current, balanceSetting));
+}
+
+void FakeVolume::setBalance(int balance)
+{
+    if (description.channels < 2)
+        return;
+    access(true);
+    std::lock_guard lock(mixer.mutex);
+    applyLocked(volumeLocked(), std::clamp(balance, -100, 100));
+}
+
+int FakeVolume::getVolume()
+{
+    access(false);
+    std::lock_guard lock(mixer.mutex);
+    return volumeLocked();
+}
+
+int FakeVolume::getBalance()
+{
+    access(false);
+    std::lock_guard lock(mixer.mutex);
+    return balanceLocked();
+}
+
+const std::string FakeVolume::getChannelName(std::size_t index)
+{
+    if (index >= description.channels)
+        return {};
+    return description.channels == 1 ? "Mono" : channelNames[description.positions[index]];
+}
+
+int FakeVolume::getChannelPosition(std::size_t index)
+{
+    return index < description.channels ? description.positions[index] : -1;
+}
+
+void FakeVolume::getChannelVolumes(std::span<int> volumes)
+{
+    access(false);
+    std::lock_guard lock(mixer.mutex);
+    const auto &current = held.empty() ? levels : held;
+    std::copy_n(current.begin(), std::min(volumes.size(), current.size()), volumes.begin());
+}
+
+void FakeVolume::setChannelVolumes(std::span<const int> volumes)
+{
+    access(true);
+    std::lock_guard lock(mixer.mutex);
+    auto current = held.empty() ? levels : held;
+    std::copy_n(volumes.begin(), std::min(volumes.size(), current.size()), current.begin());
+    writeLocked(std::move(current));
+}
+
+void FakeVolume::setSwitch(bool on)
+{
+    if (!description.hasSwitch)
+        return;
+    access(true);
+    std::lock_guard lock(mixer.mutex);
+    if (switchOn != on)
+    {
+        switchOn = on;
+        ++writes;
+    }
+    mixer.changed(index);
+}
+
+bool FakeVolume::getSwitch()
+{
+    access(false);
+    std::lock_guard lock(mixer.mutex);
+    return !description.hasSwitch || switchOn;
+}
+
+void FakeVolume::setMute(bool mute, [[maybe_unused]] int fadeMs)
+{
+    access(true);
+    std::lock_guard lock(mixer.mutex);
+    muteLocked(mute);
+}
+
+void FakeVolume::muteLocked(bool mute)
+{
+    if (mute == muted)
+        return;
+    muted = mute;
+    if (description.hasSwitch)
+    {
+        switchOn = !mute;
+        ++writes;
+    }
+    else if (mute)
+    {
+        held = std::exchange(levels, std::vector<int>(description.channels, 0));
+        ++writes;
+    }
+    else
+    {
+        levels = std::exchange(held, {});
+        ++writes;
+    }
+    mixer.changed(index);
+}
+
+std::optional<long> FakeVolume::volumeDbLocked(int volume) const
+{
+    long range = description.dbMax - description.dbMin;
+    if (range <= 0)
+        return std::nullopt;
+    return description.dbMin + lround(std::clamp(volume / 100.0, 0.0, 1.0) * range);
+}
+
+/// @brief Follow the state of the master of a link, as the ALSA mixer does: on the dB scales of both
+/// elements, or by volumeForGain() when either has none.
+void FakeVolume::followLocked(int volume, std::optional<long> masterDb, int balance, bool mute, double offsetDb)
+{
+    int level = 0;
+    long range = description.dbMax - description.dbMin;
+    if (volume > 0 && masterDb && range > 0)
+        level = std::clamp(static_cast<int>(lround(100.0 * static_cast<double>(*masterDb + lround(offsetDb * 100.0) - description.dbMin) / static_cast<double>(range))), 0, 100);
+    else if (volume > 0)
+        level = volumeForGain(volume, offsetDb);
+    applyLocked(level, description.channels >= 2 ? appliedBalance(volume, balance) : 0);
+    muteLocked(mute);
+}
+
+bool FakeVolume::isMuted()
+{
+    std::lock_guard lock(mixer.mutex);
+    return muted || !switchOn;
+}
+
+int FakeVolume::volumeForGain(int volume, double gainDb)
+{
+    long range = description.dbMax - description.dbMin;
+    if (range <= 0)
+        return std::clamp(volume, 0, 100);
+    return std::clamp(volume + static_cast<int>(lround(gainDb * 10000.0 / range)), 0, 100);
+}
+
+std::expected<void, std::error_code> FakeVolume::trySetVolume(int volume)
+{
+    switch (mixer.cardHealth(description.card)) {
+    case CardHealth::Gone:
+        return std::unexpected(std::error_code(ENODEV, std::generic_category()));
+    case CardHealth::Degraded:
+        return std::unexpected(std::error_code(EBUSY, std::generic_category()));
+    default:
+        setVolume(volume);
+        return {};
+    }
+}
+
+std::expected<int, std::error_code> FakeVolume::tryGetVolume()
+{
+    switch (mixer.cardHealth(description.card)) {
+    case CardHealth::Gone:
+        return std::unexpected(std::error_code(ENODEV, std::generic_category()));
+    case CardHealth::Degraded:
+        return std::unexpected(std::error_code(EBUSY, std::generic_category()));
+    default:
+        return getVolume();
+    }
+}
+
+std::uint64_t FakeVolume::writeCount() const
+{
+    std::lock_guard lock(mixer.mutex);
+    return writes;
+}
+
+FakeMixer::FakeMixer(const std::vector<FakeChannel> &channels)
+{
+    // construct the scheduler first, so it outlives the mixer and its notifications
+    Scheduler::instance();
+    for (bool captureList : {false, true})
+    {
+        for (const auto &channel : channels)
+        {
+            if (channel.capture != captureList)
+                continue;
+            auto volume = std::make_shared<FakeVolume>(*this, volumes.size(), channel);
+            volumes.push_back(volume);
+            (captureList ? capture : playback).push_back(volume);
+        }
+    }
+    generations.assign(volumes.size(), 0);
+
+    // the fake has no events; the emulated write latency stands for the measured round trip
+    std::map<int, std::chrono::nanoseconds> latency;
+    for (const auto &channel : channels)
+        latency[channel.card] = std::max(latency[channel.card], channel.writeLatency);
+    for (const auto &[card, roundTrip] : latency)
+    {
+        if (roundTrip > std::chrono::nanoseconds::zero())
+            ControlLatency::instance().record(card, roundTrip);
+    }
+}
+
+/// @brief Destructor
+/// Waits for notifications already posted to the scheduler, as they refer to the mixer.
+FakeMixer::~FakeMixer()
+{
+    auto &scheduler = Scheduler::instance();
+    if (scheduler.isSchedulerThread())
+        return;
+    std::promise<void> drained;
+    scheduler.post([&drained] { drained.set_value(); });
+    drained.get_future().wait();
+}
+
+ChannelSnapshot FakeMixer::snapshotLocked(std::size_t index) const
+{
+    const auto &volume = volumes[index];
+    return ChannelSnapshot{volume, volume->volumeLocked(), volume->balanceLocked(),
+                           volume->muted || !volume->switchOn, generations[index]};
+}
+
+MixerSnapshot FakeMixer::changedSince(std::uint64_t since) const
+{
+    std::lock_guard lock(mutex);
+    MixerSnapshot snapshot;
+    snapshot.generation = generation;
+    for (std::size_t i = 0; i < volumes.size(); ++i)
+    {
+        if (since == 0 || generations[i] > since)
+            snapshot.channels.push_back(snapshotLocked(i));
+    }
+    return snapshot;
+}
+
+void FakeMixer::changed(std::size_t index)
+{
+    generations[index] = ++generation;
+    propagateLocked(index);
+    {
+        std::lock_guard lock(listenersMutex);
+        if (listeners.empty())
+            return;
+    }
+    Scheduler::instance().post([this, index] {
+        ChannelSnapshot channel;
+        {
+            std::lock_guard lock(mutex);
+            channel = snapshotLocked(index);
+        }
+        std::vector<ChangeListener> current;
+        {
+            std::lock_guard lock(listenersMutex);
+            for (const auto &[id, listener] : listeners)
+                current.push_back(listener);
+        }
+        for (const auto &listener : current)
+            listener(channel);
+    });
+}
+
+std::uint64_t FakeMixer::addChangeListener(ChangeListener listener)
+{
+    std::lock_guard lock(listenersMutex);
+    auto id = ++lastListenerId;
+    listeners.emplace(id, std::move(listener));
+    return id;
+}
+
+void FakeMixer::removeChangeListener(std::uint64_t id)
+{
+    std::lock_guard lock(listenersMutex);
+    listeners.erase(id);
+}
+
+CardIdentity FakeMixer::cardIdentity(int card) const
+{
+    for (const auto &volume : volumes)
+    {
+        const auto &description = volume->channel();
+        if (description.card == card)
+            return CardIdentity{description.cardId.empty() ? "Fake" + std::to_string(card) : description.cardId,
+                                description.cardLongName};
+    }
+    return {};
+}
+
+CardHealth FakeMixer::cardHealth(int card) const
+{
+    std::lock_guard lock(mutex);
+    auto it = health.find(card);
+    return it == health.end() ? CardHealth::Healthy : it->second;
+}
+
+void FakeMixer::setCardHealth(int card, CardHealth state)
+{
+    std::lock_guard lock(mutex);
+    auto &current = health[card];
+    if ((current == CardHealth::Gone) != (state == CardHealth::Gone))
+        ++layout;
+    current = state;
+}
+
+bool saveProfile(const std::string &path, const std::vector<FakeChannel> &channels)
+{
+    std::ofstream out(path);
+    if (!out)
+        return false;
+    out << "# amixer hardware profile v1\n"
+           "# element card \"name\" playback|capture [id \"ID\" \"LONGNAME\"] channels N [map POSITION...]"
+           " switch 0|1 raw MIN MAX db MIN MAX latency READ-NS WRITE-NS [steps DB...]\n";
+    for (const auto &c : channels)
+    {
+        out << "element " << c.card << ' ' << std::quoted(c.name) << ' ' << (c.capture ? "capture" : "playback");
+        if (!c.cardId.empty())
+            out << " id " << std::quoted(c.cardId) << ' ' << std::quoted(c.cardLongName);
+        out << " channels " << c.channels;
+        if (!c.positions.empty())
+        {
+            out << " map";
+            for (int position : c.positions)
+                out << ' ' << position;
+        }
+        out << " switch " << c.hasSwitch << " raw " << c.rawMin << ' ' << c.rawMax
+            << " db " << c.dbMin << ' ' << c.dbMax << " latency " << c.readLatency.count() << ' '
+            << c.writeLatency.count();
+        if (!c.dbSteps.empty())
+        {
+            out << " steps";
+            for (long db : c.dbSteps)
+                out << ' ' << db;
+        }
+        out << '\n';
+    }
+    out.flush();
+    return static_cast<bool>(out);
+}
+
+bool loadProfile(const std::string &path, std::vector<FakeChannel> &channels)
+{
+    std::ifstream in(path);
+    if (!in)
+        return false;
+    std::vector<FakeChannel> loaded;
+    std::string line;
+    while (std::getline(in, line))
+    {
+        std::istringstream fields(line);
+        std::string keyword, direction, key;
+        FakeChannel c;
+        if (!(fields >> keyword) || keyword != "element")
+            continue;
+        fields >> c.card >> std::quoted(c.name) >> direction;
+        c.capture = direction == "capture";
+        while (fields >> key)
+        {
+            if (key == "channels")
+                fields >> c.channels;
+            else if (key == "id")
+                fields >> std::quoted(c.cardId) >> std::quoted(c.cardLongName);
+            else if (key == "map")
+            {
+                c.positions.resize(std::min<std::size_t>(c.channels, 32)); // SND_MIXER_SCHN_LAST + 1
+                for (auto &position : c.positions)
+                    fields >> position;
+            }
+            else if (key == "switch")
+                fields >> c.hasSwitch;
+            else if (key == "raw")
+                fields >> c.rawMin >> c.rawMax;
+            else if (key == "db")
+                fields >> c.dbMin >> c.dbMax;
+            else if (key == "latency")
+            {
+                long long read = 0, write = 0;
+                fields >> read >> write;
+                c.readLatency = std::chrono::nanoseconds(read);
+                c.writeLatency = std::chrono::nanoseconds(write);
+            }
+            else if (key == "steps")
+            {
+                for (long db; fields >> db;)
+                    c.dbSteps.push_back(db);
+            }
+        }
+        if (fields.fail() && !fields.eof())
+            continue;
+        if (!c.dbSteps.empty() && c.dbSteps.size() != static_cast<std::size_t>(c.rawMax - c.rawMin + 1))
+            c.dbSteps.clear();
+        loaded.push_back(std::move(c));
+    }
+    if (loaded.empty())
+    {
+        errno = EINVAL;
+        return false;
+    }
+    channels = std::move(loaded);
+    return true;
+}
+
+std::optional<std::size_t> FakeMixer::indexOf(const IVolume *volume) const
+{
+    auto it = std::ranges::find(volumes, volume, [](const std::shared_ptr<FakeVolume> &v) -> const IVolume * { return v.get(); });
+    if (!volume || it == volumes.end())
+        return std::nullopt;
+    return static_cast<std::size_t>(it - volumes.begin());
+}
+
+/// @brief Remove the link of a slave; called with the mutex locked.
+bool FakeMixer::removeLinkLocked(std::size_t slave)
+{
+    auto it = masters.find(slave);
+    if (it == masters.end())
+        return false;
+    auto &slaves = links[it->second];
+    std::erase_if(slaves, [&](const Link &link) { return link.slave == slave; });
+    if (slaves.empty())
+        links.erase(it->second);
+    masters.erase(it);
+    return true;
+}
+
+/// @brief Make the slaves linked to a channel follow its state; called with the mutex locked.
+void FakeMixer::propagateLocked(std::size_t index)
+{
+    auto it = links.find(index);
+    if (it == links.end())
+        return;
+    const auto &master = volumes[index];
+    int volume = master->volumeLocked();
+    int balance = master->balanceLocked();
+    bool muted = master->muted || !master->switchOn;
+    auto masterDb = master->volumeDbLocked(volume);
+    auto slaves = it->second;
+    for (const auto &link : slaves)
+        volumes[link.slave]->followLocked(volume, masterDb, balance, muted, link.offsetDb);
+}
+
+bool FakeMixer::link(const std::shared_ptr<IVolume> &master, const std::shared_ptr<IVolume> &slave, double offsetDb)
+{
+    std::lock_guard lock(mutex);
+    auto masterIndex = indexOf(master.get());
+    auto slaveIndex = indexOf(slave.get());
+    if (!masterIndex || !slaveIndex)
+    {
+        errno = EINVAL;
+        return false;
+    }
+    for (auto index = *masterIndex;;)
+    {
+        if (index == *slaveIndex)
+        {
+            errno = EINVAL;
+            return false;
+        }
+        auto it = masters.find(index);
+        if (it == masters.end())
+            break;
+        index = it->second;
+    }
+    removeLinkLocked(*slaveIndex);
+    links[*masterIndex].push_back(Link{*slaveIndex, offsetDb});
+    masters[*slaveIndex] = *masterIndex;
+    propagateLocked(*masterIndex);
+    return true;
+}
+
+bool FakeMixer::unlink(const std::shared_ptr<IVolume> &slave)
+{
+    std::lock_guard lock(mutex);
+    auto slaveIndex = indexOf(slave.get());
+    return slaveIndex && removeLinkLocked(*slaveIndex);
+}
@@ -0,0 +1,205 @@
+/*
+
+Copyright (c) 2025 Pawel Sklarow https://github.com/psklarow
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+of the Software, and to permit persons to whom the Software is furnished to do
+so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+ */
+
+ // Note: this code has been developed with AI assistance.
+
+/// @file amixer_fake.hpp
+/// @brief In-memory mixer backend for tests, benchmarks and replay without sound cards.
+
+#ifndef __AMIXER_FAKE_HPP__
+#define __AMIXER_FAKE_HPP__
+
+#include "amixer.hpp"
+#include "amixer_balance.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+
+class FakeMixer;
+
+/// @brief Description of one fake volume channel; also the hardware profile of a mixer element.
+/// With a raw range, levels are quantized the way the ALSA implementation writes them: percentage is
+/// mapped to dB (or linearly to raw values for elements without dB), rounded down to a raw step, and
+/// read back through the step table.
+struct FakeChannel {
+    int card{0};
+    std::string name;             // e.g. "Speaker"
+    bool capture{false};
+    std::size_t channels{2};      // 1 for mono, 2 for stereo (front left, front right), up to 9
+    std::vector<int> positions{}; // ALSA channel position of every channel (0 front left .. 8 rear center),
+                                  // empty for the first channels in ALSA order
+    bool hasSwitch{true};
+    long dbMin{-6400};            // dB range in 1/100 dB, equal for elements without dB
+    long dbMax{0};
+    long rawMin{0};               // raw range, equal for ideal (unquantized) percentage levels
+    long rawMax{0};
+    std::vector<long> dbSteps{};  // dB of every raw value from rawMin (TLV), empty to interpolate dB range
+    std::chrono::nanoseconds readLatency{};  // emulated duration of a read, serialized per card
+    std::chrono::nanoseconds writeLatency{}; // emulated duration of a write, serialized per card
+    std::string cardId{};                    // ALSA card id, empty for "Fake<card>"
+    std::string cardLongName{};              // ALSA card long name, with the USB path of USB cards
+};
+
+/// @brief Save hardware profiles to a text file, one element per line.
+/// @return false on failure (errno is set).
+bool saveProfile(const std::string &path, const std::vector<FakeChannel> &channels);
+
+/// @brief Load hardware profiles saved by saveProfile() or captured by amixer_profile.
+/// @return false if the file cannot be read or has no valid element line (errno is set).
+bool loadProfile(const std::string &path, std::vector<FakeChannel> &channels);
+
+/// @brief Volume channel of FakeMixer.
+/// Follows the semantics of the ALSA implementation: volume is the maximum of the channel levels,
+/// balance attenuates the quieter side, mute uses the switch or holds levels while writing zero.
+/// Fades are not emulated, mute takes effect immediately.
+class FakeVolume : public IVolume {
+public:
+    FakeVolume(FakeMixer &mixer, std::size_t index, FakeChannel description);
+
+    void setVolume(int volume) override;
+    void setBalance(int balance) override;
+    const std::string getName() override { return description.name; }
+    int getCard() override { return description.card; }
+    int getVolume() override;
+    int getBalance() override;
+    std::size_t channelCount() override { return description.channels; }
+    const std::string getChannelName(std::size_t index) override;
+    int getChannelPosition(std::size_t index) override;
+    void getChannelVolumes(std::span<int> volumes) override;
+    void setChannelVolumes(std::span<const int> volumes) override;
+    bool isCapture() override { return description.capture; }
+    bool hasSwitch() override { return description.hasSwitch; }
+    void setSwitch(bool on) override;
+    bool getSwitch() override;
+    void setMute(bool mute, int fadeMs = 0) override;
+    bool isMuted() override;
+    int volumeForGain(int volume, double gainDb) override;
+    std::expected<void, std::error_code> trySetVolume(int volume) override;
+    std::expected<int, std::error_code> tryGetVolume() override;
+
+    /// @brief Get description of the channel.
+    const FakeChannel &channel() const { return description; }
+
+    /// @brief Get number of writes made to the fake hardware (levels and switch).
+    std::uint64_t writeCount() const;
+
+private:
+    friend class FakeMixer;
+
+    /// @brief Emulate latency of a hardware access.
+    void access(bool write);
+
+    /// @brief Quantize level to what the hardware would store.
+    int quantize(int volume) const;
+    long dbOf(long raw) const;
+
+    // called with the mixer mutex locked
+    int volumeLocked() const;
+    int balanceLocked() const;
+    void applyLocked(int volume, int balance);
+    void writeLocked(std::vector<int> volumes);
+    void muteLocked(bool mute);
+    std::optional<long> volumeDbLocked(int volume) const;
+    void followLocked(int volume, std::optional<long> masterDb, int balance, bool mute, double offsetDb);
+
+    FakeMixer &mixer;
+    std::size_t index;
+    FakeChannel description;
+    std::mutex *cardMutex;           // serializes emulated hardware accesses of the card
+    std::vector<int> levels;         // current hardware levels, per channel
+    std::vector<int> held;           // levels held while muted without switch
+    BalanceSetting balanceSetting;   // balance kept while only the volume is set
+    bool switchOn{true};
+    bool muted{false};
+    std::uint64_t writes{0};
+};
+
+/// @brief In-memory mixer.
+/// Channels are created from descriptions instead of enumerating sound cards. State, generations
+/// and change listeners behave like the ALSA mixer; listeners are called on Scheduler::instance().
+/// Linked slaves are written together with their master, without emulated latency of their own.
+class FakeMixer : public IMixer {
+public:
+    explicit FakeMixer(const std::vector<FakeChannel> &channels);
+    ~FakeMixer() override;
+
+    const std::list<std::shared_ptr<IVolume>> &channels() const override { return playback; }
+    const std::list<std::shared_ptr<IVolume>> &captureChannels() const override { return capture; }
+    MixerSnapshot getSnapshot() const override { return changedSince(0); }
+    MixerSnapshot changedSince(std::uint64_t generation) const override;
+    std::uint64_t addChangeListener(ChangeListener listener) override;
+    void removeChangeListener(std::uint64_t id) override;
+    CardHealth cardHealth(int card) const override;
+    CardIdentity cardIdentity(int card) const override;
+    ReapplyStats reapplyStats() const override { return {}; }
+    std::uint64_t layoutGeneration() const override { return layout.load(); }
+    bool link(const std::shared_ptr<IVolume> &master, const std::shared_ptr<IVolume> &slave, double offsetDb) override;
+    bool unlink(const std::shared_ptr<IVolume> &slave) override;
+
+    /// @brief Set health of a card; calls to a Degraded card fail with EBUSY, to a Gone card with ENODEV.
+    /// A card becoming Gone or coming back changes the layout generation, as card removal does.
+    void setCardHealth(int card, CardHealth health);
+
+private:
+    friend class FakeVolume;
+
+    /// @brief Record change of a channel; called with the mutex locked.
+    void changed(std::size_t index);
+
+    ChannelSnapshot snapshotLocked(std::size_t index) const;
+
+    /// @brief Slave channel of a link.
+    struct Link {
+        std::size_t slave;
+        double offsetDb;
+    };
+
+    std::optional<std::size_t> indexOf(const IVolume *volume) const;
+    bool removeLinkLocked(std::size_t slave);
+    void propagateLocked(std::size_t index);
+
+    mutable std::recursive_mutex mutex;
+    std::list<std::shared_ptr<IVolume>> playback;
+    std::list<std::shared_ptr<IVolume>> capture;
+    std::vector<std::shared_ptr<FakeVolume>> volumes; // playback followed by capture, snapshot order
+    std::vector<std::uint64_t> generations;           // per channel
+    std::uint64_t generation{0};
+    std::atomic<std::uint64_t> layout{0};
+    std::map<std::size_t, std::vector<Link>> links;   // slaves by index of their master
+    std::map<std::size_t, std::size_t> masters;       // master index by slave index
+    std::map<int, CardHealth> health;
+    std::map<int, std::unique_ptr<std::mutex>> cardMutexes;
+    std::mutex listenersMutex;
+    std::map<std::uint64_t, ChangeListener> listeners;
+    std::uint64_t lastListenerId{0};
+};
+
+#endif // __AMIXER_FAKE_HPP__
@@ -0,0 +1,261 @@
+/*
+
+Copyright (c) 2025 Pawel Sklarow https://github.com/psklarow
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+of the Software, and to permit persons to whom the Software is furnished to do
+so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+ */
+
+/// @file amixer_group.cpp
+/// @brief Hierarchical channel groups implementation.
+///
+/// Note: this code has been developed with AI assistance.
+
+#include "amixer_group.hpp"
+#include "amixer_balance.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <set>
+
+/// @brief Run an operation on each member on the Scheduler thread of its card (Scheduler::forEachCard()).
+/// @param members Members, only their volumes are used
+/// @param operation Operation taking a member index; it owns its data, as it may run after the call returns
+/// @return true if the call has waited for all cards.
+template <typename Operation>
+static bool batch(const std::vector<ChannelSnapshot> &members, Operation operation)
+{
+    std::map<int, std::vector<std::size_t>> membersOfCard;
+    for (std::size_t i = 0; i < members.size(); ++i)
+        membersOfCard[members[i].volume->getCard()].push_back(i);
+
+    std::vector<int> cards;
+    std::vector<std::vector<std::size_t>> indexes;
+    for (auto &[card, list] : membersOfCard)
+    {
+        cards.push_back(card);
+        indexes.push_back(std::move(list));
+    }
+    return Scheduler::forEachCard(cards, [indexes = std::move(indexes), operation = std::move(operation)](std::size_t card) {
+        for (auto i : indexes[card])
+            operation(i);
+    });
+}
+
+ChannelGroup::ChannelGroup(IMixer &mixer, std::string name)
+    : mixer(mixer), name(std::move(name))
+{
+}
+
+void ChannelGroup::add(std::shared_ptr<IVolume> volume)
+{
+    std::lock_guard lock(mutex);
+    volumeList.push_back(std::move(volume));
+}
+
+bool ChannelGroup::add(std::shared_ptr<ChannelGroup> group)
+{
+    if (!group || group->contains(*this))
+        return false;
+    std::lock_guard lock(mutex);
+    groupList.push_back(std::move(group));
+    return true;
+}
+
+bool ChannelGroup::remove(const std::shared_ptr<IVolume> &volume)
+{
+    std::lock_guard lock(mutex);
+    return std::erase(volumeList, volume) > 0;
+}
+
+bool ChannelGroup::remove(const std::shared_ptr<ChannelGroup> &group)
+{
+    std::lock_guard lock(mutex);
+    return std::erase(groupList, group) > 0;
+}
+
+bool ChannelGroup::contains(const ChannelGroup &group) const
+{
+    if (&group == this)
+        return true;
+    std::vector<std::shared_ptr<ChannelGroup>> nested;
+    {
+        std::lock_guard lock(mutex);
+        nested = groupList;
+    }
+    return std::ranges::any_of(nested, [&](const auto &child) { return child->contains(group); });
+}
+
+std::vector<std::shared_ptr<IVolume>> ChannelGroup::volumes() const
+{
+    std::vector<std::shared_ptr<IVolume>> result;
+    std::set<IVolume *> seen;
+    std::vector<std::shared_ptr<ChannelGroup>> nested;
+    {
+        std::lock_guard lock(mutex);
+        for (const auto &volume : volumeList)
+        {
+            if (seen.insert(volume.get()).second)
+                result.push_back(volume);
+        }
+        nested = groupList;
+    }
+    for (const auto &group : nested)
+    {
+        for (auto &volume : group->volumes())
+        {
+            if (seen.insert(volume.get()).second)
+                result.push_back(std::move(volume));
+        }
+    }
+    return result;
+}
+
+/// @brief Get cached state of all members, in the order of volumes().
+/// Members missing in the mixer snapshot are left out.
+std::vector<ChannelSnapshot> ChannelGroup::members() const
+{
+    auto snapshot = mixer.getSnapshot();
+    std::vector<ChannelSnapshot> result;
+    for (const auto &volume : volumes())
+    {
+        auto it = std::ranges::find(snapshot.channels, volume, &ChannelSnapshot::volume);
+        if (it != snapshot.channels.end())
+            result.push_back(std::move(*it));
+    }
+    return result;
+}
+
+/// @brief Move all members by the same amount, keeping their offsets.
+/// @param volume Target volume of the loudest member, or the amount to move by when relative
+/// @param relative true if volume is an amount to move by
+/// @param duration Fade duration, zero to write at once
+void ChannelGroup::shift(int volume, bool relative, Duration duration)
+{
+    auto current = members();
+    std::unique_lock lock(mutex);
+    if (current.empty())
+        return;
+
+    // a member still at the level the group has written continues from the level and balance the group meant
+    std::vector<int> base;
+    std::vector<int> balances;
+    for (const auto &member : current)
+    {
+        auto it = tracks.find(member.volume.get());
+        bool tracked = it != tracks.end() && std::abs(it->second.written - member.volumeLevel) <= trackTolerance;
+        base.push_back(tracked ? it->second.intended : member.volumeLevel);
+        balances.push_back(tracked ? it->second.balance : appliedBalance(member.volumeLevel, member.balance));
+    }
+    int loudest = std::ranges::max(base);
+    int delta = relative ? volume : std::clamp(volume, 0, 100) - loudest;
+    delta = std::clamp(delta, -loudest, 100 - loudest);
+
+    std::vector<int> targets;
+    std::map<IVolume *, Track> updated;
+    for (std::size_t i = 0; i < current.size(); ++i)
+    {
+        targets.push_back(std::clamp(base[i] + delta, 0, 100));
+        updated[current[i].volume.get()] = Track{targets.back(), base[i] + delta, balances[i]};
+    }
+    tracks = std::move(updated);
+
+    if (duration > Duration::zero())
+    {
+        std::vector<std::shared_ptr<IVolume>> volumes;
+        for (const auto &member : current)
+            volumes.push_back(member.volume);
+        if (!fade || fade->members() != volumes)
+            fade = std::make_unique<SyncGroup>(std::move(volumes));
+        fade->fadeTo(targets, balances, duration);
+        return;
+    }
+
+    if (fade)
+        fade->stop();
+    lock.unlock();
+    bool waited = batch(current, [current, targets, balances](std::size_t i) {
+        current[i].volume->setChannelVolumes(balancedLevels(*current[i].volume, targets[i], balances[i]));
+    });
+    if (!waited)
+        return;
+
+    // keep the levels the hardware has stored, which may differ from the targets by quantization
+    auto written = members();
+    lock.lock();
+    for (const auto &member : written)
+    {
+        if (auto it = tracks.find(member.volume.get()); it != tracks.end())
+            it->second.written = member.volumeLevel;
+    }
+}
+
+void ChannelGroup::setVolume(int volume)
+{
+    shift(volume, false, Duration::zero());
+}
+
+void ChannelGroup::adjust(int delta)
+{
+    shift(delta, true, Duration::zero());
+}
+
+void ChannelGroup::fadeTo(int volume, Duration duration)
+{
+    shift(volume, false, duration);
+}
+
+void ChannelGroup::setMute(bool mute, int fadeMs)
+{
+    auto current = members();
+    batch(current, [current, mute, fadeMs](std::size_t i) {
+        current[i].volume->setMute(mute, fadeMs);
+    });
+}
+
+void ChannelGroup::stopFade()
+{
+    std::lock_guard lock(mutex);
+    if (fade)
+        fade->stop();
+}
+
+int ChannelGroup::maxVolume() const
+{
+    int result = 0;
+    for (const auto &member : members())
+        result = std::max(result, member.volumeLevel);
+    return result;
+}
+
+int ChannelGroup::averageVolume() const
+{
+    auto current = members();
+    if (current.empty())
+        return 0;
+    long sum = 0;
+    for (const auto &member : current)
+        sum += member.volumeLevel;
+    return static_cast<int>(lround(static_cast<double>(sum) / current.size()));
+}
+
+bool ChannelGroup::isMuted() const
+{
+    auto current = members();
+    return !current.empty() && std::ranges::all_of(current, &ChannelSnapshot::muted);
+}
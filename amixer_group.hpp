@@ -0,0 +1,149 @@
+/*
+
+Copyright (c) 2025 Pawel Sklarow https://github.com/psklarow
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+of the Software, and to permit persons to whom the Software is furnished to do
+so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+ */
+
+ // Note: this code has been developed with AI assistance.
+
+/// @file amixer_group.hpp
+/// @brief Hierarchical groups of volume channels (e.g. house, floor, room) with aggregate operations.
+
+#ifndef __AMIXER_GROUP_HPP__
+#define __AMIXER_GROUP_HPP__
+
+#include "amixer.hpp"
+#include "amixer_sync.hpp"
+
+#include <chrono>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/// @brief Named group of volume channels and nested groups.
+/// Operations apply to all volumes of the group and its nested groups, each volume once. They are run
+/// as one batch: volumes are grouped per card and all cards are written in parallel on their card
+/// Scheduler threads, and the call returns when all cards are written. Called from a Scheduler thread
+/// (e.g. a change listener), the call does not wait for the other cards, which may be waiting for that
+/// thread. Current levels and balances are taken from the mixer snapshot and fades read their starting
+/// levels on the card threads, so the caller never waits for hardware under the group lock.
+///
+/// Volume changes keep the relative offsets between members: setVolume() brings the loudest member to
+/// the volume and moves the others by the same amount. The group remembers levels clamped at 0 or 100,
+/// so turning a floor all the way down and up again restores the offsets and balances between its rooms,
+/// unless a room has been changed meanwhile by other means.
+class ChannelGroup {
+public:
+    using Duration = std::chrono::milliseconds;
+
+    /// @brief Constructor
+    /// @param mixer Mixer of the volumes; its snapshot is the cache for aggregate reads
+    /// @param name Group name, e.g. "First floor"
+    ChannelGroup(IMixer &mixer, std::string name);
+
+    ChannelGroup(const ChannelGroup &) = delete;
+    ChannelGroup &operator=(const ChannelGroup &) = delete;
+
+    const std::string &getName() const { return name; }
+
+    /// @brief Add a volume channel to the group.
+    void add(std::shared_ptr<IVolume> volume);
+
+    /// @brief Add a nested group.
+    /// @return false if the group would contain itself.
+    bool add(std::shared_ptr<ChannelGroup> group);
+
+    /// @brief Remove a volume channel from the group (not from nested groups).
+    /// @return false if the volume is not a direct member.
+    bool remove(const std::shared_ptr<IVolume> &volume);
+
+    /// @brief Remove a nested group.
+    /// @return false if the group is not a direct member.
+    bool remove(const std::shared_ptr<ChannelGroup> &group);
+
+    /// @brief Check whether the group contains a group, directly or through nested groups.
+    bool contains(const ChannelGroup &group) const;
+
+    /// @brief Get all volumes of the group and its nested groups, each volume once.
+    std::vector<std::shared_ptr<IVolume>> volumes() const;
+
+    /// @brief Set volume of the loudest member, moving the other members by the same amount.
+    /// @param volume Volume percentage (0..100)
+    void setVolume(int volume);
+
+    /// @brief Move all members by the same amount, e.g. -10 for "floor down 10%".
+    /// The amount is limited so that the loudest member stays within 0..100.
+    /// @param delta Change in volume percentage points
+    void adjust(int delta);
+
+    /// @brief Mute or unmute all members.
+    /// @param mute true to mute, false to unmute
+    /// @param fadeMs Fade duration in milliseconds, see IVolume::setMute()
+    void setMute(bool mute, int fadeMs = 0);
+
+    /// @brief Fade the loudest member to the volume, moving the other members by the same amount.
+    /// All members are faded on a common timeline (SyncGroup); the call does not wait for the fade.
+    /// @param volume Volume percentage (0..100)
+    /// @param duration Fade duration
+    void fadeTo(int volume, Duration duration);
+
+    /// @brief Stop the fade in progress, leaving members at their current levels.
+    void stopFade();
+
+    /// @brief Get volume of the loudest member from the mixer snapshot.
+    /// @return Volume percentage (0..100), 0 for an empty group.
+    int maxVolume() const;
+
+    /// @brief Get average volume of the members from the mixer snapshot.
+    /// @return Volume percentage (0..100), 0 for an empty group.
+    int averageVolume() const;
+
+    /// @brief Check from the mixer snapshot whether all members are muted.
+    /// @return true if all members are muted, false if any is not or the group is empty.
+    bool isMuted() const;
+
+private:
+    /// @brief Level the group has written to a member, the level it meant before clamping, and the balance.
+    /// The balance is kept as setBalance() takes it (see appliedBalance()), as the balance read back from
+    /// levels near zero is lost to rounding.
+    struct Track {
+        int written;  // read back after the write when the call waits for it, otherwise the target
+        int intended;
+        int balance;
+    };
+
+    static constexpr int trackTolerance = 2; // percentage points a read back level may differ by quantization
+
+    std::vector<ChannelSnapshot> members() const;
+    void shift(int volume, bool relative, Duration fade);
+
+    IMixer &mixer;
+    std::string name;
+
+    mutable std::mutex mutex;
+    std::vector<std::shared_ptr<IVolume>> volumeList;
+    std::vector<std::shared_ptr<ChannelGroup>> groupList;
+    std::map<IVolume *, Track> tracks;
+    std::unique_ptr<SyncGroup> fade;
+};
+
+#endif // __AMIXER_GROUP_HPP__
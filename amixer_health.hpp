@@ -0,0 +1,130 @@
+/*
+
+Copyright (c) 2025 Pawel Sklarow https://github.com/psklarow
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+of the Software, and to permit persons to whom the Software is furnished to do
+so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+ */
+
+ // Note: this code has been developed with AI assistance.
+
+/// @file amixer_health.hpp
+/// @brief Health tracking of sound cards with retries and backoff.
+/// Header only, so the policy is shared by the ALSA mixer and can be checked without a sound card.
+
+#ifndef __AMIXER_HEALTH_HPP__
+#define __AMIXER_HEALTH_HPP__
+
+#include "amixer.hpp"
+#include "amixer_scheduler.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+
+/// @brief Health of a card, tracked from the results of its ALSA calls.
+/// All calls go through call(), under the card mutex. Transient errors are retried a few times with
+/// exponential backoff, waiting without the card mutex where possible; if they persist, the card is degraded and calls fail fast until the backoff,
+/// which doubles on every failed probe, expires. A card reporting ENODEV is gone and its calls fail
+/// immediately, so dead devices cost no system calls.
+class CardHealthState {
+public:
+    using Clock = Scheduler::Clock;
+
+    /// @brief Get health state of a card.
+    /// @param card ALSA card number
+    static CardHealthState &of(int card) {
+        static std::array<CardHealthState, 32> states; // SNDRV_CARDS
+        return states[static_cast<unsigned>(card) % states.size()];
+    }
+
+    CardHealth state() const {
+        return health.load(std::memory_order_relaxed);
+    }
+
+    /// @brief Run ALSA call with retries, updating the health of the card.
+    /// @param op Call returning 0 (or a positive value) on success, negative ALSA error code on failure
+    /// @param pause Called with the delay before each retry, returns false if the call must not be retried
+    ///              (e.g. the element has changed while the card mutex was released)
+    /// @return Result of the last attempt, or the error of the card if it fails fast.
+    template <class Op, class Pause>
+    int call(Op &&op, Pause &&pause) {
+        auto current = state();
+        if (current == CardHealth::Gone)
+            return -ENODEV;
+        if (current == CardHealth::Degraded && Clock::now() < retryAt)
+            return lastError;
+
+        auto delay = firstRetryDelay;
+        for (int attempt = 0; ; ++attempt) {
+            int err = op();
+            if (err >= 0) {
+                backoff = {};
+                health.store(CardHealth::Healthy, std::memory_order_relaxed);
+                return err;
+            }
+            if (err == -ENODEV || err == -ENXIO) {
+                lastError = err;
+                health.store(CardHealth::Gone, std::memory_order_relaxed);
+                return err;
+            }
+            if (err != -EBUSY && err != -EAGAIN && err != -EINTR)
+                return err; // not a card failure (e.g. EINVAL)
+            if (attempt == maxRetries) {
+                lastError = err;
+                break;
+            }
+            if (!pause(Clock::duration(delay)))
+                return err;
+            delay *= 2;
+        }
+
+        backoff = std::clamp<Clock::duration>(backoff * 2, minBackoff, maxBackoff);
+        retryAt = Clock::now() + backoff;
+        health.store(CardHealth::Degraded, std::memory_order_relaxed);
+        return lastError;
+    }
+
+    /// @brief Mark the card removed.
+    void markGone() {
+        lastError = -ENODEV;
+        health.store(CardHealth::Gone, std::memory_order_relaxed);
+    }
+
+    /// @brief Forget failures, e.g. after the card has been reopened.
+    void reset() {
+        backoff = {};
+        lastError = 0;
+        health.store(CardHealth::Healthy, std::memory_order_relaxed);
+    }
+
+private:
+    static constexpr int maxRetries = 3;
+    static constexpr auto firstRetryDelay = std::chrono::milliseconds(1);
+    static constexpr Clock::duration minBackoff = std::chrono::milliseconds(10);
+    static constexpr Clock::duration maxBackoff = std::chrono::seconds(1);
+
+    std::atomic<CardHealth> health{CardHealth::Healthy};
+    Clock::time_point retryAt{};
+    Clock::duration backoff{};
+    int lastError{0};
+};
+
+#endif // __AMIXER_HEALTH_HPP__
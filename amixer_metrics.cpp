@@ -0,0 +1,321 @@
+/*
+
+Copyright (c) 2025 Pawel Sklarow https://github.com/psklarow
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+of the Software, and to permit persons to whom the Software is furnished to do
+so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+ */
+
+/// @file amixer_metrics.cpp
+/// @brief Counters and latency histograms of ALSA calls implementation.
+///
+/// Note: this code has been developed with AI assistance.
+
+#include "amixer_metrics.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <map>
+
+std::size_t LatencyHistogram::bucketOf(std::uint64_t us)
+{
+    if (us < 4)
+        return static_cast<std::size_t>(us);
+    auto group = static_cast<std::size_t>(std::bit_width(us) - 1); // >= 2
+    auto sub = static_cast<std::size_t>((us >> (group - 2)) & 3);
+    return std::min<std::size_t>(4 + (group - 2) * 4 + sub, bucketCount - 1);
+}
+
+std::uint64_t LatencyHistogram::upperBound(std::size_t bucket)
+{
+    if (bucket < 4)
+        return bucket + 1;
+    auto group = (bucket - 4) / 4 + 2;
+    auto sub = (bucket - 4) % 4;
+    return (std::uint64_t(1) << group) + ((sub + 1) << (group - 2));
+}
+
+std::chrono::microseconds LatencyHistogram::quantile(double q) const
+{
+    if (count == 0)
+        return {};
+    auto rank = static_cast<std::uint64_t>(std::clamp(q, 0.0, 1.0) * static_cast<double>(count - 1)) + 1;
+    std::uint64_t seen = 0;
+    for (std::size_t i = 0; i < bucketCount; ++i)
+    {
+        seen += buckets[i];
+        if (seen >= rank)
+            return std::chrono::microseconds(upperBound(i));
+    }
+    return std::chrono::microseconds(upperBound(bucketCount - 1));
+}
+
+void LatencyHistogram::merge(const LatencyHistogram &other)
+{
+    for (std::size_t i = 0; i < bucketCount; ++i)
+        buckets[i] += other.buckets[i];
+    count += other.count;
+    sumUs += other.sumUs;
+}
+
+void CallMetrics::merge(const CallMetrics &other)
+{
+    reads += other.reads;
+    writes += other.writes;
+    elidedWrites += other.elidedWrites;
+    errors += other.errors;
+    latency.merge(other.latency);
+}
+
+/// @brief Subtract baseline from totals; counters only grow, so the result is never negative.
+static void subtract(CallMetrics &metrics, const CallMetrics &baseline)
+{
+    metrics.reads -= baseline.reads;
+    metrics.writes -= baseline.writes;
+    metrics.elidedWrites -= baseline.elidedWrites;
+    metrics.errors -= baseline.errors;
+    for (std::size_t i = 0; i < LatencyHistogram::bucketCount; ++i)
+        metrics.latency.buckets[i] -= baseline.latency.buckets[i];
+    metrics.latency.count -= baseline.latency.count;
+    metrics.latency.sumUs -= baseline.latency.sumUs;
+}
+
+/// @brief Counters of one element in one shard; written only by the thread owning the shard.
+struct Metrics::Counters {
+    std::atomic<std::uint64_t> reads{0};
+    std::atomic<std::uint64_t> writes{0};
+    std::atomic<std::uint64_t> elided{0};
+    std::atomic<std::uint64_t> errors{0};
+    std::atomic<std::uint64_t> count{0};
+    std::atomic<std::uint64_t> sumUs{0};
+    std::array<std::atomic<std::uint64_t>, LatencyHistogram::bucketCount> buckets{};
+
+    static void increment(std::atomic<std::uint64_t> &counter, std::uint64_t value = 1) {
+        counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+    }
+
+    void addTo(CallMetrics &metrics) const {
+        metrics.reads += reads.load(std::memory_order_relaxed);
+        metrics.writes += writes.load(std::memory_order_relaxed);
+        metrics.elidedWrites += elided.load(std::memory_order_relaxed);
+        metrics.errors += errors.load(std::memory_order_relaxed);
+        metrics.latency.count += count.load(std::memory_order_relaxed);
+        metrics.latency.sumUs += sumUs.load(std::memory_order_relaxed);
+        for (std::size_t i = 0; i < buckets.size(); ++i)
+            metrics.latency.buckets[i] += buckets[i].load(std::memory_order_relaxed);
+    }
+};
+
+/// @brief Counters of all elements recorded by one thread, allocated on first use of each element.
+struct Metrics::Shard {
+    std::array<std::atomic<Counters *>, maxElements> counters{};
+
+    ~Shard() {
+        for (auto &c : counters)
+            delete c.load(std::memory_order_relaxed);
+    }
+};
+
+/// @brief Live Metrics instances by key.
+/// Leaked, as threads may exit and retire their shards after static objects have been destroyed.
+struct LiveMetrics {
+    std::mutex mutex;
+    std::map<std::uint64_t, Metrics *> instances;
+    std::uint64_t lastKey{0};
+
+    static LiveMetrics &get() {
+        static auto *live = new LiveMetrics;
+        return *live;
+    }
+};
+
+/// @brief Shards of the calling thread, one per Metrics instance; retired when the thread exits.
+/// The instance is looked up by key, so a destroyed instance (which has freed the shards) is skipped.
+struct Metrics::ThreadShards {
+    struct Entry {
+        std::uint64_t key;
+        Shard *shard;
+    };
+    std::vector<Entry> entries;
+
+    ~ThreadShards() {
+        auto &live = LiveMetrics::get();
+        std::lock_guard lock(live.mutex);
+        for (const auto &entry : entries)
+        {
+            if (auto it = live.instances.find(entry.key); it != live.instances.end())
+                it->second->retire(entry.shard);
+        }
+    }
+};
+
+Metrics::Metrics()
+{
+    auto &live = LiveMetrics::get();
+    std::lock_guard lock(live.mutex);
+    key = ++live.lastKey;
+    live.instances[key] = this;
+}
+
+Metrics::~Metrics()
+{
+    auto &live = LiveMetrics::get();
+    std::lock_guard lock(live.mutex);
+    live.instances.erase(key);
+}
+
+Metrics::Shard &Metrics::shard()
+{
+    thread_local ThreadShards local;
+    for (const auto &entry : local.entries)
+    {
+        if (entry.key == key)
+            return *entry.shard;
+    }
+
+    {
+        // forget shards of destroyed instances
+        auto &live = LiveMetrics::get();
+        std::lock_guard lock(live.mutex);
+        std::erase_if(local.entries, [&](const ThreadShards::Entry &entry) { return !live.instances.contains(entry.key); });
+    }
+    std::lock_guard lock(mutex);
+    auto *created = shards.emplace_back(std::make_unique<Shard>()).get();
+    local.entries.push_back(ThreadShards::Entry{key, created});
+    return *created;
+}
+
+/// @brief Merge the shard of an exiting thread into the retired totals and free it.
+void Metrics::retire(Shard *shard)
+{
+    std::lock_guard lock(mutex);
+    for (std::size_t id = 0; id < retired.size(); ++id)
+    {
+        if (auto *c = shard->counters[id].load(std::memory_order_acquire))
+            c->addTo(retired[id]);
+    }
+    std::erase_if(shards, [&](const std::unique_ptr<Shard> &s) { return s.get() == shard; });
+}
+
+Metrics::Counters &Metrics::counters(Id id)
+{
+    auto &slot = shard().counters[id];
+    auto *c = slot.load(std::memory_order_relaxed);
+    if (!c)
+    {
+        c = new Counters;
+        slot.store(c, std::memory_order_release);
+    }
+    return *c;
+}
+
+Metrics::Id Metrics::registerElement(int card, std::string name, bool capture)
+{
+    std::lock_guard lock(mutex);
+    if (elements.size() >= maxElements)
+        return invalidId;
+    elements.push_back(Element{card, std::move(name), capture});
+    retired.emplace_back();
+    baseline.emplace_back();
+    return static_cast<Id>(elements.size() - 1);
+}
+
+void Metrics::setCard(Id id, int card)
+{
+    std::lock_guard lock(mutex);
+    if (id < elements.size())
+        elements[id].card = card;
+}
+
+void Metrics::record(Id id, Kind kind, std::chrono::nanoseconds latency, bool ok)
+{
+    if (id >= maxElements)
+        return;
+    auto &c = counters(id);
+    auto us = static_cast<std::uint64_t>(std::max<std::int64_t>(latency.count() / 1000, 0));
+    Counters::increment(kind == Read ? c.reads : c.writes);
+    if (!ok)
+        Counters::increment(c.errors);
+    Counters::increment(c.count);
+    Counters::increment(c.sumUs, us);
+    Counters::increment(c.buckets[LatencyHistogram::bucketOf(us)]);
+}
+
+void Metrics::recordElided(Id id)
+{
+    if (id >= maxElements)
+        return;
+    Counters::increment(counters(id).elided);
+}
+
+void Metrics::setEnumerationTime(std::chrono::nanoseconds time)
+{
+    std::lock_guard lock(mutex);
+    enumerationTime = time;
+}
+
+/// @brief Sum all shards and the retired totals per element; called with the mutex locked.
+std::vector<CallMetrics> Metrics::totals() const
+{
+    auto result = retired;
+    for (const auto &s : shards)
+    {
+        for (std::size_t id = 0; id < result.size(); ++id)
+        {
+            if (auto *c = s->counters[id].load(std::memory_order_acquire))
+                c->addTo(result[id]);
+        }
+    }
+    return result;
+}
+
+MetricsSnapshot Metrics::read() const
+{
+    std::lock_guard lock(mutex);
+    auto current = totals();
+    MetricsSnapshot snapshot;
+    snapshot.enumerationTime = enumerationTime;
+
+    std::map<int, CallMetrics> cards;
+    for (std::size_t id = 0; id < current.size(); ++id)
+    {
+        subtract(current[id], baseline[id]);
+        const auto &element = elements[id];
+        cards[element.card].merge(current[id]);
+        if (!element.name.empty())
+            snapshot.elements.push_back(ElementMetrics{element.card, element.name, element.capture, current[id]});
+    }
+    for (auto &[card, calls] : cards)
+        snapshot.cards.push_back(CardMetrics{card, calls});
+    return snapshot;
+}
+
+void Metrics::reset()
+{
+    std::lock_guard lock(mutex);
+    baseline = totals();
+}
+
+/// @brief Get the library wide instance.
+/// @return Reference to the Metrics instance.
+Metrics &Metrics::instance()
+{
+    static Metrics metrics;
+    return metrics;
+}
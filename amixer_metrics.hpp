@@ -0,0 +1,171 @@
+/*
+
+Copyright (c) 2025 Pawel Sklarow https://github.com/psklarow
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+of the Software, and to permit persons to whom the Software is furnished to do
+so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+ */
+
+ // Note: this code has been developed with AI assistance.
+
+/// @file amixer_metrics.hpp
+/// @brief Counters and latency histograms of ALSA calls, per card and per mixer element.
+
+#ifndef __AMIXER_METRICS_HPP__
+#define __AMIXER_METRICS_HPP__
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/// @brief Log-linear histogram of call latencies.
+/// Latencies are kept in microseconds: values below 4 us have their own buckets, above that every
+/// power of two is split into 4 linear buckets, so the relative error is at most 25% up to ~16 s.
+struct LatencyHistogram {
+    static constexpr std::size_t bucketCount = 96;
+
+    std::array<std::uint64_t, bucketCount> buckets{};
+    std::uint64_t count{0};
+    std::uint64_t sumUs{0};
+
+    /// @brief Get bucket of a latency in microseconds.
+    static std::size_t bucketOf(std::uint64_t us);
+
+    /// @brief Get upper bound of a bucket in microseconds (exclusive).
+    static std::uint64_t upperBound(std::size_t bucket);
+
+    /// @brief Get latency below which the given fraction of calls completed.
+    /// @param q Quantile, 0..1 (e.g. 0.99)
+    /// @return Upper bound of the bucket containing the quantile.
+    std::chrono::microseconds quantile(double q) const;
+
+    std::chrono::microseconds mean() const {
+        return std::chrono::microseconds(count ? sumUs / count : 0);
+    }
+
+    void merge(const LatencyHistogram &other);
+};
+
+/// @brief Counters of ALSA calls.
+struct CallMetrics {
+    std::uint64_t reads{0};
+    std::uint64_t writes{0};
+    std::uint64_t elidedWrites{0}; // writes skipped because hardware already had the value
+    std::uint64_t errors{0};
+    LatencyHistogram latency;      // of reads and writes, per attempt
+
+    void merge(const CallMetrics &other);
+};
+
+/// @brief Metrics of one mixer element (volume channel).
+struct ElementMetrics {
+    int card;
+    std::string name;
+    bool capture;
+    CallMetrics calls;
+};
+
+/// @brief Metrics of one card: its elements and the calls of the mixer itself (events).
+struct CardMetrics {
+    int card;
+    CallMetrics calls;
+};
+
+/// @brief Metrics collected since start or the last reset.
+struct MetricsSnapshot {
+    std::vector<CardMetrics> cards;
+    std::vector<ElementMetrics> elements;
+    std::chrono::nanoseconds enumerationTime{}; // time AMixer took to enumerate cards and elements
+};
+
+/// @brief Collector of ALSA call metrics.
+/// Every thread records into its own shard with relaxed loads and stores (no read-modify-write), so
+/// recording costs no contention; read() sums all shards. When a thread exits, its shards are merged
+/// into the retired totals of their instances and freed. reset() does not touch the shards, it stores
+/// the current totals as a baseline which read() subtracts.
+class Metrics {
+public:
+    using Id = std::uint32_t;
+    enum Kind { Read, Write };
+
+    static constexpr std::size_t maxElements = 1024;
+    static constexpr Id invalidId = ~Id(0);
+
+    Metrics();
+    ~Metrics();
+
+    Metrics(const Metrics &) = delete;
+    Metrics &operator=(const Metrics &) = delete;
+
+    /// @brief Register a mixer element.
+    /// @param card ALSA card number
+    /// @param name Element name, empty for calls of the card mixer itself
+    /// @param capture Element direction
+    /// @return Id for record(), or invalidId if there are too many elements.
+    Id registerElement(int card, std::string name, bool capture);
+
+    /// @brief Change card number of an element (card reappeared under another number).
+    void setCard(Id id, int card);
+
+    /// @brief Record one ALSA call.
+    void record(Id id, Kind kind, std::chrono::nanoseconds latency, bool ok);
+
+    /// @brief Record a write skipped because hardware already had the value.
+    void recordElided(Id id);
+
+    void setEnumerationTime(std::chrono::nanoseconds time);
+
+    /// @brief Get metrics collected since start or the last reset.
+    MetricsSnapshot read() const;
+
+    /// @brief Start collecting from zero.
+    void reset();
+
+    /// @brief Get the library wide instance.
+    static Metrics &instance();
+
+private:
+    struct Counters;
+    struct Shard;
+    struct ThreadShards;
+    struct Element {
+        int card;
+        std::string name;
+        bool capture;
+    };
+
+    Shard &shard();
+    Counters &counters(Id id);
+    std::vector<CallMetrics> totals() const;
+    void retire(Shard *shard);
+
+    mutable std::mutex mutex;
+    std::vector<Element> elements;
+    std::uint64_t key;                // identifies the instance in thread caches, never reused
+    std::vector<std::unique_ptr<Shard>> shards;
+    std::vector<CallMetrics> retired; // totals of shards of exited threads
+    std::vector<CallMetrics> baseline;
+    std::chrono::nanoseconds enumerationTime{};
+};
+
+#endif // __AMIXER_METRICS_HPP__
@@ -0,0 +1,372 @@
+/*
+
+Copyright (c) 2025 Pawel Sklarow https://github.com/psklarow
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+of the Software, and to permit persons to whom the Software is furnished to do
+so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+ */
+
+/// @file amixer_persist.cpp
+/// @brief Saving and restoring mixer state implementation.
+///
+/// File format (little endian):
+///     u32 magic "AMXS", u16 version, u16 channel count,
+///     per channel: u8 name length, name, i8 card, u8 flags (1 capture, 2 muted),
+///                  u8 level count, u8 level of every channel of the element (0..100),
+///                  u8 card id length, card id, u8 card long name length, card long name (version 2)
+/// Levels are stored per channel of the element, so volume and balance are restored exactly.
+/// Channels are matched by card identity (id and long name, which includes the USB path), as card
+/// numbers change with the order cards are detected in; version 1 files are matched by card number.
+///
+/// Note: this code has been developed with AI assistance.
+
+#include "amixer_persist.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <future>
+#include <map>
+#include <mutex>
+#include <vector>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+static constexpr std::uint32_t stateMagic = 0x53584d41; // "AMXS"
+static constexpr std::uint16_t stateVersion = 2;
+
+static constexpr std::uint8_t flagCapture = 1;
+static constexpr std::uint8_t flagMuted = 2;
+
+/// @brief Saved state of one channel.
+struct SavedChannel {
+    std::string name;
+    int card;
+    bool capture;
+    bool muted;
+    std::vector<int> levels;
+    CardIdentity identity; // empty in version 1 files
+};
+
+/// @brief State shared by the persistence, its change listener and its scheduled flush.
+struct StatePersistence::State {
+    IMixer &mixer;
+    std::string path;
+    Duration flushDelay;
+
+    std::mutex mutex;
+    bool dirty{true}; // the file is written at least once, unless restore() finds the same state
+    bool flushScheduled{false};
+    std::vector<std::uint8_t> written; // content of the state file, to skip writes which change nothing
+
+    State(IMixer &mixer, std::string path, Duration flushDelay)
+        : mixer(mixer), path(std::move(path)), flushDelay(flushDelay) {}
+
+    std::vector<std::uint8_t> encode() const;
+    bool write(const std::vector<std::uint8_t> &content) const;
+    bool flush(bool force = false);
+};
+
+template <class T>
+static void put(std::vector<std::uint8_t> &out, T value)
+{
+    for (std::size_t i = 0; i < sizeof(T); ++i)
+        out.push_back(static_cast<std::uint8_t>(static_cast<std::uint64_t>(value) >> (8 * i)));
+}
+
+/// @brief Append string of up to 255 bytes with its length.
+static void putString(std::vector<std::uint8_t> &out, std::string text)
+{
+    text.resize(std::min<std::size_t>(text.size(), 255));
+    out.push_back(static_cast<std::uint8_t>(text.size()));
+    out.insert(out.end(), text.begin(), text.end());
+}
+
+template <class T>
+static bool get(const std::vector<std::uint8_t> &in, std::size_t &pos, T &value)
+{
+    if (in.size() - pos < sizeof(T))
+        return false;
+    std::uint64_t raw = 0;
+    for (std::size_t i = 0; i < sizeof(T); ++i)
+        raw |= static_cast<std::uint64_t>(in[pos++]) << (8 * i);
+    value = static_cast<T>(raw);
+    return true;
+}
+
+/// @brief Encode current state of all channels.
+/// Mute state comes from the mixer snapshot, channel levels from the volumes (held levels while muted).
+std::vector<std::uint8_t> StatePersistence::State::encode() const
+{
+    auto snapshot = mixer.getSnapshot();
+    std::vector<std::uint8_t> out;
+    put(out, stateMagic);
+    put(out, stateVersion);
+    put(out, static_cast<std::uint16_t>(snapshot.channels.size()));
+    for (const auto &channel : snapshot.channels)
+    {
+        int card = channel.volume->getCard();
+        putString(out, channel.volume->getName());
+        put(out, static_cast<std::int8_t>(card));
+        put(out, static_cast<std::uint8_t>((channel.volume->isCapture() ? flagCapture : 0) | (channel.muted ? flagMuted : 0)));
+        std::vector<int> levels(std::min<std::size_t>(channel.volume->channelCount(), 255));
+        channel.volume->getChannelVolumes(levels);
+        put(out, static_cast<std::uint8_t>(levels.size()));
+        for (int level : levels)
+            put(out, static_cast<std::uint8_t>(level));
+        auto identity = mixer.cardIdentity(card);
+        putString(out, identity.id);
+        putString(out, identity.longName);
+    }
+    return out;
+}
+
+static bool getString(const std::vector<std::uint8_t> &in, std::size_t &pos, std::string &text)
+{
+    std::uint8_t length;
+    if (!get(in, pos, length) || in.size() - pos < length)
+        return false;
+    text.assign(in.begin() + pos, in.begin() + pos + length);
+    pos += length;
+    return true;
+}
+
+/// @brief Decode state file content.
+/// @return false if the content is not a valid state file.
+static bool decode(const std::vector<std::uint8_t> &in, std::vector<SavedChannel> &channels)
+{
+    std::size_t pos = 0;
+    std::uint32_t magic;
+    std::uint16_t version, count;
+    if (!get(in, pos, magic) || !get(in, pos, version) || !get(in, pos, count) ||
+        magic != stateMagic || version < 1 || version > stateVersion)
+        return false;
+
+    for (std::uint16_t i = 0; i < count; ++i)
+    {
+        std::uint8_t flags, levels;
+        std::int8_t card;
+        SavedChannel channel;
+        if (!getString(in, pos, channel.name) || !get(in, pos, card) || !get(in, pos, flags) || !get(in, pos, levels) || in.size() - pos < levels)
+            return false;
+        channel.card = card;
+        channel.capture = flags & flagCapture;
+        channel.muted = flags & flagMuted;
+        for (std::uint8_t level = 0; level < levels; ++level)
+            channel.levels.push_back(std::min<int>(in[pos++], 100));
+        if (version >= 2 && (!getString(in, pos, channel.identity.id) || !getString(in, pos, channel.identity.longName)))
+            return false;
+        channels.push_back(std::move(channel));
+    }
+    return true;
+}
+
+/// @brief Read whole file.
+static bool readFile(const std::string &path, std::vector<std::uint8_t> &content)
+{
+    int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+        return false;
+    std::uint8_t buffer[4096];
+    for (;;)
+    {
+        auto n = read(fd, buffer, sizeof(buffer));
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+        {
+            close(fd);
+            return n == 0;
+        }
+        content.insert(content.end(), buffer, buffer + n);
+    }
+}
+
+/// @brief Replace the state file atomically.
+bool StatePersistence::State::write(const std::vector<std::uint8_t> &content) const
+{
+    auto temporary = path + ".tmp";
+    int fd = open(temporary.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0)
+        return false;
+    std::size_t done = 0;
+    while (done < content.size())
+    {
+        auto n = ::write(fd, content.data() + done, content.size() - done);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n < 0)
+        {
+            int err = errno;
+            close(fd);
+            unlink(temporary.c_str());
+            errno = err;
+            return false;
+        }
+        done += static_cast<std::size_t>(n);
+    }
+    if (fsync(fd) != 0 || close(fd) != 0)
+    {
+        int err = errno;
+        unlink(temporary.c_str());
+        errno = err;
+        return false;
+    }
+    if (rename(temporary.c_str(), path.c_str()) != 0)
+        return false;
+
+    // the rename is durable only once the directory entry is synced
+    auto slash = path.rfind('/');
+    auto directory = slash == std::string::npos ? std::string(".") : slash == 0 ? std::string("/") : path.substr(0, slash);
+    int dir = open(directory.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (dir < 0)
+        return false;
+    bool synced = fsync(dir) == 0;
+    int err = errno;
+    close(dir);
+    errno = err;
+    return synced;
+}
+
+/// @brief Write the state if it is dirty and differs from the file.
+/// @param force Encode the state even if no change has been reported yet: listeners are called
+///              asynchronously, so a change made just before an explicit flush may still be on its way.
+bool StatePersistence::State::flush(bool force)
+{
+    std::lock_guard lock(mutex);
+    flushScheduled = false;
+    if (!dirty && !force)
+        return true;
+    dirty = false;
+    auto content = encode();
+    if (content == written)
+        return true;
+    if (!write(content))
+    {
+        dirty = true; // retry with the next change or flush
+        return false;
+    }
+    written = std::move(content);
+    return true;
+}
+
+StatePersistence::StatePersistence(IMixer &mixer, std::string path, Duration flushDelay)
+    : state(std::make_shared<State>(mixer, std::move(path), flushDelay))
+{
+    std::weak_ptr<State> weak = state;
+    listener = mixer.addChangeListener([weak](const ChannelSnapshot &) {
+        auto state = weak.lock();
+        if (!state)
+            return;
+        std::lock_guard lock(state->mutex);
+        state->dirty = true;
+        if (state->flushScheduled)
+            return;
+        state->flushScheduled = true;
+        Scheduler::instance().scheduleAfter(state->flushDelay, [weak] {
+            if (auto state = weak.lock())
+                state->flush();
+        });
+    });
+}
+
+StatePersistence::~StatePersistence()
+{
+    state->mixer.removeChangeListener(listener);
+    state->flush(true);
+}
+
+int StatePersistence::restore()
+{
+    std::vector<std::uint8_t> content;
+    std::vector<SavedChannel> saved;
+    if (!readFile(state->path, content) || !decode(content, saved))
+        return -1;
+    {
+        std::lock_guard lock(state->mutex);
+        state->written = std::move(content);
+    }
+
+    // match saved channels to the mixer channels and group them per card; exact identities are matched
+    // first, so a card of the same id on another USB path (e.g. another port) does not take their state
+    struct Candidate {
+        std::shared_ptr<IVolume> volume;
+        CardIdentity identity;
+        bool matched{false};
+    };
+    std::vector<Candidate> candidates;
+    for (const auto *list : {&state->mixer.channels(), &state->mixer.captureChannels()})
+    {
+        for (const auto &volume : *list)
+            candidates.push_back(Candidate{volume, state->mixer.cardIdentity(volume->getCard())});
+    }
+
+    using SameCard = bool (*)(const SavedChannel &, const Candidate &);
+    const SameCard passes[] = {
+        [](const SavedChannel &c, const Candidate &v) { return !c.identity.id.empty() && c.identity == v.identity; },
+        [](const SavedChannel &c, const Candidate &v) { return !c.identity.id.empty() && c.identity.id == v.identity.id; },
+        [](const SavedChannel &c, const Candidate &v) { return c.identity.id.empty() && c.card == v.volume->getCard(); },
+    };
+    std::map<int, std::vector<std::pair<std::shared_ptr<IVolume>, const SavedChannel *>>> cards;
+    std::vector<bool> used(saved.size());
+    int restored = 0;
+    for (auto sameCard : passes)
+    {
+        for (auto &candidate : candidates)
+        {
+            if (candidate.matched)
+                continue;
+            auto name = candidate.volume->getName();
+            bool capture = candidate.volume->isCapture();
+            for (std::size_t i = 0; i < saved.size(); ++i)
+            {
+                if (used[i] || saved[i].capture != capture || saved[i].name != name || !sameCard(saved[i], candidate))
+                    continue;
+                used[i] = candidate.matched = true;
+                cards[candidate.volume->getCard()].emplace_back(candidate.volume, &saved[i]);
+                ++restored;
+                break;
+            }
+        }
+    }
+
+    std::vector<std::future<void>> done;
+    for (auto &[card, channels] : cards)
+    {
+        auto finished = std::make_shared<std::promise<void>>();
+        done.push_back(finished->get_future());
+        Scheduler::forCard(card).post([&channels, finished] {
+            for (const auto &[volume, channel] : channels)
+            {
+                if (channel->levels.size() == volume->channelCount())
+                    volume->setChannelVolumes(channel->levels);
+                volume->setMute(channel->muted);
+            }
+            finished->set_value();
+        });
+    }
+    for (auto &result : done)
+        result.wait();
+    return restored;
+}
+
+bool StatePersistence::flush()
+{
+    return state->flush(true);
+}
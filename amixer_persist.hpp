@@ -0,0 +1,87 @@
+/*
+
+Copyright (c) 2025 Pawel Sklarow https://github.com/psklarow
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+of the Software, and to permit persons to whom the Software is furnished to do
+so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+ */
+
+ // Note: this code has been developed with AI assistance.
+
+/// @file amixer_persist.hpp
+/// @brief Saving and restoring mixer state across restarts.
+
+#ifndef __AMIXER_PERSIST_HPP__
+#define __AMIXER_PERSIST_HPP__
+
+#include "amixer.hpp"
+#include "amixer_scheduler.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+/// @brief Persistence of volume, balance and mute of all channels in a compact binary state file.
+/// Channel levels are read from the volumes only when the file is written, never per change.
+/// Changes are tracked through IMixer change listeners and written behind: the first change marks the
+/// state dirty and schedules a flush after the flush delay, so a burst of knob ticks costs one write.
+/// A flush which would write the same content as the file already has is skipped, and the file is
+/// replaced atomically (written to a temporary file, synced, renamed and the directory synced), so a
+/// power cut leaves either the old or the new state.
+class StatePersistence {
+public:
+    using Duration = std::chrono::milliseconds;
+
+    /// @brief Constructor
+    /// Starts tracking changes of the mixer; call restore() first to apply the saved state.
+    /// @param mixer Mixer to persist
+    /// @param path Path of the state file
+    /// @param flushDelay Delay between the first change and writing the file
+    StatePersistence(IMixer &mixer, std::string path, Duration flushDelay = Duration(10000));
+
+    /// @brief Destructor
+    /// Writes pending changes, as flush() does.
+    ~StatePersistence();
+
+    StatePersistence(const StatePersistence &) = delete;
+    StatePersistence &operator=(const StatePersistence &) = delete;
+
+    /// @brief Apply saved state to the mixer.
+    /// Channels are matched by name and direction on the card of the same identity (IMixer::cardIdentity()):
+    /// the same id and long name, which includes the USB path, or else the same id, so state follows a
+    /// card which got another card number. All cards are restored in parallel on their
+    /// card Scheduler threads, with one pass over the channels of each card and a single control write
+    /// per element when its channels share the same level.
+    /// @return Number of channels restored, or -1 if the file is missing or invalid.
+    int restore();
+
+    /// @brief Write pending changes now.
+    /// The state is read from the volumes even if no change has been reported to the listener yet,
+    /// so changes made just before the call are included; the file is not touched if nothing changed.
+    /// @return false if writing failed (errno is set).
+    bool flush();
+
+private:
+    struct State;
+
+    std::shared_ptr<State> state; // shared with the listener and the scheduled flush
+    std::uint64_t listener;
+};
+
+#endif // __AMIXER_PERSIST_HPP__
@@ -0,0 +1,70 @@
+/*
+
+Copyright (c) 2025 Pawel Sklarow https://github.com/psklarow
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+of the Software, and to permit persons to whom the Software is furnished to do
+so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+ */
+
+ // Note: this code has been developed with AI assistance.
+
+/// @file amixer_probes.hpp
+/// @brief USDT (user-level statically defined tracing) probes of the library.
+/// Probes are compiled in when <sys/sdt.h> is available (systemtap-sdt-dev) and AMIXER_NO_USDT is not
+/// defined. An unused probe is a single nop instruction; arguments are only materialized in registers.
+/// List them with e.g. `bpftrace -l 'usdt:./amixerd:amixer:*'` and attach with
+/// `bpftrace -e 'usdt:./amixerd:amixer:set_volume_entry { printf("%p %d %ld\n", arg0, arg2, arg3); }'`.
+///
+/// Provider "amixer", probes:
+///   set_volume_entry(elem, channel, percent, raw)  raw is 1/100 dB or linear value written
+///   set_volume_return(elem, channel, err)
+///   get_volume_entry(elem, channel)
+///   get_volume_return(elem, channel, raw, err)
+///   enumerate_card_entry(card)
+///   enumerate_element(card, elem, name, capture)   maps element pointers of other probes to names
+///   enumerate_card_return(card, elements)
+///   event_dispatch_entry(card)
+///   event_dispatch_return(card, err)
+///   element_event(elem, mask)
+///   fade_step(card, elem, level)                   mute fade: level in per mille of held volume
+///   fade_step_volume(card, volume, percent)        coroutine and group fades: volume is IVolume *
+
+#ifndef __AMIXER_PROBES_HPP__
+#define __AMIXER_PROBES_HPP__
+
+#if !defined(AMIXER_NO_USDT) && __has_include(<sys/sdt.h>)
+
+#include <sys/sdt.h>
+
+#define AMIXER_PROBES_ENABLED 1
+#define AMIXER_PROBE1(name, a) DTRACE_PROBE1(amixer, name, a)
+#define AMIXER_PROBE2(name, a, b) DTRACE_PROBE2(amixer, name, a, b)
+#define AMIXER_PROBE3(name, a, b, c) DTRACE_PROBE3(amixer, name, a, b, c)
+#define AMIXER_PROBE4(name, a, b, c, d) DTRACE_PROBE4(amixer, name, a, b, c, d)
+
+#else
+
+#define AMIXER_PROBES_ENABLED 0
+#define AMIXER_PROBE1(name, a) ((void)(a))
+#define AMIXER_PROBE2(name, a, b) ((void)(a), (void)(b))
+#define AMIXER_PROBE3(name, a, b, c) ((void)(a), (void)(b), (void)(c))
+#define AMIXER_PROBE4(name, a, b, c, d) ((void)(a), (void)(b), (void)(c), (void)(d))
+
+#endif
+
+#endif // __AMIXER_PROBES_HPP__
@@ -0,0 +1,218 @@
+/*
+
+Copyright (c) 2025 Pawel Sklarow https://github.com/psklarow
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+of the Software, and to permit persons to whom the Software is furnished to do
+so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+ */
+
+/// @file amixer_profile.cpp
+/// @brief Capture hardware profiles of mixer elements for FakeMixer.
+/// Usage: amixer_profile [profile-file]
+/// Writes one line per playback and capture volume of every card: card identity, raw and dB ranges, the dB value of
+/// every raw step (TLV), channel map, switch, and the median latency of reads and writes of the control.
+/// The simple mixer API caches values and skips writes of unchanged values, so the control element is
+/// accessed directly: reads go to the driver, writes alternate between the current value and the
+/// neighbouring raw step, and the original value is written back afterwards. Load the file with loadProfile().
+///
+/// Note: this code has been developed with AI assistance.
+///
+/// To build use e.g.:
+///     c++ -std=c++23 amixer_profile.cpp amixer_fake.cpp amixer_balance.cpp amixer_scheduler.cpp amixer_trace.cpp -o amixer_profile -lasound -Wall -Wextra -Wpedantic -Werror
+
+#include "amixer_fake.hpp"
+#include <alsa/asoundlib.h>
+#include <algorithm>
+#include <chrono>
+#include <print>
+#include <cstring>
+#include <cerrno>
+#include <span>
+#include <string>
+#include <vector>
+
+static constexpr int samples = 15;           // accesses timed per element
+static constexpr long maxSteps = 4096;       // larger raw ranges are stored without step table
+
+/// @brief Median duration of an ALSA call.
+template <class Op>
+static std::chrono::nanoseconds median(Op &&op)
+{
+    std::vector<std::chrono::nanoseconds> times;
+    for (int i = 0; i < samples; ++i)
+    {
+        auto start = std::chrono::steady_clock::now();
+        op();
+        times.push_back(std::chrono::steady_clock::now() - start);
+    }
+    std::ranges::nth_element(times, times.begin() + samples / 2);
+    return times[samples / 2];
+}
+
+/// @brief Find the control element behind one direction of a simple mixer element.
+/// Simple elements are built from controls named e.g. "Master Playback Volume" or "Capture Volume".
+static snd_hctl_elem_t *volumeControl(snd_hctl_t *hctl, snd_mixer_elem_t *elem, bool capture)
+{
+    std::string name = snd_mixer_selem_get_name(elem);
+    snd_ctl_elem_id_t *id;
+    snd_ctl_elem_id_alloca(&id);
+    snd_ctl_elem_id_set_interface(id, SND_CTL_ELEM_IFACE_MIXER);
+    snd_ctl_elem_id_set_index(id, snd_mixer_selem_get_index(elem));
+    for (const char *suffix : {capture ? " Capture Volume" : " Playback Volume", " Volume"})
+    {
+        snd_ctl_elem_id_set_name(id, (name + suffix).c_str());
+        if (auto *control = snd_hctl_find_elem(hctl, id))
+            return control;
+    }
+    return nullptr;
+}
+
+/// @brief Measure median latency of reads and writes of a control element.
+/// Writes alternate between the current value and the neighbouring raw step, so the driver cannot
+/// skip them; the current value is written back afterwards.
+static void measure(snd_hctl_elem_t *control, FakeChannel &c)
+{
+    snd_ctl_elem_info_t *info;
+    snd_ctl_elem_value_t *value;
+    snd_ctl_elem_info_alloca(&info);
+    snd_ctl_elem_value_alloca(&value);
+    if (snd_hctl_elem_info(control, info) < 0 || snd_hctl_elem_read(control, value) < 0 || c.rawMax <= c.rawMin)
+        return;
+    unsigned count = snd_ctl_elem_info_get_count(info);
+    std::vector<long> original(count);
+    for (unsigned i = 0; i < count; ++i)
+        original[i] = snd_ctl_elem_value_get_integer(value, i);
+
+    c.readLatency = median([&] { snd_hctl_elem_read(control, value); });
+
+    bool step = false;
+    c.writeLatency = median([&] {
+        step = !step;
+        for (unsigned i = 0; i < count; ++i)
+        {
+            long other = original[i] < c.rawMax ? original[i] + 1 : original[i] - 1;
+            snd_ctl_elem_value_set_integer(value, i, step ? other : original[i]);
+        }
+        snd_hctl_elem_write(control, value);
+    });
+    for (unsigned i = 0; i < count; ++i)
+        snd_ctl_elem_value_set_integer(value, i, original[i]);
+    snd_hctl_elem_write(control, value);
+}
+
+/// @brief Read ALSA id and long name of a card into the profiles of its elements.
+static void identify(const std::string &device, std::span<FakeChannel> channels)
+{
+    snd_ctl_t *ctl = nullptr;
+    if (snd_ctl_open(&ctl, device.c_str(), 0) != 0)
+        return;
+    snd_ctl_card_info_t *info = nullptr;
+    if (snd_ctl_card_info_malloc(&info) == 0 && snd_ctl_card_info(ctl, info) == 0)
+    {
+        for (auto &c : channels)
+        {
+            c.cardId = snd_ctl_card_info_get_id(info);
+            c.cardLongName = snd_ctl_card_info_get_longname(info);
+        }
+    }
+    if (info)
+        snd_ctl_card_info_free(info);
+    snd_ctl_close(ctl);
+}
+
+/// @brief Capture profile of one direction of an element.
+static FakeChannel profile(int card, snd_hctl_t *hctl, snd_mixer_elem_t *elem, bool capture)
+{
+    FakeChannel c;
+    c.card = card;
+    c.name = snd_mixer_selem_get_name(elem);
+    c.capture = capture;
+
+    auto hasChannel = capture ? snd_mixer_selem_has_capture_channel : snd_mixer_selem_has_playback_channel;
+    for (int ch = 0; ch <= SND_MIXER_SCHN_LAST; ++ch)
+    {
+        if (hasChannel(elem, static_cast<snd_mixer_selem_channel_id_t>(ch)))
+            c.positions.push_back(ch);
+    }
+    c.channels = c.positions.size();
+    c.hasSwitch = capture ? snd_mixer_selem_has_capture_switch(elem) : snd_mixer_selem_has_playback_switch(elem);
+
+    (capture ? snd_mixer_selem_get_capture_volume_range : snd_mixer_selem_get_playback_volume_range)(elem, &c.rawMin, &c.rawMax);
+    if ((capture ? snd_mixer_selem_get_capture_dB_range : snd_mixer_selem_get_playback_dB_range)(elem, &c.dbMin, &c.dbMax) != 0)
+        c.dbMin = c.dbMax = 0;
+    if (c.dbMax > c.dbMin && c.rawMax - c.rawMin < maxSteps)
+    {
+        auto ask = capture ? snd_mixer_selem_ask_capture_vol_dB : snd_mixer_selem_ask_playback_vol_dB;
+        for (long raw = c.rawMin; raw <= c.rawMax; ++raw)
+        {
+            long db = 0;
+            if (ask(elem, raw, &db) != 0)
+            {
+                c.dbSteps.clear();
+                break;
+            }
+            c.dbSteps.push_back(db);
+        }
+    }
+
+    if (auto *control = hctl ? volumeControl(hctl, elem, capture) : nullptr)
+        measure(control, c);
+    return c;
+}
+
+int main(int argc, char *argv[])
+{
+    std::vector<FakeChannel> channels;
+    int card = -1;
+    while (snd_card_next(&card) == 0 && card >= 0)
+    {
+        snd_mixer_t *mixer = nullptr;
+        auto device = "hw:" + std::to_string(card);
+        if (snd_mixer_open(&mixer, 0) < 0)
+            continue;
+        if (snd_mixer_attach(mixer, device.c_str()) < 0 || snd_mixer_selem_register(mixer, nullptr, nullptr) < 0 ||
+            snd_mixer_load(mixer) < 0)
+        {
+            snd_mixer_close(mixer);
+            continue;
+        }
+        snd_hctl_t *hctl = nullptr;
+        if (snd_mixer_get_hctl(mixer, device.c_str(), &hctl) < 0)
+            hctl = nullptr;
+        auto first = channels.size();
+        for (snd_mixer_elem_t *elem = snd_mixer_first_elem(mixer); elem; elem = snd_mixer_elem_next(elem))
+        {
+            if (!snd_mixer_selem_is_active(elem))
+                continue;
+            if (snd_mixer_selem_has_playback_volume(elem))
+                channels.push_back(profile(card, hctl, elem, false));
+            if (snd_mixer_selem_has_capture_volume(elem))
+                channels.push_back(profile(card, hctl, elem, true));
+        }
+        identify(device, std::span(channels).subspan(first));
+        snd_mixer_close(mixer);
+    }
+
+    const char *path = argc > 1 ? argv[1] : "/dev/stdout";
+    if (!saveProfile(path, channels)) {
+        std::println(stderr, "amixer_profile: cannot write {}: {}", path, std::strerror(errno));
+        return 1;
+    }
+    std::println(stderr, "amixer_profile: {} elements", channels.size());
+    return 0;
+}
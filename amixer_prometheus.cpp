@@ -0,0 +1,301 @@
+/*
+
+Copyright (c) 2025 Pawel Sklarow https://github.com/psklarow
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+of the Software, and to permit persons to whom the Software is furnished to do
+so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+ */
+
+/// @file amixer_prometheus.cpp
+/// @brief Prometheus exporter implementation.
+///
+/// Note: this code has been developed with AI assistance.
+
+#include "amixer_prometheus.hpp"
+
+#include <cerrno>
+#include <cstring>
+#include <format>
+#include <map>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+/// @brief Escape label value.
+static std::string label(const std::string &value)
+{
+    std::string escaped;
+    escaped.reserve(value.size());
+    for (char c : value)
+    {
+        if (c == '\\' || c == '"')
+            escaped += '\\';
+        if (c == '\n')
+        {
+            escaped += "\\n";
+            continue;
+        }
+        escaped += c;
+    }
+    return escaped;
+}
+
+static double seconds(std::chrono::nanoseconds duration)
+{
+    return std::chrono::duration<double>(duration).count();
+}
+
+/// @brief Render summary of a latency histogram with given labels.
+static void renderLatency(std::string &out, const char *metric, const std::string &labels, const LatencyHistogram &latency)
+{
+    for (double q : {0.5, 0.9, 0.99})
+        out += std::format("{}{{{},quantile=\"{}\"}} {}\n", metric, labels, q, seconds(latency.quantile(q)));
+    out += std::format("{}_sum{{{}}} {}\n", metric, labels, latency.sumUs / 1e6);
+    out += std::format("{}_count{{{}}} {}\n", metric, labels, latency.count);
+}
+
+PrometheusExporter::PrometheusExporter(IMixer &mixer, std::string socketPath, std::string filePath,
+                                       std::chrono::milliseconds fileInterval, Metrics &metrics)
+    : mixer(mixer), metrics(metrics), socketPath(std::move(socketPath)), filePath(std::move(filePath)),
+      fileInterval(fileInterval)
+{
+}
+
+PrometheusExporter::~PrometheusExporter()
+{
+    if (listenFd >= 0)
+    {
+        close(listenFd);
+        unlink(socketPath.c_str());
+    }
+    if (stopFd >= 0)
+        close(stopFd);
+}
+
+bool PrometheusExporter::start()
+{
+    stopFd = eventfd(0, EFD_CLOEXEC);
+    if (stopFd < 0)
+        return false;
+    if (socketPath.empty())
+        return true;
+
+    sockaddr_un address;
+    std::memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (socketPath.size() >= sizeof(address.sun_path))
+    {
+        errno = ENAMETOOLONG;
+        return false;
+    }
+    std::memcpy(address.sun_path, socketPath.c_str(), socketPath.size());
+
+    listenFd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (listenFd < 0)
+        return false;
+    unlink(socketPath.c_str());
+    if (bind(listenFd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) != 0 ||
+        listen(listenFd, 16) != 0)
+    {
+        int err = errno;
+        close(listenFd);
+        listenFd = -1;
+        errno = err;
+        return false;
+    }
+    return true;
+}
+
+void PrometheusExporter::run()
+{
+    auto nextWrite = std::chrono::steady_clock::now();
+    for (;;)
+    {
+        int timeout = -1;
+        if (!filePath.empty())
+        {
+            auto now = std::chrono::steady_clock::now();
+            if (now >= nextWrite)
+            {
+                writeFile();
+                nextWrite = now + fileInterval;
+            }
+            timeout = static_cast<int>(std::chrono::ceil<std::chrono::milliseconds>(nextWrite - now).count());
+        }
+
+        pollfd fds[2] = {{stopFd, POLLIN, 0}, {listenFd, POLLIN, 0}};
+        if (poll(fds, 2, timeout) < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            return;
+        }
+        if (fds[0].revents)
+            return;
+        if (fds[1].revents & POLLIN)
+        {
+            int client = accept4(listenFd, nullptr, nullptr, SOCK_CLOEXEC);
+            if (client < 0)
+                continue;
+            auto text = render();
+            for (std::size_t done = 0; done < text.size(); )
+            {
+                auto n = send(client, text.data() + done, text.size() - done, MSG_NOSIGNAL);
+                if (n < 0 && errno == EINTR)
+                    continue;
+                if (n <= 0)
+                    break;
+                done += static_cast<std::size_t>(n);
+            }
+            close(client);
+        }
+    }
+}
+
+void PrometheusExporter::stop()
+{
+    std::uint64_t one = 1;
+    if (stopFd >= 0)
+        [[maybe_unused]] auto written = write(stopFd, &one, sizeof(one));
+}
+
+/// @brief Render channel state, re-rendering only channels changed since the previous call.
+void PrometheusExporter::renderChannels(std::string &out)
+{
+    auto snapshot = generation == 0 ? mixer.getSnapshot() : mixer.changedSince(generation);
+    if (generation == 0)
+    {
+        channelLines.resize(snapshot.channels.size());
+        for (std::size_t i = 0; i < snapshot.channels.size(); ++i)
+            index[snapshot.channels[i].volume.get()] = i;
+    }
+    generation = snapshot.generation;
+
+    for (const auto &channel : snapshot.channels)
+    {
+        auto it = index.find(channel.volume.get());
+        if (it == index.end())
+            continue;
+        auto labels = std::format("card=\"{}\",name=\"{}\",direction=\"{}\"", channel.volume->getCard(),
+                                  label(channel.volume->getName()), channel.volume->isCapture() ? "capture" : "playback");
+        channelLines[it->second] = std::format("amixer_channel_volume_percent{{{0}}} {1}\n"
+                                               "amixer_channel_balance{{{0}}} {2}\n"
+                                               "amixer_channel_muted{{{0}}} {3}\n",
+                                               labels, channel.volumeLevel, channel.balance, channel.muted ? 1 : 0);
+    }
+
+    out += "# HELP amixer_channel_volume_percent Channel volume, 0..100.\n"
+           "# TYPE amixer_channel_volume_percent gauge\n"
+           "# HELP amixer_channel_balance Channel balance, -100..100.\n"
+           "# TYPE amixer_channel_balance gauge\n"
+           "# HELP amixer_channel_muted Channel mute state.\n"
+           "# TYPE amixer_channel_muted gauge\n";
+    for (const auto &lines : channelLines)
+        out += lines;
+}
+
+/// @brief Render ALSA call metrics and card health.
+void PrometheusExporter::renderCalls(std::string &out)
+{
+    auto snapshot = metrics.read();
+
+    out += "# HELP amixer_alsa_calls_total ALSA calls by kind.\n"
+           "# TYPE amixer_alsa_calls_total counter\n"
+           "# HELP amixer_alsa_elided_writes_total Writes skipped because hardware had the value.\n"
+           "# TYPE amixer_alsa_elided_writes_total counter\n"
+           "# HELP amixer_alsa_errors_total Failed ALSA calls.\n"
+           "# TYPE amixer_alsa_errors_total counter\n"
+           "# HELP amixer_alsa_latency_seconds Latency of ALSA calls.\n"
+           "# TYPE amixer_alsa_latency_seconds summary\n";
+    for (const auto &element : snapshot.elements)
+    {
+        auto labels = std::format("card=\"{}\",name=\"{}\",direction=\"{}\"", element.card, label(element.name),
+                                  element.capture ? "capture" : "playback");
+        out += std::format("amixer_alsa_calls_total{{{0},kind=\"read\"}} {1}\n"
+                           "amixer_alsa_calls_total{{{0},kind=\"write\"}} {2}\n"
+                           "amixer_alsa_elided_writes_total{{{0}}} {3}\n"
+                           "amixer_alsa_errors_total{{{0}}} {4}\n",
+                           labels, element.calls.reads, element.calls.writes, element.calls.elidedWrites, element.calls.errors);
+        renderLatency(out, "amixer_alsa_latency_seconds", labels, element.calls.latency);
+    }
+
+    out += "# HELP amixer_card_latency_seconds Latency of ALSA calls of all elements of the card.\n"
+           "# TYPE amixer_card_latency_seconds summary\n"
+           "# HELP amixer_card_health Card health: 0 healthy, 1 degraded, 2 gone.\n"
+           "# TYPE amixer_card_health gauge\n";
+    for (const auto &card : snapshot.cards)
+    {
+        auto labels = std::format("card=\"{}\"", card.card);
+        renderLatency(out, "amixer_card_latency_seconds", labels, card.calls.latency);
+        out += std::format("amixer_card_health{{{}}} {}\n", labels, static_cast<int>(mixer.cardHealth(card.card)));
+    }
+
+    auto reapply = mixer.reapplyStats();
+    out += std::format("# HELP amixer_enumeration_seconds Time of enumerating cards and elements.\n"
+                       "# TYPE amixer_enumeration_seconds gauge\n"
+                       "amixer_enumeration_seconds {}\n"
+                       "# HELP amixer_reapply_total State re-applied to reappeared cards.\n"
+                       "# TYPE amixer_reapply_total counter\n"
+                       "amixer_reapply_total {}\n"
+                       "# HELP amixer_reapply_seconds Latency of re-applying state to a reappeared card.\n"
+                       "# TYPE amixer_reapply_seconds gauge\n"
+                       "amixer_reapply_seconds{{stat=\"last\"}} {}\n"
+                       "amixer_reapply_seconds{{stat=\"max\"}} {}\n",
+                       seconds(snapshot.enumerationTime), reapply.count, seconds(reapply.last), seconds(reapply.max));
+}
+
+std::string PrometheusExporter::render()
+{
+    std::lock_guard lock(renderMutex);
+    std::string out;
+    out.reserve(channelLines.size() * 160 + 4096);
+    renderChannels(out);
+    renderCalls(out);
+    return out;
+}
+
+bool PrometheusExporter::writeFile()
+{
+    auto text = render();
+    auto temporary = filePath + ".tmp";
+    int fd = open(temporary.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0)
+        return false;
+    for (std::size_t done = 0; done < text.size(); )
+    {
+        auto n = write(fd, text.data() + done, text.size() - done);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n < 0)
+        {
+            int err = errno;
+            close(fd);
+            unlink(temporary.c_str());
+            errno = err;
+            return false;
+        }
+        done += static_cast<std::size_t>(n);
+    }
+    if (close(fd) != 0)
+        return false;
+    return rename(temporary.c_str(), filePath.c_str()) == 0;
+}
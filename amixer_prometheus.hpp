@@ -0,0 +1,100 @@
+/*
+
+Copyright (c) 2025 Pawel Sklarow https://github.com/psklarow
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+of the Software, and to permit persons to whom the Software is furnished to do
+so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+ */
+
+ // Note: this code has been developed with AI assistance.
+
+/// @file amixer_prometheus.hpp
+/// @brief Mixer metrics in Prometheus text exposition format.
+
+#ifndef __AMIXER_PROMETHEUS_HPP__
+#define __AMIXER_PROMETHEUS_HPP__
+
+#include "amixer.hpp"
+#include "amixer_metrics.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/// @brief Exporter of mixer state and call metrics in Prometheus text format.
+/// The text is served on a Unix stream socket (one scrape per connection) and/or written to a file
+/// for the node_exporter textfile collector, replaced atomically by rename.
+///
+/// Rendering never blocks the control path: channel state comes from the mixer snapshot (sequence
+/// lock) and metrics from the per-thread shards. Channel lines are kept rendered and re-rendered only
+/// for channels changed since the previous scrape (IMixer::changedSince()), so a scrape of hundreds
+/// of idle channels costs a string copy.
+class PrometheusExporter {
+public:
+    /// @brief Constructor
+    /// @param mixer Mixer to export
+    /// @param socketPath Path of the Unix socket to serve, empty for none
+    /// @param filePath Path of the file to write (e.g. /var/lib/node_exporter/amixer.prom), empty for none
+    /// @param fileInterval Interval of writing the file
+    PrometheusExporter(IMixer &mixer, std::string socketPath, std::string filePath = {},
+                       std::chrono::milliseconds fileInterval = std::chrono::seconds(15),
+                       Metrics &metrics = Metrics::instance());
+    ~PrometheusExporter();
+
+    PrometheusExporter(const PrometheusExporter &) = delete;
+    PrometheusExporter &operator=(const PrometheusExporter &) = delete;
+
+    /// @brief Create the socket.
+    /// @return true on success, false on failure (errno is set).
+    bool start();
+
+    /// @brief Serve scrapes and write the file until stop() is called.
+    void run();
+
+    /// @brief Make run() return. May be called from any thread or a signal handler.
+    void stop();
+
+    /// @brief Render all metrics.
+    std::string render();
+
+    /// @brief Write all metrics to the file, replacing it atomically.
+    /// @return false on failure (errno is set).
+    bool writeFile();
+
+private:
+    void renderChannels(std::string &out);
+    void renderCalls(std::string &out);
+
+    IMixer &mixer;
+    Metrics &metrics;
+    std::string socketPath;
+    std::string filePath;
+    std::chrono::milliseconds fileInterval;
+
+    std::mutex renderMutex;                                 // scrapes from socket and file share the cache
+    std::uint64_t generation{0};                            // mixer generation of the cached channel lines
+    std::vector<std::string> channelLines;                  // per channel, in snapshot order
+    std::unordered_map<const IVolume *, std::size_t> index; // channel position in channelLines
+    int listenFd{-1};
+    int stopFd{-1};
+};
+
+#endif // __AMIXER_PROMETHEUS_HPP__
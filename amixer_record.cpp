@@ -0,0 +1,432 @@
+/*
+
+Copyright (c) 2025 Pawel Sklarow https://github.com/psklarow
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+of the Software, and to permit persons to whom the Software is furnished to do
+so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+ */
+
+/// @file amixer_record.cpp
+/// @brief Recording and replay of mixer API calls.
+///
+/// Note: this code has been developed with AI assistance.
+
+#include "amixer_record.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstring>
+#include <thread>
+
+/// @brief Volume decorator logging every call.
+class RecordingVolume : public IVolume {
+public:
+    RecordingVolume(const RecordingMixer &recorder, std::shared_ptr<IVolume> volume, std::uint16_t index)
+        : recorder(recorder), volume(std::move(volume)), index(index) {}
+
+    void setVolume(int v) override {
+        recorder.log(index, CallLog::SetVolume, v);
+        volume->setVolume(v);
+    }
+    void setBalance(int balance) override {
+        recorder.log(index, CallLog::SetBalance, balance);
+        volume->setBalance(balance);
+    }
+    const std::string getName() override { return volume->getName(); }
+    int getCard() override { return volume->getCard(); }
+    int getVolume() override {
+        int v = volume->getVolume();
+        recorder.log(index, CallLog::GetVolume, v);
+        return v;
+    }
+    int getBalance() override {
+        int balance = volume->getBalance();
+        recorder.log(index, CallLog::GetBalance, balance);
+        return balance;
+    }
+    std::size_t channelCount() override { return volume->channelCount(); }
+    const std::string getChannelName(std::size_t i) override { return volume->getChannelName(i); }
+    int getChannelPosition(std::size_t i) override { return volume->getChannelPosition(i); }
+    void getChannelVolumes(std::span<int> volumes) override {
+        recorder.log(index, CallLog::GetChannelVolumes, static_cast<std::int32_t>(volumes.size()));
+        volume->getChannelVolumes(volumes);
+    }
+    void setChannelVolumes(std::span<const int> volumes) override {
+        std::array<std::int32_t, CallLog::maxExtra> extra{};
+        auto count = std::min(volumes.size(), extra.size());
+        std::copy_n(volumes.begin(), count, extra.begin());
+        recorder.log(index, CallLog::SetChannelVolumes, 0, std::span(extra).first(count));
+        volume->setChannelVolumes(volumes);
+    }
+    bool isCapture() override { return volume->isCapture(); }
+    bool hasSwitch() override { return volume->hasSwitch(); }
+    void setSwitch(bool on) override {
+        recorder.log(index, CallLog::SetSwitch, on);
+        volume->setSwitch(on);
+    }
+    bool getSwitch() override {
+        bool on = volume->getSwitch();
+        recorder.log(index, CallLog::GetSwitch, on);
+        return on;
+    }
+    void setMute(bool mute, int fadeMs) override {
+        std::int32_t fade = fadeMs;
+        recorder.log(index, CallLog::SetMute, mute, std::span(&fade, 1));
+        volume->setMute(mute, fadeMs);
+    }
+    bool isMuted() override {
+        bool muted = volume->isMuted();
+        recorder.log(index, CallLog::IsMuted, muted);
+        return muted;
+    }
+    int volumeForGain(int v, double gainDb) override {
+        std::int32_t gain = static_cast<std::int32_t>(lround(gainDb * 100.0));
+        recorder.log(index, CallLog::VolumeForGain, v, std::span(&gain, 1));
+        return volume->volumeForGain(v, gainDb);
+    }
+    std::expected<void, std::error_code> trySetVolume(int v) override {
+        recorder.log(index, CallLog::TrySetVolume, v);
+        return volume->trySetVolume(v);
+    }
+    std::expected<int, std::error_code> tryGetVolume() override {
+        auto result = volume->tryGetVolume();
+        recorder.log(index, CallLog::TryGetVolume, result ? *result : -result.error().value());
+        return result;
+    }
+
+    const std::shared_ptr<IVolume> &wrapped() const { return volume; }
+    std::uint16_t channel() const { return index; }
+
+private:
+    const RecordingMixer &recorder;
+    std::shared_ptr<IVolume> volume;
+    std::uint16_t index;
+};
+
+RecordingMixer::RecordingMixer(IMixer &mixer, const std::string &path)
+    : mixer(mixer), start(std::chrono::steady_clock::now())
+{
+    std::vector<std::shared_ptr<IVolume>> all;
+    for (const auto *list : {&mixer.channels(), &mixer.captureChannels()})
+        all.insert(all.end(), list->begin(), list->end());
+    for (std::size_t i = 0; i < all.size(); ++i)
+    {
+        auto wrapper = std::make_shared<RecordingVolume>(*this, all[i], static_cast<std::uint16_t>(i));
+        wrappers.emplace(all[i].get(), wrapper);
+        (all[i]->isCapture() ? capture : playback).push_back(wrapper);
+    }
+
+    file = std::fopen(path.c_str(), "wb");
+    if (!file)
+        return;
+    std::setvbuf(file, nullptr, _IOFBF, 1 << 16);
+    std::uint32_t header[3] = {CallLog::magicValue, CallLog::versionValue, static_cast<std::uint32_t>(all.size())};
+    std::fwrite(header, sizeof(header), 1, file);
+    for (const auto &volume : all)
+    {
+        std::int32_t card = volume->getCard();
+        std::uint8_t flags[2] = {volume->isCapture() ? std::uint8_t(1) : std::uint8_t(0),
+                                 static_cast<std::uint8_t>(volume->channelCount())};
+        auto name = volume->getName();
+        auto length = static_cast<std::uint16_t>(name.size());
+        std::fwrite(&card, sizeof(card), 1, file);
+        std::fwrite(flags, sizeof(flags), 1, file);
+        std::fwrite(&length, sizeof(length), 1, file);
+        std::fwrite(name.data(), 1, length, file);
+    }
+}
+
+RecordingMixer::~RecordingMixer()
+{
+    if (file)
+        std::fclose(file);
+}
+
+void RecordingMixer::flush()
+{
+    std::lock_guard lock(mutex);
+    if (file)
+        std::fflush(file);
+}
+
+void RecordingMixer::log(std::uint16_t channel, CallLog::Op op, std::int32_t value, std::span<const std::int32_t> extra) const
+{
+    if (!file)
+        return;
+    auto time = static_cast<std::uint64_t>(
+        std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count());
+    auto count = std::min(extra.size(), CallLog::maxExtra);
+
+    unsigned char record[16 + CallLog::maxExtra * sizeof(std::int32_t)];
+    std::memcpy(record, &time, 8);
+    std::memcpy(record + 8, &channel, 2);
+    record[10] = op;
+    record[11] = static_cast<unsigned char>(count);
+    std::memcpy(record + 12, &value, 4);
+    std::memcpy(record + 16, extra.data(), count * sizeof(std::int32_t));
+
+    std::lock_guard lock(mutex);
+    std::fwrite(record, 16 + count * sizeof(std::int32_t), 1, file);
+}
+
+void RecordingMixer::wrap(MixerSnapshot &snapshot) const
+{
+    for (auto &channel : snapshot.channels)
+    {
+        if (auto it = wrappers.find(channel.volume.get()); it != wrappers.end())
+            channel.volume = it->second;
+    }
+}
+
+MixerSnapshot RecordingMixer::getSnapshot() const
+{
+    log(CallLog::mixerChannel, CallLog::GetSnapshot, 0);
+    auto snapshot = mixer.getSnapshot();
+    wrap(snapshot);
+    return snapshot;
+}
+
+MixerSnapshot RecordingMixer::changedSince(std::uint64_t generation) const
+{
+    log(CallLog::mixerChannel, CallLog::ChangedSince, generation != 0);
+    auto snapshot = mixer.changedSince(generation);
+    wrap(snapshot);
+    return snapshot;
+}
+
+std::uint64_t RecordingMixer::addChangeListener(ChangeListener listener)
+{
+    auto id = mixer.addChangeListener([this, listener = std::move(listener)](const ChannelSnapshot &channel) {
+        auto wrapped = channel;
+        if (auto it = wrappers.find(channel.volume.get()); it != wrappers.end())
+            wrapped.volume = it->second;
+        listener(wrapped);
+    });
+    log(CallLog::mixerChannel, CallLog::AddChangeListener, static_cast<std::int32_t>(id));
+    return id;
+}
+
+void RecordingMixer::removeChangeListener(std::uint64_t id)
+{
+    log(CallLog::mixerChannel, CallLog::RemoveChangeListener, static_cast<std::int32_t>(id));
+    mixer.removeChangeListener(id);
+}
+
+const RecordingVolume *RecordingMixer::find(const std::shared_ptr<IVolume> &volume) const
+{
+    if (auto it = wrappers.find(volume.get()); it != wrappers.end())
+        return static_cast<const RecordingVolume *>(it->second.get());
+    for (const auto &[inner, wrapper] : wrappers)
+    {
+        if (wrapper == volume)
+            return static_cast<const RecordingVolume *>(wrapper.get());
+    }
+    return nullptr;
+}
+
+bool RecordingMixer::link(const std::shared_ptr<IVolume> &master, const std::shared_ptr<IVolume> &slave, double offsetDb)
+{
+    const auto *m = find(master);
+    const auto *s = find(slave);
+    if (!m || !s)
+    {
+        errno = EINVAL;
+        return false;
+    }
+    std::int32_t channels[2] = {m->channel(), s->channel()};
+    log(CallLog::mixerChannel, CallLog::Link, static_cast<std::int32_t>(lround(offsetDb * 100.0)), channels);
+    return mixer.link(m->wrapped(), s->wrapped(), offsetDb);
+}
+
+bool RecordingMixer::unlink(const std::shared_ptr<IVolume> &slave)
+{
+    const auto *s = find(slave);
+    if (!s)
+        return false;
+    std::int32_t channel = s->channel();
+    log(CallLog::mixerChannel, CallLog::Unlink, 0, std::span(&channel, 1));
+    return mixer.unlink(s->wrapped());
+}
+
+bool CallLog::load(const std::string &path)
+{
+    std::FILE *file = std::fopen(path.c_str(), "rb");
+    if (!file)
+        return false;
+    auto fail = [file] {
+        std::fclose(file);
+        errno = EINVAL;
+        return false;
+    };
+
+    std::uint32_t header[3];
+    if (std::fread(header, sizeof(header), 1, file) != 1 || header[0] != magicValue || header[1] != versionValue)
+        return fail();
+    channels.clear();
+    calls.clear();
+    for (std::uint32_t i = 0; i < header[2]; ++i)
+    {
+        std::int32_t card;
+        std::uint8_t flags[2];
+        std::uint16_t length;
+        if (std::fread(&card, sizeof(card), 1, file) != 1 || std::fread(flags, sizeof(flags), 1, file) != 1 ||
+            std::fread(&length, sizeof(length), 1, file) != 1)
+            return fail();
+        std::string name(length, '\0');
+        if (length && std::fread(name.data(), 1, length, file) != length)
+            return fail();
+        channels.push_back(Channel{card, std::move(name), flags[0] != 0, flags[1]});
+    }
+
+    unsigned char record[16];
+    while (std::fread(record, sizeof(record), 1, file) == 1)
+    {
+        Call call{};
+        std::memcpy(&call.time, record, 8);
+        std::memcpy(&call.channel, record + 8, 2);
+        call.op = static_cast<Op>(record[10]);
+        call.count = record[11];
+        std::memcpy(&call.value, record + 12, 4);
+        if (call.count > maxExtra ||
+            (call.count && std::fread(call.extra.data(), sizeof(std::int32_t), call.count, file) != call.count))
+            return fail();
+        calls.push_back(call);
+    }
+    std::fclose(file);
+    return true;
+}
+
+ReplayStats replay(IMixer &mixer, const CallLog &log, double speed)
+{
+    std::vector<std::shared_ptr<IVolume>> volumes(log.channels.size());
+    for (std::size_t i = 0; i < log.channels.size(); ++i)
+    {
+        const auto &channel = log.channels[i];
+        const auto &list = channel.capture ? mixer.captureChannels() : mixer.channels();
+        for (const auto &volume : list)
+        {
+            if (volume->getName() != channel.name)
+                continue;
+            if (volume->getCard() == channel.card)
+            {
+                volumes[i] = volume;
+                break;
+            }
+            if (!volumes[i])
+                volumes[i] = volume;
+        }
+    }
+
+    ReplayStats stats;
+    std::map<std::int32_t, std::uint64_t> listeners; // recorded id -> id in the mixer
+    std::uint64_t generation = 0;
+    std::vector<int> levels(CallLog::maxExtra);
+    auto start = std::chrono::steady_clock::now();
+
+    for (const auto &call : log.calls)
+    {
+        auto due = start;
+        if (speed > 0)
+        {
+            due += std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                std::chrono::duration<double, std::micro>(static_cast<double>(call.time) / speed));
+            std::this_thread::sleep_until(due);
+        }
+
+        bool mixerCall = call.op >= CallLog::GetSnapshot;
+        IVolume *volume = !mixerCall && call.channel < volumes.size() ? volumes[call.channel].get() : nullptr;
+        if (!mixerCall && !volume)
+        {
+            ++stats.skipped;
+            continue;
+        }
+
+        auto callStart = std::chrono::steady_clock::now();
+        if (speed > 0)
+            stats.maxLag = std::max(stats.maxLag, std::chrono::duration_cast<std::chrono::nanoseconds>(callStart - due));
+        switch (call.op)
+        {
+        case CallLog::SetVolume: volume->setVolume(call.value); break;
+        case CallLog::SetBalance: volume->setBalance(call.value); break;
+        case CallLog::GetVolume: volume->getVolume(); break;
+        case CallLog::GetBalance: volume->getBalance(); break;
+        case CallLog::GetChannelVolumes:
+            volume->getChannelVolumes(std::span(levels).first(std::min<std::size_t>(call.value, levels.size())));
+            break;
+        case CallLog::SetChannelVolumes:
+            volume->setChannelVolumes(std::span<const int>(call.extra.data(), call.count));
+            break;
+        case CallLog::SetSwitch: volume->setSwitch(call.value != 0); break;
+        case CallLog::GetSwitch: volume->getSwitch(); break;
+        case CallLog::SetMute: volume->setMute(call.value != 0, call.count ? call.extra[0] : 0); break;
+        case CallLog::IsMuted: volume->isMuted(); break;
+        case CallLog::VolumeForGain: volume->volumeForGain(call.value, call.count ? call.extra[0] / 100.0 : 0.0); break;
+        case CallLog::TrySetVolume: (void)volume->trySetVolume(call.value); break;
+        case CallLog::TryGetVolume: (void)volume->tryGetVolume(); break;
+        case CallLog::GetSnapshot: generation = mixer.getSnapshot().generation; break;
+        case CallLog::ChangedSince: generation = mixer.changedSince(call.value ? generation : 0).generation; break;
+        case CallLog::AddChangeListener:
+            listeners[call.value] = mixer.addChangeListener([](const ChannelSnapshot &) {});
+            break;
+        case CallLog::RemoveChangeListener:
+            if (auto it = listeners.find(call.value); it != listeners.end())
+            {
+                mixer.removeChangeListener(it->second);
+                listeners.erase(it);
+            }
+            break;
+        case CallLog::Link:
+        {
+            auto volumeOf = [&](std::size_t i) {
+                return i < call.count && static_cast<std::size_t>(call.extra[i]) < volumes.size() ? volumes[call.extra[i]] : nullptr;
+            };
+            auto master = volumeOf(0), slave = volumeOf(1);
+            if (!master || !slave)
+            {
+                ++stats.skipped;
+                continue;
+            }
+            mixer.link(master, slave, call.value / 100.0);
+            break;
+        }
+        case CallLog::Unlink:
+            if (call.count < 1 || static_cast<std::size_t>(call.extra[0]) >= volumes.size() || !volumes[call.extra[0]])
+            {
+                ++stats.skipped;
+                continue;
+            }
+            mixer.unlink(volumes[call.extra[0]]);
+            break;
+        default:
+            ++stats.skipped;
+            continue;
+        }
+        auto latency = std::chrono::steady_clock::now() - callStart;
+        auto us = static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(latency).count());
+        ++stats.latency.buckets[LatencyHistogram::bucketOf(us)];
+        ++stats.latency.count;
+        stats.latency.sumUs += us;
+        ++stats.calls;
+    }
+
+    for (const auto &[recorded, id] : listeners)
+        mixer.removeChangeListener(id);
+    stats.elapsed = std::chrono::steady_clock::now() - start;
+    return stats;
+}
@@ -0,0 +1,179 @@
+/*
+
+Copyright (c) 2025 Pawel Sklarow https://github.com/psklarow
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+of the Software, and to permit persons to whom the Software is furnished to do
+so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+ */
+
+ // Note: this code has been developed with AI assistance.
+
+/// @file amixer_record.hpp
+/// @brief Recording of mixer API calls to a binary log, and replay of such logs.
+/// A day of real traffic recorded with RecordingMixer can be replayed against the ALSA mixer or
+/// FakeMixer as a realistic benchmark of coalescing, caching and scheduling changes.
+
+#ifndef __AMIXER_RECORD_HPP__
+#define __AMIXER_RECORD_HPP__
+
+#include "amixer.hpp"
+#include "amixer_metrics.hpp"
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/// @brief Log of mixer API calls.
+/// File layout (host byte order):
+///   header: magic "AMXL", version, channel count (uint32 each)
+///   channel: card (int32), capture (uint8), channels (uint8), name length (uint16), name
+///   call: time in microseconds since start (uint64), channel (uint16), op (uint8),
+///         extra count (uint8), value (int32), extra values (int32 each)
+/// Most calls take 16 bytes. Calls returning constant metadata (names, card, channel count,
+/// direction, switch presence) and health/statistics queries are not logged.
+struct CallLog {
+    static constexpr std::uint32_t magicValue = 0x4c584d41; // "AMXL"
+    static constexpr std::uint32_t versionValue = 1;
+    static constexpr std::uint16_t mixerChannel = 0xffff;   // channel of IMixer calls
+    static constexpr std::size_t maxExtra = 8;
+
+    enum Op : std::uint8_t {
+        SetVolume = 1,         // value: volume
+        SetBalance,            // value: balance
+        GetVolume,             // value: result
+        GetBalance,            // value: result
+        GetChannelVolumes,     // value: span size
+        SetChannelVolumes,     // extra: volumes
+        SetSwitch,             // value: on
+        GetSwitch,             // value: result
+        SetMute,               // value: mute, extra: fade in milliseconds
+        IsMuted,               // value: result
+        VolumeForGain,         // value: volume, extra: gain in 1/100 dB
+        TrySetVolume,          // value: volume
+        TryGetVolume,          // value: result, or -errno
+        GetSnapshot,
+        ChangedSince,          // value: 0 for all channels, 1 since the previous snapshot
+        AddChangeListener,     // value: listener id
+        RemoveChangeListener,  // value: listener id
+        Link,                  // value: offset in 1/100 dB, extra: master channel, slave channel
+        Unlink,                // extra: slave channel
+    };
+
+    struct Channel {
+        int card;
+        std::string name;
+        bool capture;
+        std::size_t channels;
+    };
+
+    struct Call {
+        std::uint64_t time; // microseconds since start of recording
+        std::uint16_t channel;
+        Op op;
+        std::uint8_t count; // number of extra values
+        std::int32_t value;
+        std::array<std::int32_t, maxExtra> extra;
+    };
+
+    std::vector<Channel> channels;
+    std::vector<Call> calls;
+
+    /// @brief Load log from a file.
+    /// @return false if the file cannot be read or is not a call log (errno is set).
+    bool load(const std::string &path);
+};
+
+class RecordingVolume;
+
+/// @brief Mixer decorator logging every call to the wrapped mixer and its volumes.
+/// Volumes in channel lists, snapshots and change notifications are the recording wrappers, so calls
+/// made through them are logged too. Calls are appended to a buffered file under a mutex.
+class RecordingMixer : public IMixer {
+public:
+    /// @brief Constructor
+    /// @param mixer Mixer to record
+    /// @param path Log file, truncated
+    RecordingMixer(IMixer &mixer, const std::string &path);
+    ~RecordingMixer() override;
+
+    RecordingMixer(const RecordingMixer &) = delete;
+    RecordingMixer &operator=(const RecordingMixer &) = delete;
+
+    /// @brief Check whether the log file has been opened.
+    bool isOpen() const { return file != nullptr; }
+
+    /// @brief Write buffered calls to the file.
+    void flush();
+
+    const std::list<std::shared_ptr<IVolume>> &channels() const override { return playback; }
+    const std::list<std::shared_ptr<IVolume>> &captureChannels() const override { return capture; }
+    MixerSnapshot getSnapshot() const override;
+    MixerSnapshot changedSince(std::uint64_t generation) const override;
+    std::uint64_t addChangeListener(ChangeListener listener) override;
+    void removeChangeListener(std::uint64_t id) override;
+    CardHealth cardHealth(int card) const override { return mixer.cardHealth(card); }
+    CardIdentity cardIdentity(int card) const override { return mixer.cardIdentity(card); }
+    ReapplyStats reapplyStats() const override { return mixer.reapplyStats(); }
+    std::uint64_t layoutGeneration() const override { return mixer.layoutGeneration(); }
+    bool link(const std::shared_ptr<IVolume> &master, const std::shared_ptr<IVolume> &slave, double offsetDb) override;
+    bool unlink(const std::shared_ptr<IVolume> &slave) override;
+
+private:
+    friend class RecordingVolume;
+
+    /// @brief Append call to the log.
+    void log(std::uint16_t channel, CallLog::Op op, std::int32_t value, std::span<const std::int32_t> extra = {}) const;
+
+    /// @brief Replace volumes of the wrapped mixer with their recording wrappers.
+    void wrap(MixerSnapshot &snapshot) const;
+
+    /// @brief Find the recording wrapper of a volume, given the wrapper or the wrapped volume.
+    /// @return nullptr if the volume does not belong to the mixer.
+    const RecordingVolume *find(const std::shared_ptr<IVolume> &volume) const;
+
+    IMixer &mixer;
+    std::list<std::shared_ptr<IVolume>> playback;
+    std::list<std::shared_ptr<IVolume>> capture;
+    std::map<const IVolume *, std::shared_ptr<IVolume>> wrappers;
+    std::chrono::steady_clock::time_point start;
+    mutable std::mutex mutex;
+    std::FILE *file{nullptr};
+};
+
+/// @brief Results of replaying a call log.
+struct ReplayStats {
+    std::uint64_t calls{0};
+    std::uint64_t skipped{0};          // calls of channels not found in the mixer
+    std::chrono::nanoseconds elapsed{};
+    std::chrono::nanoseconds maxLag{}; // how late a call was issued after its recorded time
+    LatencyHistogram latency;          // of the replayed calls
+};
+
+/// @brief Replay call log against a mixer.
+/// Channels are matched by card, name and direction, falling back to name and direction.
+/// @param mixer Mixer to replay against, e.g. IMixer::alsaInstance() or FakeMixer
+/// @param log Call log
+/// @param speed Speed relative to the recording (2.0 twice as fast), 0 for as fast as possible
+ReplayStats replay(IMixer &mixer, const CallLog &log, double speed = 1.0);
+
+#endif // __AMIXER_RECORD_HPP__
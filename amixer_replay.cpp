@@ -0,0 +1,97 @@
+/*
+
+Copyright (c) 2025 Pawel Sklarow https://github.com/psklarow
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+of the Software, and to permit persons to whom the Software is furnished to do
+so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+ */
+
+/// @file amixer_replay.cpp
+/// @brief Replay tool for call logs recorded with RecordingMixer.
+/// Usage: amixer_replay [--alsa | --profile profile-file] [--speed factor] log-file
+/// By default the log is replayed against a FakeMixer with the channels of the log; with --profile
+/// against a FakeMixer emulating the captured hardware (see amixer_profile); with --alsa against the
+/// sound cards. Speed 1 replays at the original pace, 0 as fast as possible.
+///
+/// Note: this code has been developed with AI assistance.
+///
+/// To build use e.g.:
+///     c++ -std=c++23 amixer_replay.cpp amixer_record.cpp amixer_fake.cpp amixer.cpp amixer_balance.cpp amixer_scheduler.cpp amixer_metrics.cpp amixer_trace.cpp -o amixer_replay -lasound -Wall -Wextra -Wpedantic -Werror
+
+#include "amixer_record.hpp"
+#include "amixer_fake.hpp"
+#include <print>
+#include <cstring>
+#include <cerrno>
+#include <cstdlib>
+#include <memory>
+#include <string>
+
+int main(int argc, char *argv[])
+{
+    bool alsa = false;
+    double speed = 1.0;
+    const char *path = nullptr;
+    const char *profile = nullptr;
+    for (int i = 1; i < argc; ++i)
+    {
+        if (std::strcmp(argv[i], "--alsa") == 0)
+            alsa = true;
+        else if (std::strcmp(argv[i], "--profile") == 0 && i + 1 < argc)
+            profile = argv[++i];
+        else if (std::strcmp(argv[i], "--speed") == 0 && i + 1 < argc)
+            speed = std::atof(argv[++i]);
+        else
+            path = argv[i];
+    }
+    if (!path) {
+        std::println(stderr, "usage: amixer_replay [--alsa | --profile profile-file] [--speed factor] log-file");
+        return 2;
+    }
+
+    CallLog log;
+    if (!log.load(path)) {
+        std::println(stderr, "amixer_replay: cannot load {}: {}", path, std::strerror(errno));
+        return 1;
+    }
+
+    std::unique_ptr<FakeMixer> fake;
+    if (!alsa) {
+        std::vector<FakeChannel> channels;
+        if (profile) {
+            if (!loadProfile(profile, channels)) {
+                std::println(stderr, "amixer_replay: cannot load profile {}: {}", profile, std::strerror(errno));
+                return 1;
+            }
+        } else {
+            for (const auto &channel : log.channels)
+                channels.push_back(FakeChannel{channel.card, channel.name, channel.capture, channel.channels});
+        }
+        fake = std::make_unique<FakeMixer>(channels);
+    }
+    IMixer &mixer = fake ? static_cast<IMixer &>(*fake) : IMixer::alsaInstance();
+
+    auto stats = replay(mixer, log, speed);
+    std::println("calls: {} skipped: {} elapsed: {:.3f} s max lag: {} us",
+        stats.calls, stats.skipped, std::chrono::duration<double>(stats.elapsed).count(),
+        std::chrono::duration_cast<std::chrono::microseconds>(stats.maxLag).count());
+    std::println("latency: mean {} us p50 {} us p99 {} us p99.9 {} us",
+        stats.latency.mean().count(), stats.latency.quantile(0.5).count(),
+        stats.latency.quantile(0.99).count(), stats.latency.quantile(0.999).count());
+    return 0;
+}
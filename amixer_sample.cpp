@@ -30,7 +30,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 /// Note: this file uses C++23 features, such as std::clamp and std::ranges.
 ///
 /// To build use e.g.:
-///     c++ -std=c++23 amixer_sample.cpp amixer.cpp -o amixer -lasound -Wall -Wextra -Wpedantic -Werror
+///     c++ -std=c++23 amixer_sample.cpp amixer.cpp amixer_balance.cpp amixer_scheduler.cpp amixer_metrics.cpp amixer_trace.cpp amixer_ducking.cpp amixer_sync.cpp -o amixer -lasound -Wall -Wextra -Wpedantic -Werror
 
 #include "amixer.hpp"
 #include <print>
@@ -0,0 +1,134 @@
+/*
+
+Copyright (c) 2025 Pawel Sklarow https://github.com/psklarow
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+of the Software, and to permit persons to whom the Software is furnished to do
+so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+ */
+
+/// @file amixer_scene.cpp
+/// @brief Scene registry implementation.
+///
+/// Note: this code has been developed with AI assistance.
+
+#include "amixer_scene.hpp"
+
+#include <algorithm>
+#include <cerrno>
+
+SceneRegistry::SceneRegistry(IMixer &mixer)
+    : mixer(mixer)
+{
+}
+
+std::vector<SceneRegistry::CardPlan> SceneRegistry::compile(const std::vector<SceneChannel> &channels) const
+{
+    std::vector<CardPlan> plan;
+    for (const auto &channel : channels)
+    {
+        const auto &list = channel.capture ? mixer.captureChannels() : mixer.channels();
+        auto it = std::ranges::find_if(list, [&](const std::shared_ptr<IVolume> &volume) {
+            return (channel.card < 0 || volume->getCard() == channel.card) && volume->getName() == channel.name;
+        });
+        if (it == list.end())
+            continue;
+
+        int card = (*it)->getCard();
+        auto part = std::ranges::find(plan, card, &CardPlan::card);
+        if (part == plan.end())
+            part = plan.insert(plan.end(), CardPlan{card, {}});
+        part->writes.push_back(Write{*it, balancedLevels(**it, channel.volume, channel.balance)});
+    }
+    return plan;
+}
+
+int SceneRegistry::define(const std::string &name, std::vector<SceneChannel> channels)
+{
+    auto generation = this->generation();
+    auto plan = std::make_shared<const std::vector<CardPlan>>(compile(channels));
+    int resolved = 0;
+    for (const auto &part : *plan)
+        resolved += static_cast<int>(part.writes.size());
+
+    std::lock_guard lock(mutex);
+    scenes[name] = Scene{std::move(channels), std::move(plan), generation};
+    return resolved;
+}
+
+bool SceneRegistry::remove(const std::string &name)
+{
+    std::lock_guard lock(mutex);
+    return scenes.erase(name) > 0;
+}
+
+std::vector<std::string> SceneRegistry::names() const
+{
+    std::lock_guard lock(mutex);
+    std::vector<std::string> result;
+    for (const auto &[name, scene] : scenes)
+        result.push_back(name);
+    return result;
+}
+
+/// @brief Write the plan of one card.
+/// @return false if a volume has moved to another card, so the plans are out of date.
+bool SceneRegistry::run(const CardPlan &plan)
+{
+    bool current = true;
+    for (const auto &write : plan.writes)
+    {
+        write.volume->setChannelVolumes(write.levels);
+        current = current && write.volume->getCard() == plan.card;
+    }
+    return current;
+}
+
+int SceneRegistry::activate(const std::string &name)
+{
+    std::shared_ptr<const std::vector<CardPlan>> plan;
+    {
+        std::lock_guard lock(mutex);
+        auto it = scenes.find(name);
+        if (it == scenes.end())
+        {
+            errno = ENOENT;
+            return -1;
+        }
+        auto generation = this->generation();
+        if (it->second.generation != generation)
+        {
+            it->second.plan = std::make_shared<const std::vector<CardPlan>>(compile(it->second.channels));
+            it->second.generation = generation;
+        }
+        plan = it->second.plan;
+    }
+
+    int written = 0;
+    std::vector<int> cards;
+    for (const auto &part : *plan)
+    {
+        written += static_cast<int>(part.writes.size());
+        cards.push_back(part.card);
+    }
+    // a part finding a volume gone invalidates the plans, also when it runs after the call has returned
+    Scheduler::forEachCard(cards, [plan, invalidations = invalidations](std::size_t i) {
+        if (!run((*plan)[i]))
+            ++*invalidations;
+    });
+    return written;
+}
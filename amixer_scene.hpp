@@ -0,0 +1,127 @@
+/*
+
+Copyright (c) 2025 Pawel Sklarow https://github.com/psklarow
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+of the Software, and to permit persons to whom the Software is furnished to do
+so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+ */
+
+ // Note: this code has been developed with AI assistance.
+
+/// @file amixer_scene.hpp
+/// @brief Named scenes (presets) of channel volumes compiled into per-card write plans.
+
+#ifndef __AMIXER_SCENE_HPP__
+#define __AMIXER_SCENE_HPP__
+
+#include "amixer.hpp"
+#include "amixer_balance.hpp"
+#include "amixer_scheduler.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/// @brief Volume and balance of one channel in a scene.
+struct SceneChannel {
+    int card;            // ALSA card number, -1 for the first channel of the name on any card
+    std::string name;    // element name, e.g. "Speaker"
+    bool capture{false};
+    int volume;          // 0..100 percentage
+    int balance{0};      // -100 (left only) .. 0 (center) .. +100 (right only)
+};
+
+/// @brief Registry of named scenes.
+/// A scene is compiled when it is defined: channel names are resolved to volumes of the mixer and
+/// volume and balance are turned into the per-channel levels to write, grouped per card. Activation
+/// then only writes the precomputed levels, one setChannelVolumes() per channel, without name lookups
+/// or reading the current balance. All cards are written in parallel on their card Scheduler threads.
+///
+/// A plan stays valid until the layout of the mixer changes (IMixer::layoutGeneration()): when a card
+/// is removed or appears, every scene is compiled again from its channel list before its next use, so
+/// channels which could not be resolved before are picked up once their card is back.
+class SceneRegistry {
+public:
+    /// @brief Constructor
+    /// @param mixer Mixer the scenes are applied to
+    explicit SceneRegistry(IMixer &mixer);
+
+    SceneRegistry(const SceneRegistry &) = delete;
+    SceneRegistry &operator=(const SceneRegistry &) = delete;
+
+    /// @brief Define or replace a scene and compile its plan.
+    /// @param name Scene name
+    /// @param channels Channels of the scene; channels missing in the mixer are skipped
+    /// @return Number of channels resolved to volumes of the mixer.
+    int define(const std::string &name, std::vector<SceneChannel> channels);
+
+    /// @brief Remove a scene.
+    /// @return false if there is no scene of the name.
+    bool remove(const std::string &name);
+
+    /// @brief Get names of all scenes, sorted.
+    std::vector<std::string> names() const;
+
+    /// @brief Apply a scene and wait until all cards are written.
+    /// Called from a Scheduler thread (e.g. a change listener), the call does not wait, as the other
+    /// card threads may be waiting for that thread: the plan of the thread's card is written inline and
+    /// the other cards are written asynchronously.
+    /// @param name Scene name
+    /// @return Number of channels written, or -1 if there is no scene of the name (errno is set to ENOENT).
+    int activate(const std::string &name);
+
+    /// @brief Recompile all scenes before their next activation, in addition to layout changes of the mixer.
+    void invalidate() { ++*invalidations; }
+
+private:
+    /// @brief Levels of one volume.
+    struct Write {
+        std::shared_ptr<IVolume> volume;
+        std::vector<int> levels; // per channel, in the channel order of the volume
+    };
+
+    /// @brief Writes of one card, run on its Scheduler thread.
+    struct CardPlan {
+        int card;
+        std::vector<Write> writes;
+    };
+
+    struct Scene {
+        std::vector<SceneChannel> channels;
+        std::shared_ptr<const std::vector<CardPlan>> plan;
+        std::uint64_t generation; // generation() the plan has been compiled for
+    };
+
+    /// @brief Layout generation of the mixer plus explicit invalidations; grows whenever either changes.
+    std::uint64_t generation() const { return mixer.layoutGeneration() + invalidations->load(); }
+
+    std::vector<CardPlan> compile(const std::vector<SceneChannel> &channels) const;
+    static bool run(const CardPlan &plan);
+
+    IMixer &mixer;
+    mutable std::mutex mutex;
+    std::map<std::string, Scene> scenes;
+    // shared with asynchronous writes, which may outlive the registry
+    std::shared_ptr<std::atomic<std::uint64_t>> invalidations{std::make_shared<std::atomic<std::uint64_t>>(0)};
+};
+
+#endif // __AMIXER_SCENE_HPP__
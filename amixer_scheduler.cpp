@@ -0,0 +1,211 @@
+/*
+
+Copyright (c) 2025 Pawel Sklarow https://github.com/psklarow
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+of the Software, and to permit persons to whom the Software is furnished to do
+so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+ */
+
+/// @file amixer_scheduler.cpp
+/// @brief Timer based task scheduler implementation.
+///
+/// Note: this code has been developed with AI assistance.
+
+#include "amixer_scheduler.hpp"
+#include "amixer_trace.hpp"
+
+#include <algorithm>
+#include <future>
+#include <map>
+#include <memory>
+#include <utility>
+
+static thread_local bool schedulerThread = false;
+
+/// @brief Constructor
+/// Starts the worker thread.
+Scheduler::Scheduler(int card) : card(card), worker([this] { run(); })
+{
+}
+
+/// @brief Destructor
+/// Stops the worker thread. Tasks which are not due yet are dropped.
+Scheduler::~Scheduler()
+{
+    {
+        std::lock_guard lock(mutex);
+        stopping = true;
+    }
+    wakeup.notify_all();
+    if (worker.joinable())
+        worker.join();
+}
+
+void Scheduler::post(Task task)
+{
+    schedule(Clock::now(), std::move(task));
+}
+
+void Scheduler::schedule(Clock::time_point when, Task task)
+{
+    bool wake;
+    {
+        std::lock_guard lock(mutex);
+        if (stopping)
+            return;
+        wake = queue.empty() || when < queue.top().when;
+        queue.push(Entry{when, nextSequence++, std::move(task)});
+    }
+    if (wake)
+        wakeup.notify_one();
+}
+
+/// @brief Worker thread loop.
+/// Waits for the earliest task to become due and runs it without holding the queue lock,
+/// so tasks may schedule further tasks. With tracing enabled, the time a task waited past its due
+/// time is recorded as a queue wait.
+void Scheduler::run()
+{
+    schedulerThread = true;
+    std::unique_lock lock(mutex);
+    while (!stopping)
+    {
+        if (queue.empty())
+        {
+            wakeup.wait(lock);
+            continue;
+        }
+        auto when = queue.top().when;
+        if (Clock::now() < when)
+        {
+            wakeup.wait_until(lock, when);
+            continue;
+        }
+        auto task = std::move(const_cast<Entry &>(queue.top()).task);
+        queue.pop();
+        lock.unlock();
+        if (auto &trace = Trace::instance(); trace.enabled())
+            trace.record("queue_wait", "scheduler", when, Clock::now() - when, card);
+        task();
+        lock.lock();
+    }
+}
+
+bool Scheduler::onSchedulerThread()
+{
+    return schedulerThread;
+}
+
+/// @brief Get the library wide scheduler instance.
+/// @return Reference to the Scheduler instance.
+Scheduler &Scheduler::instance()
+{
+    // the trace is used by the worker threads, so it must be destroyed after them
+    Trace::instance();
+    static Scheduler scheduler;
+    return scheduler;
+}
+
+/// @brief Schedulers of the sound cards, created on first use.
+struct CardSchedulers {
+    std::mutex mutex;
+    std::map<int, std::unique_ptr<Scheduler>> schedulers;
+};
+
+/// @brief Get the registry of card schedulers.
+/// The trace is used by the worker threads, so it is constructed first and destroyed after them.
+static CardSchedulers &cardSchedulers()
+{
+    Trace::instance();
+    static CardSchedulers registry;
+    return registry;
+}
+
+/// @brief Get scheduler dedicated to one sound card.
+/// @param card ALSA card number
+/// @return Reference to the Scheduler instance of the card.
+Scheduler &Scheduler::forCard(int card)
+{
+    auto &registry = cardSchedulers();
+    std::lock_guard lock(registry.mutex);
+    auto &scheduler = registry.schedulers[card];
+    if (!scheduler)
+        scheduler = std::make_unique<Scheduler>(card);
+    return *scheduler;
+}
+
+void Scheduler::prepareCards()
+{
+    cardSchedulers();
+}
+
+bool Scheduler::forEachCard(std::span<const int> cards, std::function<void(std::size_t)> task)
+{
+    bool wait = !onSchedulerThread();
+    auto shared = std::make_shared<const std::function<void(std::size_t)>>(std::move(task));
+    std::vector<std::future<void>> done;
+    for (std::size_t i = 0; i < cards.size(); ++i)
+    {
+        auto &scheduler = forCard(cards[i]);
+        if (scheduler.isSchedulerThread())
+        {
+            (*shared)(i);
+            continue;
+        }
+        auto finished = std::make_shared<std::promise<void>>();
+        if (wait)
+            done.push_back(finished->get_future());
+        scheduler.post([shared, finished, i] {
+            (*shared)(i);
+            finished->set_value();
+        });
+    }
+    for (auto &result : done)
+        result.wait();
+    return wait;
+}
+
+void ControlLatency::record(int card, Clock::duration roundTrip)
+{
+    auto &slot = nanoseconds[static_cast<unsigned>(card) % nanoseconds.size()];
+    auto sample = std::chrono::duration_cast<std::chrono::nanoseconds>(roundTrip).count();
+    auto current = slot.load(std::memory_order_relaxed);
+    slot.store(current == 0 ? sample : current + (sample - current) / 4, std::memory_order_relaxed);
+}
+
+ControlLatency::Clock::duration ControlLatency::roundTrip(int card) const
+{
+    auto ns = nanoseconds[static_cast<unsigned>(card) % nanoseconds.size()].load(std::memory_order_relaxed);
+    return std::chrono::duration_cast<Clock::duration>(std::chrono::nanoseconds(ns));
+}
+
+ControlLatency::Clock::duration ControlLatency::stepInterval(int card, Clock::duration fallback) const
+{
+    auto measured = roundTrip(card);
+    if (measured <= Clock::duration::zero())
+        return fallback;
+    return std::clamp<Clock::duration>(measured * stepFactor, minStep, maxStep);
+}
+
+/// @brief Get the library wide instance.
+/// @return Reference to the ControlLatency instance.
+ControlLatency &ControlLatency::instance()
+{
+    static ControlLatency latency;
+    return latency;
+}
@@ -0,0 +1,183 @@
+/*
+
+Copyright (c) 2025 Pawel Sklarow https://github.com/psklarow
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+of the Software, and to permit persons to whom the Software is furnished to do
+so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+ */
+
+ // Note: this code has been developed with AI assistance.
+
+/// @file amixer_scheduler.hpp
+/// @brief Timer based task scheduler used by the mixer library.
+/// The scheduler runs tasks on a single worker thread, either as soon as possible or at a given
+/// point in time on the monotonic clock. It is used for fades, ramps and other delayed operations,
+/// so that the caller of the volume API never has to wait for them.
+
+#ifndef __AMIXER_SCHEDULER_HPP__
+#define __AMIXER_SCHEDULER_HPP__
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <span>
+#include <thread>
+#include <vector>
+
+/// @brief Single threaded timer task scheduler.
+/// Tasks scheduled for the same point in time are run in the order they were scheduled.
+/// Tasks must not block for long, as they delay all the tasks scheduled after them.
+class Scheduler {
+public:
+    using Clock = std::chrono::steady_clock; // CLOCK_MONOTONIC
+    using Task = std::function<void()>;
+
+    /// @brief Constructor
+    /// @param card ALSA card number the scheduler is dedicated to, -1 for none (trace events)
+    explicit Scheduler(int card = -1);
+    ~Scheduler();
+
+    Scheduler(const Scheduler &) = delete;
+    Scheduler &operator=(const Scheduler &) = delete;
+
+    /// @brief Run task on the scheduler thread as soon as possible.
+    /// @param task Task to run
+    void post(Task task);
+
+    /// @brief Run task on the scheduler thread at given point in time.
+    /// If the time has already passed, the task is run as soon as possible.
+    /// @param when Point in time on the monotonic clock
+    /// @param task Task to run
+    void schedule(Clock::time_point when, Task task);
+
+    /// @brief Run task on the scheduler thread after given delay.
+    /// @param delay Delay from now
+    /// @param task Task to run
+    void scheduleAfter(Clock::duration delay, Task task) {
+        schedule(Clock::now() + delay, std::move(task));
+    }
+
+    /// @brief Check whether the calling thread is the scheduler thread.
+    bool isSchedulerThread() const {
+        return std::this_thread::get_id() == worker.get_id();
+    }
+
+    /// @brief Check whether the calling thread is the thread of any Scheduler.
+    /// Code running there must not wait for tasks of other schedulers, which may be waiting for it.
+    static bool onSchedulerThread();
+
+    /// @brief Get the library wide scheduler instance.
+    /// This instance is created on first call and destroyed on program exit.
+    /// @return Reference to the Scheduler instance.
+    static Scheduler &instance();
+
+    /// @brief Get scheduler dedicated to one sound card.
+    /// Tasks writing to different cards can run on their card schedulers in parallel,
+    /// so a slow card does not delay the others.
+    /// @param card ALSA card number
+    /// @return Reference to the Scheduler instance of the card, created on first call.
+    static Scheduler &forCard(int card);
+
+    /// @brief Construct the registry of card schedulers without creating any scheduler.
+    /// Static objects which may reach forCard() while they are destroyed (e.g. the ALSA mixer propagating
+    /// links on exit) call it from their constructors, so the registry is destroyed after them.
+    static void prepareCards();
+
+    /// @brief Run a task for each card on the scheduler of the card, all cards in parallel, and wait for them.
+    /// The task of the card of the calling Scheduler thread is run inline. Called from a Scheduler thread,
+    /// the call does not wait for the other cards, as their threads may be waiting for the calling one.
+    /// @param cards ALSA card numbers, each listed once
+    /// @param task Task taking the index of a card in cards; it owns its data, as it may run after the call returns
+    /// @return true if the call has waited for all cards.
+    static bool forEachCard(std::span<const int> cards, std::function<void(std::size_t)> task);
+
+private:
+    struct Entry {
+        Clock::time_point when;
+        std::uint64_t sequence;
+        Task task;
+
+        bool operator>(const Entry &other) const {
+            return when != other.when ? when > other.when : sequence > other.sequence;
+        }
+    };
+
+    void run();
+
+    std::mutex mutex;
+    std::condition_variable wakeup;
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> queue;
+    std::uint64_t nextSequence{0};
+    bool stopping{false};
+    int card;
+    std::thread worker;
+};
+
+/// @brief Measured control latency of sound cards and fade step intervals derived from it.
+/// The ALSA mixer measures the time from its own control writes to their ALSA events, so nothing is
+/// written only to measure (FakeMixer reports the write latency of its profile). Fades use stepInterval()
+/// so steps come as often as the card can take them without queueing: a card taking a write in 50 us
+/// fades in 1 ms steps, a USB card taking 6 ms in 12 ms steps.
+class ControlLatency {
+public:
+    using Clock = Scheduler::Clock;
+
+    static constexpr Clock::duration minStep = std::chrono::milliseconds(1);
+    static constexpr Clock::duration maxStep = std::chrono::milliseconds(50);
+    static constexpr int stepFactor = 2; // step interval in round trips
+
+    /// @brief Record a measured round trip; samples are smoothed with weight 1/4.
+    /// @param card ALSA card number
+    /// @param roundTrip Time from a control write to its event
+    void record(int card, Clock::duration roundTrip);
+
+    /// @brief Get smoothed round trip of a card.
+    /// @return Round trip, or zero if the card has not been measured.
+    Clock::duration roundTrip(int card) const;
+
+    /// @brief Get fade step interval suitable for a card.
+    /// @param card ALSA card number
+    /// @param fallback Interval used when the card has not been measured
+    Clock::duration stepInterval(int card, Clock::duration fallback) const;
+
+    /// @brief Resolve step interval requested by a fade.
+    /// @param card ALSA card number
+    /// @param requested Requested interval, zero for the interval suitable for the card
+    /// @param fallback Interval used when the card has not been measured
+    /// @return requested, or stepInterval() rounded up to the resolution of Duration.
+    template <class Duration>
+    Duration resolve(int card, Duration requested, Duration fallback) const {
+        if (requested > Duration::zero())
+            return requested;
+        return std::max(std::chrono::ceil<Duration>(stepInterval(card, fallback)), Duration(1));
+    }
+
+    /// @brief Get the library wide instance.
+    static ControlLatency &instance();
+
+private:
+    std::array<std::atomic<std::int64_t>, 32> nanoseconds{}; // SNDRV_CARDS
+};
+
+#endif // __AMIXER_SCHEDULER_HPP__
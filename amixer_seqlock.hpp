@@ -0,0 +1,82 @@
+/*
+
+Copyright (c) 2025 Pawel Sklarow https://github.com/psklarow
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+of the Software, and to permit persons to whom the Software is furnished to do
+so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+ */
+
+ // Note: this code has been developed with AI assistance.
+
+/// @file amixer_seqlock.hpp
+/// @brief Sequence lock for data with a single writer and many readers.
+/// The lock consists of a single atomic counter, so it can be placed in shared memory
+/// and used across processes.
+
+#ifndef __AMIXER_SEQLOCK_HPP__
+#define __AMIXER_SEQLOCK_HPP__
+
+#include <atomic>
+#include <cstdint>
+
+/// @brief Sequence lock.
+/// The writer makes the counter odd while it updates the data and even again when done.
+/// Readers never block the writer: they copy the data and retry if the counter changed meanwhile.
+/// The protected data must be accessed with atomic loads and stores (relaxed order is enough),
+/// so that a torn read is retried instead of being undefined behavior.
+/// Writers must be serialized by the caller.
+class SeqLock {
+public:
+    static_assert(std::atomic<std::uint32_t>::is_always_lock_free, "seqlock counter must be lock free to be shared");
+
+    /// @brief Update the protected data.
+    /// @param writer Function writing the data
+    template <class Writer>
+    void write(Writer &&writer) {
+        auto seq = sequence.load(std::memory_order_relaxed);
+        sequence.store(seq + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        writer();
+        sequence.store(seq + 2, std::memory_order_release);
+    }
+
+    /// @brief Read consistent copy of the protected data.
+    /// @param reader Function copying the data, may be called several times
+    template <class Reader>
+    void read(Reader &&reader) const {
+        for (;;) {
+            auto before = sequence.load(std::memory_order_acquire);
+            if (before & 1u)
+                continue;
+            reader();
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (sequence.load(std::memory_order_relaxed) == before)
+                return;
+        }
+    }
+
+    /// @brief Get current sequence number; it changes on every write.
+    std::uint32_t version() const {
+        return sequence.load(std::memory_order_acquire);
+    }
+
+private:
+    std::atomic<std::uint32_t> sequence{0};
+};
+
+#endif // __AMIXER_SEQLOCK_HPP__
@@ -0,0 +1,650 @@
+/*
+
+Copyright (c) 2025 Pawel Sklarow https://github.com/psklarow
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+of the Software, and to permit persons to whom the Software is furnished to do
+so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+ */
+
+/// @file amixer_server.cpp
+/// @brief Local volume server and client implementation.
+///
+/// Note: this code has been developed with AI assistance.
+
+#include "amixer_server.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <new>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <linux/futex.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+/// @brief Map shared memory segment.
+/// @return Mapped memory, or nullptr on failure (errno is set).
+static void *mapShared(const std::string &name, std::size_t size, bool create, bool writable)
+{
+    int fd = shm_open(name.c_str(), create ? O_CREAT | O_RDWR : (writable ? O_RDWR : O_RDONLY), 0660);
+    if (fd < 0)
+        return nullptr;
+    if (create && ftruncate(fd, static_cast<off_t>(size)) != 0)
+    {
+        close(fd);
+        return nullptr;
+    }
+    void *memory = mmap(nullptr, size, writable ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    return memory == MAP_FAILED ? nullptr : memory;
+}
+
+static std::uint32_t *futexWord(std::atomic<std::uint32_t> &word)
+{
+    return reinterpret_cast<std::uint32_t *>(&word);
+}
+
+/// @brief Check whether a process exists; EPERM means it exists under another user.
+static bool processAlive(std::int32_t pid)
+{
+    return kill(pid, 0) == 0 || errno != ESRCH;
+}
+
+void SharedCommandRing::init()
+{
+    head.store(0, std::memory_order_relaxed);
+    tail.store(0, std::memory_order_relaxed);
+    waiting.store(0, std::memory_order_relaxed);
+    for (std::size_t i = 0; i < capacity; ++i)
+    {
+        slots[i].sequence.store(i, std::memory_order_relaxed);
+        slots[i].owner.store(0, std::memory_order_relaxed);
+    }
+    magic.store(magicValue, std::memory_order_release);
+}
+
+bool SharedCommandRing::push(const VolumeCommand &command)
+{
+    const std::int32_t pid = getpid();
+    unsigned busy = 0;
+    auto position = head.load(std::memory_order_relaxed);
+    for (;;)
+    {
+        auto &slot = slots[position & (capacity - 1)];
+        auto sequence = slot.sequence.load(std::memory_order_acquire);
+        auto diff = static_cast<std::int64_t>(sequence - position);
+        if (diff == 0)
+        {
+            // own the slot before claiming the position, so a stalled slot always names its producer
+            std::int32_t owner = 0;
+            if (slot.owner.compare_exchange_strong(owner, pid, std::memory_order_acquire))
+            {
+                if (head.compare_exchange_strong(position, position + 1, std::memory_order_relaxed))
+                {
+                    slot.command = command;
+                    slot.sequence.store(position + 1, std::memory_order_release);
+                    break;
+                }
+                owner = pid; // position is taken or outdated, position has been reloaded
+                slot.owner.compare_exchange_strong(owner, 0, std::memory_order_relaxed);
+                continue;
+            }
+            // another producer is claiming the slot; take it over only if that process is gone
+            if (owner != pid && ++busy > 64 && !processAlive(owner))
+                slot.owner.compare_exchange_strong(owner, 0, std::memory_order_relaxed);
+            position = head.load(std::memory_order_relaxed);
+        }
+        else if (diff < 0)
+        {
+            return false; // full
+        }
+        else
+        {
+            position = head.load(std::memory_order_relaxed);
+        }
+    }
+
+    // pairs with the fence in wait(): either the consumer sees the command, or we see it waiting
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (waiting.load(std::memory_order_relaxed) == 1 && waiting.exchange(0) == 1)
+        syscall(SYS_futex, futexWord(waiting), FUTEX_WAKE, 1, nullptr, nullptr, 0);
+    return true;
+}
+
+bool SharedCommandRing::pop(VolumeCommand &command)
+{
+    auto position = tail.load(std::memory_order_relaxed);
+    auto &slot = slots[position & (capacity - 1)];
+    if (slot.sequence.load(std::memory_order_acquire) != position + 1)
+        return false;
+    command = slot.command;
+    slot.owner.store(0, std::memory_order_relaxed);
+    slot.sequence.store(position + capacity, std::memory_order_release);
+    tail.store(position + 1, std::memory_order_relaxed);
+    return true;
+}
+
+bool SharedCommandRing::stalled() const
+{
+    auto position = tail.load(std::memory_order_relaxed);
+    return head.load(std::memory_order_acquire) != position &&
+           slots[position & (capacity - 1)].sequence.load(std::memory_order_acquire) == position;
+}
+
+/// The owner of a stalled slot is the producer which claimed its position. Producers drop the ownership
+/// of another producer only when that process is gone, so a stalled slot without an owner is abandoned too.
+bool SharedCommandRing::skipAbandoned()
+{
+    if (!stalled())
+        return false;
+    auto position = tail.load(std::memory_order_relaxed);
+    auto &slot = slots[position & (capacity - 1)];
+    auto owner = slot.owner.load(std::memory_order_acquire);
+    if (owner != 0 && processAlive(owner))
+        return false;
+    slot.owner.store(0, std::memory_order_relaxed);
+    slot.sequence.store(position + capacity, std::memory_order_release);
+    tail.store(position + 1, std::memory_order_relaxed);
+    return true;
+}
+
+void SharedCommandRing::wait(std::chrono::milliseconds timeout)
+{
+    waiting.store(1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    auto position = tail.load(std::memory_order_relaxed);
+    if (slots[position & (capacity - 1)].sequence.load(std::memory_order_acquire) == position + 1)
+    {
+        waiting.store(0, std::memory_order_relaxed);
+        return;
+    }
+    timespec ts{static_cast<time_t>(timeout.count() / 1000), static_cast<long>(timeout.count() % 1000) * 1000000L};
+    syscall(SYS_futex, futexWord(waiting), FUTEX_WAIT, 1, &ts, nullptr, 0);
+    waiting.store(0, std::memory_order_relaxed);
+}
+
+void SharedCommandRing::wake()
+{
+    waiting.store(0);
+    syscall(SYS_futex, futexWord(waiting), FUTEX_WAKE, 1, nullptr, nullptr, 0);
+}
+
+/// @brief Fill Unix socket address.
+/// @return false if the path does not fit.
+static bool socketAddress(const std::string &path, sockaddr_un &address)
+{
+    std::memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(address.sun_path))
+    {
+        errno = ENAMETOOLONG;
+        return false;
+    }
+    std::memcpy(address.sun_path, path.c_str(), path.size());
+    return true;
+}
+
+VolumeServer::VolumeServer(IMixer &mixer, std::string sharedMemoryName, std::string socketPath)
+    : mixer(mixer), sharedMemoryName(std::move(sharedMemoryName)), socketPath(std::move(socketPath))
+{
+    for (const auto &v : mixer.channels())
+        volumes.push_back(v);
+    for (const auto &v : mixer.captureChannels())
+        volumes.push_back(v);
+    if (volumes.size() > SharedMixerState::maxChannels)
+        volumes.resize(SharedMixerState::maxChannels);
+    for (std::size_t i = 0; i < volumes.size(); ++i)
+        indexes.emplace(volumes[i].get(), i);
+}
+
+/// @brief Destructor
+/// Closes client connections and removes the socket and the shared memory segment.
+VolumeServer::~VolumeServer()
+{
+    if (subscription)
+    {
+        // a listener call may already be running on the scheduler thread, it finishes before the cut
+        mixer.removeChangeListener(listener);
+        std::lock_guard lock(subscription->mutex);
+        subscription->server = nullptr;
+    }
+    if (ringThread.joinable())
+    {
+        ringStopping = true;
+        ring->wake();
+        ringThread.join();
+    }
+    if (ring)
+    {
+        ring->magic.store(0, std::memory_order_release);
+        munmap(ring, sizeof(SharedCommandRing));
+        shm_unlink(ringName().c_str());
+    }
+    for (int fd : clients)
+        close(fd);
+    if (listenFd >= 0)
+    {
+        close(listenFd);
+        unlink(socketPath.c_str());
+    }
+    if (stopFd >= 0)
+        close(stopFd);
+    if (state)
+    {
+        state->magic.store(0, std::memory_order_release);
+        munmap(state, sizeof(SharedMixerState));
+        shm_unlink(sharedMemoryName.c_str());
+    }
+}
+
+bool VolumeServer::start()
+{
+    void *memory = mapShared(sharedMemoryName, sizeof(SharedMixerState), true, true);
+    if (!memory)
+        return false;
+
+    // channel list is static, publish it before marking the segment ready
+    state = new (memory) SharedMixerState{};
+    state->version = SharedMixerState::versionValue;
+    state->count = static_cast<std::uint32_t>(volumes.size());
+    for (std::size_t i = 0; i < volumes.size(); ++i)
+    {
+        auto &channel = state->channels[i];
+        auto name = volumes[i]->getName();
+        std::memcpy(channel.name, name.c_str(), std::min(name.size(), SharedMixerState::maxName - 1));
+        channel.card = volumes[i]->getCard();
+        channel.capture = volumes[i]->isCapture() ? 1 : 0;
+    }
+    subscription = std::make_shared<Subscription>();
+    subscription->server = this;
+    listener = mixer.addChangeListener([subscription = subscription](const ChannelSnapshot &channel) {
+        std::lock_guard lock(subscription->mutex);
+        if (subscription->server)
+            subscription->server->changed(channel);
+    });
+    publishAll();
+    state->magic.store(SharedMixerState::magicValue, std::memory_order_release);
+
+    void *ringMemory = mapShared(ringName(), sizeof(SharedCommandRing), true, true);
+    if (!ringMemory)
+        return false;
+    ring = new (ringMemory) SharedCommandRing{};
+    ring->init();
+    ringThread = std::thread([this] { drainRing(); });
+
+    stopFd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (stopFd < 0)
+        return false;
+
+    sockaddr_un address;
+    if (!socketAddress(socketPath, address))
+        return false;
+    listenFd = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+    if (listenFd < 0)
+        return false;
+    unlink(socketPath.c_str());
+    if (bind(listenFd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) != 0 ||
+        listen(listenFd, 16) != 0)
+        return false;
+    return true;
+}
+
+void VolumeServer::run()
+{
+    for (;;)
+    {
+        std::vector<pollfd> fds;
+        fds.push_back({stopFd, POLLIN, 0});
+        fds.push_back({listenFd, POLLIN, 0});
+        for (int fd : clients)
+            fds.push_back({fd, POLLIN, 0});
+
+        int ready = poll(fds.data(), fds.size(), -1);
+        if (ready < 0 && errno != EINTR)
+            return;
+        if (ready <= 0)
+            continue;
+
+        if (fds[0].revents)
+            return;
+
+        if (fds[1].revents & POLLIN)
+        {
+            int fd = accept4(listenFd, nullptr, nullptr, SOCK_CLOEXEC);
+            if (fd >= 0)
+                clients.push_back(fd);
+        }
+
+        for (std::size_t i = 2; i < fds.size(); ++i)
+        {
+            if (!fds[i].revents)
+                continue;
+            VolumeCommand command;
+            auto received = recv(fds[i].fd, &command, sizeof(command), 0);
+            if (received == static_cast<ssize_t>(sizeof(command)))
+            {
+                std::int32_t status = apply(command);
+                send(fds[i].fd, &status, sizeof(status), MSG_NOSIGNAL);
+                continue;
+            }
+            if (received < 0 && errno == EINTR)
+                continue;
+            // disconnected or malformed command
+            close(fds[i].fd);
+            std::erase(clients, fds[i].fd);
+        }
+    }
+}
+
+void VolumeServer::stop()
+{
+    std::uint64_t one = 1;
+    if (stopFd >= 0)
+        [[maybe_unused]] auto written = write(stopFd, &one, sizeof(one));
+}
+
+/// @brief Apply client command to the mixer and publish the changed channel.
+/// @return 0 on success, negative errno value on invalid command.
+std::int32_t VolumeServer::apply(const VolumeCommand &command)
+{
+    if (command.op == VolumeCommand::Refresh)
+    {
+        publishAll();
+        return 0;
+    }
+    auto status = execute(command);
+    if (status == 0)
+        publish(command.channel);
+    return status;
+}
+
+/// @brief Apply client command to the mixer.
+/// @return 0 on success, negative errno value on invalid command.
+std::int32_t VolumeServer::execute(const VolumeCommand &command)
+{
+    if (command.channel >= volumes.size())
+        return -EINVAL;
+
+    auto &volume = volumes[command.channel];
+    switch (command.op)
+    {
+    case VolumeCommand::SetVolume:
+        volume->setVolume(command.value);
+        break;
+    case VolumeCommand::SetBalance:
+        volume->setBalance(command.value);
+        break;
+    case VolumeCommand::SetMute:
+        volume->setMute(command.value != 0, command.arg);
+        break;
+    default:
+        return -EINVAL;
+    }
+    return 0;
+}
+
+/// @brief Ring consumer thread.
+/// Drains all queued commands, drops volume and balance commands superseded by a later command of
+/// the same kind for the same channel and applies the rest in order; the change listener publishes the
+/// changed channels. A slot left unpublished by a producer which has died is skipped.
+void VolumeServer::drainRing()
+{
+    std::vector<VolumeCommand> batch;
+    std::vector<bool> keep;
+    std::vector<std::uint8_t> seen(volumes.size());
+    std::optional<std::chrono::steady_clock::time_point> stalledSince;
+
+    while (!ringStopping)
+    {
+        batch.clear();
+        VolumeCommand command;
+        while (batch.size() < SharedCommandRing::capacity && ring->pop(command))
+            batch.push_back(command);
+        if (batch.empty())
+        {
+            // a producer killed between claiming a slot and publishing it would block the ring for good
+            auto now = std::chrono::steady_clock::now();
+            if (!ring->stalled())
+                stalledSince.reset();
+            else if (!stalledSince)
+                stalledSince = now;
+            else if (now - *stalledSince >= ringPollInterval && ring->skipAbandoned())
+                stalledSince.reset();
+            ring->wait(ringPollInterval);
+            continue;
+        }
+
+        keep.assign(batch.size(), true);
+        std::ranges::fill(seen, 0);
+        for (std::size_t i = batch.size(); i-- > 0;)
+        {
+            const auto &c = batch[i];
+            if (c.channel >= volumes.size() || (c.op != VolumeCommand::SetVolume && c.op != VolumeCommand::SetBalance))
+                continue;
+            std::uint8_t bit = c.op == VolumeCommand::SetVolume ? 1 : 2;
+            if (seen[c.channel] & bit)
+                keep[i] = false;
+            seen[c.channel] |= bit;
+        }
+
+        // changed channels are published by the change listener
+        bool refresh = false;
+        for (std::size_t i = 0; i < batch.size(); ++i)
+        {
+            if (!keep[i])
+                continue;
+            if (batch[i].op == VolumeCommand::Refresh)
+                refresh = true;
+            else
+                execute(batch[i]);
+        }
+        if (refresh)
+            publishAll();
+    }
+}
+
+/// @brief Publish state of a channel changed through the library or by another program.
+void VolumeServer::changed(const ChannelSnapshot &channel)
+{
+    auto it = indexes.find(channel.volume.get());
+    if (it != indexes.end())
+        publish(it->second, channel.volumeLevel, channel.balance, channel.muted);
+}
+
+void VolumeServer::publish(std::size_t index)
+{
+    auto &volume = volumes[index];
+    publish(index, volume->getVolume(), volume->getBalance(), volume->isMuted());
+}
+
+void VolumeServer::publish(std::size_t index, int level, int balance, bool muted)
+{
+    auto &channel = state->channels[index];
+    std::lock_guard lock(publishMutex);
+    state->lock.write([&] {
+        channel.volume.store(level, std::memory_order_relaxed);
+        channel.balance.store(balance, std::memory_order_relaxed);
+        channel.muted.store(muted ? 1 : 0, std::memory_order_relaxed);
+    });
+}
+
+void VolumeServer::publishAll()
+{
+    for (std::size_t i = 0; i < volumes.size(); ++i)
+        publish(i);
+}
+
+VolumeClient::VolumeClient(std::string sharedMemoryName, std::string socketPath)
+    : sharedMemoryName(std::move(sharedMemoryName)), socketPath(std::move(socketPath))
+{
+}
+
+VolumeClient::~VolumeClient()
+{
+    if (socketFd >= 0)
+        close(socketFd);
+    if (ring)
+        munmap(ring, sizeof(SharedCommandRing));
+    if (state)
+        munmap(const_cast<SharedMixerState *>(state), sizeof(SharedMixerState));
+}
+
+bool VolumeClient::connect()
+{
+    if (state)
+        return true;
+    void *memory = mapShared(sharedMemoryName, sizeof(SharedMixerState), false, false);
+    if (!memory)
+        return false;
+
+    auto *shared = static_cast<const SharedMixerState *>(memory);
+    if (shared->magic.load(std::memory_order_acquire) != SharedMixerState::magicValue ||
+        shared->version != SharedMixerState::versionValue)
+    {
+        munmap(memory, sizeof(SharedMixerState));
+        errno = EAGAIN;
+        return false;
+    }
+    state = shared;
+
+    // the command ring is optional, without it post() falls back to the socket
+    void *ringMemory = mapShared(sharedMemoryName + "-ring", sizeof(SharedCommandRing), false, true);
+    if (ringMemory)
+    {
+        ring = static_cast<SharedCommandRing *>(ringMemory);
+        if (ring->magic.load(std::memory_order_acquire) != SharedCommandRing::magicValue)
+        {
+            munmap(ringMemory, sizeof(SharedCommandRing));
+            ring = nullptr;
+        }
+    }
+    return true;
+}
+
+std::size_t VolumeClient::channelCount() const
+{
+    return state ? state->count : 0;
+}
+
+std::optional<std::size_t> VolumeClient::find(const std::string &name, bool capture) const
+{
+    for (std::size_t i = 0; i < channelCount(); ++i)
+    {
+        const auto &channel = state->channels[i];
+        if (name == channel.name && (channel.capture != 0) == capture)
+            return i;
+    }
+    return std::nullopt;
+}
+
+VolumeClient::Channel VolumeClient::read(std::size_t index) const
+{
+    Channel result{};
+    if (index >= channelCount())
+        return result;
+
+    const auto &channel = state->channels[index];
+    result.name = channel.name;
+    result.card = channel.card;
+    result.capture = channel.capture != 0;
+    state->lock.read([&] {
+        result.volume = channel.volume.load(std::memory_order_relaxed);
+        result.balance = channel.balance.load(std::memory_order_relaxed);
+        result.muted = channel.muted.load(std::memory_order_relaxed) != 0;
+    });
+    return result;
+}
+
+int VolumeClient::getVolume(std::size_t index) const
+{
+    return index < channelCount() ? state->channels[index].volume.load(std::memory_order_relaxed) : 0;
+}
+
+int VolumeClient::getBalance(std::size_t index) const
+{
+    return index < channelCount() ? state->channels[index].balance.load(std::memory_order_relaxed) : 0;
+}
+
+bool VolumeClient::isMuted(std::size_t index) const
+{
+    return index < channelCount() && state->channels[index].muted.load(std::memory_order_relaxed) != 0;
+}
+
+bool VolumeClient::setVolume(std::size_t index, int volume)
+{
+    return send(VolumeCommand{VolumeCommand::SetVolume, static_cast<std::uint32_t>(index), volume, 0});
+}
+
+bool VolumeClient::setBalance(std::size_t index, int balance)
+{
+    return send(VolumeCommand{VolumeCommand::SetBalance, static_cast<std::uint32_t>(index), balance, 0});
+}
+
+bool VolumeClient::setMute(std::size_t index, bool mute, int fadeMs)
+{
+    return send(VolumeCommand{VolumeCommand::SetMute, static_cast<std::uint32_t>(index), mute ? 1 : 0, fadeMs});
+}
+
+bool VolumeClient::refresh()
+{
+    return send(VolumeCommand{VolumeCommand::Refresh, 0, 0, 0});
+}
+
+bool VolumeClient::post(const VolumeCommand &command)
+{
+    if (ring && ring->push(command))
+        return true;
+    return send(command);
+}
+
+/// @brief Send command and wait for the reply; connects to the server on first use.
+bool VolumeClient::send(const VolumeCommand &command)
+{
+    if (socketFd < 0)
+    {
+        sockaddr_un address;
+        if (!socketAddress(socketPath, address))
+            return false;
+        socketFd = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+        if (socketFd < 0)
+            return false;
+        if (::connect(socketFd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) != 0)
+        {
+            close(socketFd);
+            socketFd = -1;
+            return false;
+        }
+    }
+
+    std::int32_t status = -EIO;
+    if (::send(socketFd, &command, sizeof(command), MSG_NOSIGNAL) != sizeof(command) ||
+        recv(socketFd, &status, sizeof(status), 0) != sizeof(status))
+    {
+        close(socketFd);
+        socketFd = -1;
+        return false;
+    }
+    return status == 0;
+}
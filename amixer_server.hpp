@@ -0,0 +1,285 @@
+/*
+
+Copyright (c) 2025 Pawel Sklarow https://github.com/psklarow
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+of the Software, and to permit persons to whom the Software is furnished to do
+so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+ */
+
+ // Note: this code has been developed with AI assistance.
+
+/// @file amixer_server.hpp
+/// @brief Local volume server sharing mixer state with client processes.
+/// The server process owns the ALSA mixer. It publishes state of all channels in a shared memory
+/// segment, which clients read without any system call, and accepts write commands from clients
+/// over a Unix domain socket.
+
+#ifndef __AMIXER_SERVER_HPP__
+#define __AMIXER_SERVER_HPP__
+
+#include "amixer.hpp"
+#include "amixer_seqlock.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+/// @brief Layout of the shared memory segment published by VolumeServer.
+/// The channel list is written once before the segment is marked ready; volume, balance and
+/// mute state are protected by the sequence lock.
+struct SharedMixerState {
+    static constexpr std::uint32_t magicValue = 0x414d5852; // "AMXR"
+    static constexpr std::uint32_t versionValue = 1;
+    static constexpr std::size_t maxChannels = 256;
+    static constexpr std::size_t maxName = 64;
+
+    struct Channel {
+        char name[maxName];
+        std::int32_t card;
+        std::int32_t capture;
+        std::atomic<std::int32_t> volume;
+        std::atomic<std::int32_t> balance;
+        std::atomic<std::int32_t> muted;
+    };
+
+    std::atomic<std::uint32_t> magic;
+    std::uint32_t version;
+    std::uint32_t count;
+    SeqLock lock;
+    Channel channels[maxChannels];
+};
+
+/// @brief Command sent by clients to the server.
+struct VolumeCommand {
+    enum Op : std::uint32_t {
+        SetVolume = 1,  // value: volume 0..100
+        SetBalance = 2, // value: balance -100..100
+        SetMute = 3,    // value: 1 mute / 0 unmute, arg: fade in milliseconds
+        Refresh = 4,    // re-read all channels from hardware and publish them
+    };
+
+    std::uint32_t op;
+    std::uint32_t channel; // index into SharedMixerState::channels
+    std::int32_t value;
+    std::int32_t arg;
+};
+
+/// @brief Bounded multi-producer single-consumer ring of commands in shared memory.
+/// Client processes push commands without any system call; the server drains them in batches.
+/// The server sleeps on a futex only when the ring is empty, so a producer makes the wake-up system
+/// call only for the command which makes the ring non-empty while the server is asleep.
+/// Slots carry sequence numbers (bounded queue by D. Vyukov), so producers never see torn commands.
+///
+/// A producer records its pid in the slot before it claims the position, so a producer killed between
+/// claiming a slot and publishing its command does not block the ring: other producers take over slots
+/// claimed by dead processes, and the consumer skips them (skipAbandoned()). Liveness is checked with
+/// kill(pid, 0), so all producers must run in the pid namespace of the server.
+struct SharedCommandRing {
+    static constexpr std::uint32_t magicValue = 0x414d5844; // "AMXD", slots with owners
+    static constexpr std::size_t capacity = 1024;            // power of two
+
+    struct Slot {
+        std::atomic<std::uint64_t> sequence;
+        std::atomic<std::int32_t> owner; // pid of the producer claiming or filling the slot, 0 if none
+        VolumeCommand command;
+    };
+
+    std::atomic<std::uint32_t> magic;
+    alignas(64) std::atomic<std::uint64_t> head;     // next slot to be claimed by producers
+    alignas(64) std::atomic<std::uint64_t> tail;     // next slot to be consumed
+    alignas(64) std::atomic<std::uint32_t> waiting;  // futex word, 1 while the consumer sleeps
+    alignas(64) Slot slots[capacity];
+
+    /// @brief Initialize empty ring; called by the server only.
+    void init();
+
+    /// @brief Push command, waking the consumer if it sleeps.
+    /// @return false if the ring is full.
+    bool push(const VolumeCommand &command);
+
+    /// @brief Pop command; must be called by the single consumer only.
+    /// @return false if the ring is empty or the next command is not published yet.
+    bool pop(VolumeCommand &command);
+
+    /// @brief Check whether the next slot has been claimed by a producer but not published yet; consumer only.
+    bool stalled() const;
+
+    /// @brief Skip the next slot if its producer has died before publishing the command; consumer only.
+    /// @return true if the slot has been skipped.
+    bool skipAbandoned();
+
+    /// @brief Sleep until a command is pushed or wake() is called; consumer only.
+    /// @param timeout Maximum time to sleep
+    void wait(std::chrono::milliseconds timeout);
+
+    /// @brief Wake the sleeping consumer.
+    void wake();
+};
+
+/// @brief Default names of the shared memory segment and the command socket.
+inline constexpr const char *defaultSharedMemoryName = "/amixer";
+inline constexpr const char *defaultSocketPath = "/run/amixer.sock";
+
+/// @brief Volume server.
+/// Owns the mixer (normally IMixer::alsaInstance()), publishes its playback and capture channels in
+/// shared memory and applies commands received over a SOCK_SEQPACKET Unix domain socket,
+/// or pushed to the shared memory command ring (segment named sharedMemoryName + "-ring").
+/// The ring is drained by a separate thread in batches; within a batch only the last volume and
+/// balance command of each channel is applied, so bursts of slider moves cost a single write.
+/// State is published from the change listener of the mixer, which reports changes made through the
+/// library and by other programs (e.g. alsamixer), so unchanged channels are never read again.
+/// Socket commands also publish their channel before the reply, so the client reads its own change.
+class VolumeServer {
+public:
+    explicit VolumeServer(IMixer &mixer,
+                          std::string sharedMemoryName = defaultSharedMemoryName,
+                          std::string socketPath = defaultSocketPath);
+    ~VolumeServer();
+
+    VolumeServer(const VolumeServer &) = delete;
+    VolumeServer &operator=(const VolumeServer &) = delete;
+
+    /// @brief Create the shared memory segment and the socket, and publish initial state.
+    /// @return true on success, false on failure (errno is set).
+    bool start();
+
+    /// @brief Serve clients until stop() is called.
+    void run();
+
+    /// @brief Make run() return. May be called from any thread or a signal handler.
+    void stop();
+
+private:
+    /// @brief Link from the change listener to the server, cut when the server is destroyed.
+    struct Subscription {
+        std::mutex mutex;
+        VolumeServer *server{nullptr};
+    };
+
+    static constexpr auto ringPollInterval = std::chrono::milliseconds(500); // checks of a stalled ring
+
+    void publish(std::size_t index);
+    void publish(std::size_t index, int level, int balance, bool muted);
+    void publishAll();
+    void changed(const ChannelSnapshot &channel);
+    std::int32_t execute(const VolumeCommand &command);
+    std::int32_t apply(const VolumeCommand &command);
+    void drainRing();
+
+    std::string ringName() const { return sharedMemoryName + "-ring"; }
+
+    IMixer &mixer;
+    std::vector<std::shared_ptr<IVolume>> volumes;
+    std::map<const IVolume *, std::size_t> indexes; // index of each volume in volumes
+    std::string sharedMemoryName;
+    std::string socketPath;
+    std::shared_ptr<Subscription> subscription;
+    std::uint64_t listener{0};
+
+    SharedMixerState *state{nullptr};
+    SharedCommandRing *ring{nullptr};
+    std::mutex publishMutex; // publish() is called from the socket and the ring threads
+    std::thread ringThread;
+    std::atomic<bool> ringStopping{false};
+    int listenFd{-1};
+    int stopFd{-1};
+    std::vector<int> clients;
+};
+
+/// @brief Client of the volume server.
+/// Reads come straight from shared memory and cost no system call. Writes are either sent to the
+/// server over the socket and wait for its reply (set*), or pushed to the command ring without
+/// waiting (post*).
+class VolumeClient {
+public:
+    /// @brief Snapshot of one channel.
+    struct Channel {
+        std::string name;
+        int card;
+        bool capture;
+        int volume;
+        int balance;
+        bool muted;
+    };
+
+    explicit VolumeClient(std::string sharedMemoryName = defaultSharedMemoryName,
+                          std::string socketPath = defaultSocketPath);
+    ~VolumeClient();
+
+    VolumeClient(const VolumeClient &) = delete;
+    VolumeClient &operator=(const VolumeClient &) = delete;
+
+    /// @brief Map the shared memory segment published by the server.
+    /// @return true on success, false if the server is not running.
+    bool connect();
+
+    /// @brief Get number of channels published by the server.
+    std::size_t channelCount() const;
+
+    /// @brief Find channel by name and direction.
+    /// @return Channel index, or std::nullopt if not found.
+    std::optional<std::size_t> find(const std::string &name, bool capture = false) const;
+
+    /// @brief Read consistent state of one channel.
+    /// @param index Channel index (0..channelCount()-1)
+    Channel read(std::size_t index) const;
+
+    int getVolume(std::size_t index) const;
+    int getBalance(std::size_t index) const;
+    bool isMuted(std::size_t index) const;
+
+    /// @brief Send commands to the server.
+    /// @return true if the server accepted the command.
+    bool setVolume(std::size_t index, int volume);
+    bool setBalance(std::size_t index, int balance);
+    bool setMute(std::size_t index, bool mute, int fadeMs = 0);
+    bool refresh();
+
+    /// @brief Submit command through the shared memory command ring without waiting for the server.
+    /// Falls back to the socket if the ring is not available or full.
+    /// @return true if the command was queued (ring) or accepted (socket).
+    bool post(const VolumeCommand &command);
+
+    bool postVolume(std::size_t index, int volume) {
+        return post(VolumeCommand{VolumeCommand::SetVolume, static_cast<std::uint32_t>(index), volume, 0});
+    }
+    bool postBalance(std::size_t index, int balance) {
+        return post(VolumeCommand{VolumeCommand::SetBalance, static_cast<std::uint32_t>(index), balance, 0});
+    }
+    bool postMute(std::size_t index, bool mute, int fadeMs = 0) {
+        return post(VolumeCommand{VolumeCommand::SetMute, static_cast<std::uint32_t>(index), mute ? 1 : 0, fadeMs});
+    }
+
+private:
+    bool send(const VolumeCommand &command);
+
+    std::string sharedMemoryName;
+    std::string socketPath;
+    const SharedMixerState *state{nullptr};
+    SharedCommandRing *ring{nullptr};
+    int socketFd{-1};
+};
+
+#endif // __AMIXER_SERVER_HPP__
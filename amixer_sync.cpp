@@ -0,0 +1,263 @@
+/*
+
+Copyright (c) 2025 Pawel Sklarow https://github.com/psklarow
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+of the Software, and to permit persons to whom the Software is furnished to do
+so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+ */
+
+/// @file amixer_sync.cpp
+/// @brief Synchronized group fades implementation.
+///
+/// Note: this code has been developed with AI assistance.
+
+#include "amixer_sync.hpp"
+#include "amixer_balance.hpp"
+#include "amixer_probes.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <map>
+#include <mutex>
+
+/// @brief State shared by the group and its scheduled fade steps.
+/// Steps keep the state alive, so the group may be destroyed while a step is queued.
+struct SyncGroup::State {
+    std::atomic<std::uint64_t> generation{0};
+    mutable std::mutex mutex;
+    Skew skew;
+    bool fading{false};
+};
+
+/// @brief One fade of the group.
+struct SyncGroup::Fade {
+    /// @brief Members of the group on one card.
+    struct Part {
+        int card;
+        std::vector<std::size_t> members;
+        std::size_t reached{0}; // first grid point not written yet, used by the card thread only
+    };
+
+    /// @brief Earliest and latest member lateness measured for one grid point.
+    struct Step {
+        Clock::duration earliest{Clock::duration::max()};
+        Clock::duration latest{Clock::duration::min()};
+        std::size_t count{0};
+    };
+
+    std::uint64_t generation;
+    std::vector<int> targets;
+    Clock::time_point start;
+    Clock::duration interval;
+    std::size_t steps; // index of the last grid point
+    std::vector<std::shared_ptr<IVolume>> members;
+    std::vector<int> from;                   // read by the card thread of the member at its first step
+    std::vector<int> balances;               // given ones first, the others read with from
+    std::vector<std::vector<int>> positions; // ALSA channel positions of each member, read with from
+    std::size_t givenTargets{0};             // members with a given target, the others keep their volume
+    std::size_t givenBalances{0};
+    std::vector<Part> parts;
+
+    std::mutex mutex;
+    std::vector<Step> lateness;
+    std::size_t partsRunning;
+
+    Clock::time_point due(std::size_t index) const {
+        return start + interval * static_cast<Clock::duration::rep>(index);
+    }
+};
+
+SyncGroup::SyncGroup(std::vector<std::shared_ptr<IVolume>> members, Duration stepInterval)
+    : memberList(std::move(members)), stepInterval(std::max(stepInterval, Duration::zero())), state(std::make_shared<State>())
+{
+}
+
+SyncGroup::~SyncGroup()
+{
+    stop();
+}
+
+void SyncGroup::fadeTo(int volume, Duration duration, Clock::time_point start)
+{
+    std::vector<int> volumes(memberList.size(), volume);
+    fadeTo(volumes, duration, start);
+}
+
+void SyncGroup::fadeTo(std::span<const int> volumes, Duration duration, Clock::time_point start)
+{
+    fadeTo(volumes, {}, duration, start);
+}
+
+void SyncGroup::fadeTo(std::span<const int> volumes, std::span<const int> balances, Duration duration, Clock::time_point start)
+{
+    auto fade = std::make_shared<Fade>();
+    fade->generation = ++state->generation;
+    fade->givenTargets = std::min(volumes.size(), memberList.size());
+    fade->givenBalances = std::min(balances.size(), memberList.size());
+    for (std::size_t i = 0; i < fade->givenTargets; ++i)
+        fade->targets.push_back(std::clamp(volumes[i], 0, 100));
+    for (std::size_t i = 0; i < fade->givenBalances; ++i)
+        fade->balances.push_back(std::clamp(balances[i], -100, 100));
+    fade->targets.resize(memberList.size());
+    fade->balances.resize(memberList.size());
+    fade->from.resize(memberList.size());
+    fade->positions.resize(memberList.size());
+    fade->start = start;
+    fade->interval = stepInterval;
+    if (stepInterval == Duration::zero())
+    {
+        // all cards step on the same grid, so the slowest card sets the pace
+        fade->interval = Duration(1);
+        for (const auto &member : memberList)
+            fade->interval = std::max<Clock::duration>(fade->interval, ControlLatency::instance().resolve(member->getCard(), Duration::zero(), Duration(10)));
+    }
+    fade->steps = static_cast<std::size_t>(std::max<Duration::rep>(duration / fade->interval, 0));
+    fade->members = memberList;
+    fade->lateness.resize(fade->steps + 1);
+
+    std::map<int, std::size_t> partOfCard;
+    for (std::size_t i = 0; i < memberList.size(); ++i)
+    {
+        int card = memberList[i]->getCard();
+        auto [it, inserted] = partOfCard.try_emplace(card, fade->parts.size());
+        if (inserted)
+            fade->parts.push_back(Fade::Part{card, {}});
+        fade->parts[it->second].members.push_back(i);
+    }
+    fade->partsRunning = fade->parts.size();
+
+    {
+        std::lock_guard lock(state->mutex);
+        state->fading = !fade->parts.empty();
+    }
+
+    for (std::size_t part = 0; part < fade->parts.size(); ++part)
+    {
+        Scheduler::forCard(fade->parts[part].card).schedule(start, [state = state, fade, part] {
+            step(state, fade, part, 0);
+        });
+    }
+}
+
+/// @brief Write members of one card for one grid point and schedule the next grid point.
+/// The volume is computed from the grid point, not from the actual time, so all cards write the same
+/// value for the same grid point. When the card is late, the missed grid points are skipped; the write
+/// of this grid point is their write as well, so their lateness is measured from it.
+void SyncGroup::step(const std::shared_ptr<State> &state, const std::shared_ptr<Fade> &fade,
+                     std::size_t part, std::size_t index)
+{
+    if (state->generation != fade->generation)
+        return;
+
+    if (index == 0)
+    {
+        // the starting state is read here, so the caller of fadeTo() does not wait for the card
+        for (auto member : fade->parts[part].members)
+        {
+            auto &volume = *fade->members[member];
+            fade->from[member] = volume.getVolume();
+            if (member >= fade->givenTargets)
+                fade->targets[member] = fade->from[member];
+            if (member >= fade->givenBalances)
+                fade->balances[member] = appliedBalance(fade->from[member], volume.getBalance());
+            auto &positions = fade->positions[member];
+            positions.resize(volume.channelCount());
+            for (std::size_t channel = 0; channel < positions.size(); ++channel)
+                positions[channel] = volume.getChannelPosition(channel);
+        }
+    }
+
+    double progress = fade->steps == 0 ? 1.0 : static_cast<double>(index) / fade->steps;
+    auto &reached = fade->parts[part].reached;
+    for (auto member : fade->parts[part].members)
+    {
+        int from = fade->from[member];
+        int level = lround(from + (fade->targets[member] - from) * progress);
+        AMIXER_PROBE3(fade_step_volume, fade->parts[part].card, fade->members[member].get(), level);
+        fade->members[member]->setChannelVolumes(balancedLevels(fade->positions[member], level, fade->balances[member]));
+
+        auto written = Clock::now();
+        std::lock_guard lock(fade->mutex);
+        for (auto point = reached; point <= index; ++point)
+        {
+            auto late = written - fade->due(point);
+            auto &step = fade->lateness[point];
+            step.earliest = std::min(step.earliest, late);
+            step.latest = std::max(step.latest, late);
+            ++step.count;
+        }
+    }
+    reached = index + 1;
+
+    if (index < fade->steps)
+    {
+        auto behind = static_cast<std::size_t>((Clock::now() - fade->start) / fade->interval) + 1;
+        auto next = std::min(std::max(index + 1, behind), fade->steps);
+        Scheduler::forCard(fade->parts[part].card).schedule(fade->due(next), [state, fade, part, next] {
+            step(state, fade, part, next);
+        });
+        return;
+    }
+
+    std::lock_guard lock(fade->mutex);
+    if (--fade->partsRunning > 0)
+        return;
+
+    Skew skew;
+    Clock::duration total{};
+    for (const auto &step : fade->lateness)
+    {
+        if (step.count < 2)
+            continue;
+        auto stepSkew = step.latest - step.earliest;
+        skew.max = std::max(skew.max, stepSkew);
+        total += stepSkew;
+        ++skew.steps;
+    }
+    const auto &last = fade->lateness.back();
+    if (last.count >= 2)
+        skew.last = last.latest - last.earliest;
+    if (skew.steps > 0)
+        skew.mean = total / skew.steps;
+
+    std::lock_guard stateLock(state->mutex);
+    if (state->generation != fade->generation)
+        return;
+    state->skew = skew;
+    state->fading = false;
+}
+
+void SyncGroup::stop()
+{
+    ++state->generation;
+    std::lock_guard lock(state->mutex);
+    state->fading = false;
+}
+
+bool SyncGroup::isFading() const
+{
+    std::lock_guard lock(state->mutex);
+    return state->fading;
+}
+
+SyncGroup::Skew SyncGroup::skew() const
+{
+    std::lock_guard lock(state->mutex);
+    return state->skew;
+}
@@ -0,0 +1,141 @@
+/*
+
+Copyright (c) 2025 Pawel Sklarow https://github.com/psklarow
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+of the Software, and to permit persons to whom the Software is furnished to do
+so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+ */
+
+ // Note: this code has been developed with AI assistance.
+
+/// @file amixer_sync.hpp
+/// @brief Synchronized fades of volume channels spread over multiple sound cards.
+
+#ifndef __AMIXER_SYNC_HPP__
+#define __AMIXER_SYNC_HPP__
+
+#include "amixer.hpp"
+#include "amixer_scheduler.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <vector>
+
+/// @brief Group of volume channels faded together on a common timeline.
+/// All fade steps are planned on a grid of points in time on the monotonic clock, starting at a common
+/// deadline. Each card is written from its own card Scheduler thread, so cards are written in parallel
+/// and a slow (e.g. USB) card does not delay the others. A card which falls behind skips the grid points
+/// it has missed and continues at the current one, so it catches up instead of accumulating delay.
+/// Steps write all channels of a member at once with its balance kept, so fades do not wear the
+/// balance down by rounding. The starting volume and balance of each member are read by its card thread
+/// at the first step, so starting a fade does not wait for any card.
+///
+/// For every grid point the group measures how late each member was written; the difference between
+/// the latest member and the earliest one (the leader) is the inter-room skew, reported by skew().
+/// A member which skipped a grid point reached it only with its next write, which counts as its time.
+class SyncGroup {
+public:
+    using Clock = Scheduler::Clock;
+    using Duration = std::chrono::milliseconds;
+
+    /// @brief Skew measured during the last fade.
+    struct Skew {
+        Clock::duration last{};     // skew of the final step
+        Clock::duration max{};      // worst skew of all steps
+        Clock::duration mean{};     // average skew of all steps
+        std::size_t steps{0};       // number of steps the skew was measured on
+    };
+
+    /// @brief Constructor
+    /// @param members Volume channels of the group
+    /// @param stepInterval Interval between fade steps, zero for the interval suitable for the slowest card
+    ///                     of the group (ControlLatency::stepInterval()), chosen when a fade starts
+    explicit SyncGroup(std::vector<std::shared_ptr<IVolume>> members, Duration stepInterval = Duration::zero());
+
+    /// @brief Destructor
+    /// Stops the fade in progress.
+    ~SyncGroup();
+
+    SyncGroup(const SyncGroup &) = delete;
+    SyncGroup &operator=(const SyncGroup &) = delete;
+
+    const std::vector<std::shared_ptr<IVolume>> &members() const { return memberList; }
+
+    /// @brief Fade all members from their current volume to the target volume.
+    /// A new fade replaces the fade in progress, starting from the levels reached so far.
+    /// @param volume Target volume percentage (0..100)
+    /// @param duration Fade duration
+    /// @param start Common deadline on the monotonic clock at which the fade starts on all cards
+    void fadeTo(int volume, Duration duration, Clock::time_point start);
+
+    /// @brief Fade each member to its own target volume, e.g. keeping the offsets between members.
+    /// @param volumes Target volume percentage (0..100) of each member, in the order of members();
+    ///                missing entries keep the current volume
+    /// @param duration Fade duration
+    /// @param start Common deadline on the monotonic clock at which the fade starts on all cards
+    void fadeTo(std::span<const int> volumes, Duration duration, Clock::time_point start);
+
+    /// @brief Fade each member to its own target volume with the given balance.
+    /// @param volumes Target volume percentage (0..100) of each member; missing entries keep the current volume
+    /// @param balances Balance (-100..100, as setBalance() takes it) of each member; missing entries keep the current balance
+    /// @param duration Fade duration
+    /// @param start Common deadline on the monotonic clock at which the fade starts on all cards
+    void fadeTo(std::span<const int> volumes, std::span<const int> balances, Duration duration, Clock::time_point start);
+
+    /// @brief Fade all members to the target volume, starting shortly from now.
+    /// The short lead time lets all card threads pick up the first step at the same deadline.
+    void fadeTo(int volume, Duration duration) {
+        fadeTo(volume, duration, Clock::now() + leadTime);
+    }
+
+    /// @brief Fade each member to its own target volume, starting shortly from now.
+    void fadeTo(std::span<const int> volumes, Duration duration) {
+        fadeTo(volumes, duration, Clock::now() + leadTime);
+    }
+
+    /// @brief Fade each member to its own target volume and balance, starting shortly from now.
+    void fadeTo(std::span<const int> volumes, std::span<const int> balances, Duration duration) {
+        fadeTo(volumes, balances, duration, Clock::now() + leadTime);
+    }
+
+    /// @brief Stop the fade in progress, leaving members at their current levels.
+    void stop();
+
+    /// @brief Check whether a fade is in progress.
+    bool isFading() const;
+
+    /// @brief Get skew measured during the last fade.
+    Skew skew() const;
+
+private:
+    static constexpr auto leadTime = std::chrono::milliseconds(2);
+
+    struct Fade;
+    struct State;
+
+    static void step(const std::shared_ptr<State> &state, const std::shared_ptr<Fade> &fade,
+                     std::size_t part, std::size_t index);
+
+    std::vector<std::shared_ptr<IVolume>> memberList;
+    Duration stepInterval;
+    std::shared_ptr<State> state;
+};
+
+#endif // __AMIXER_SYNC_HPP__
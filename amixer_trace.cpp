@@ -0,0 +1,277 @@
+/*
+
+Copyright (c) 2025 Pawel Sklarow https://github.com/psklarow
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+of the Software, and to permit persons to whom the Software is furnished to do
+so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+ */
+
+/// @file amixer_trace.cpp
+/// @brief Trace recorder implementation.
+///
+/// Note: this code has been developed with AI assistance.
+
+#include "amixer_trace.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <format>
+#include <map>
+#include <set>
+
+#include <unistd.h>
+
+/// @brief Ring buffer of one thread; written only by that thread.
+struct Trace::Ring {
+    struct Slot {
+        std::atomic<std::uint64_t> sequence{0}; // 2 * event index + 2 when written, odd while being written
+        std::atomic<const char *> name{nullptr};
+        std::atomic<const char *> category{nullptr};
+        std::atomic<const char *> detail{nullptr};
+        std::atomic<std::int64_t> start{0};
+        std::atomic<std::int64_t> duration{0};
+        std::atomic<int> card{-1};
+        std::atomic<int> value{0};
+        std::atomic<int> thread{0}; // per slot, as a ring taken over from the free list keeps older events
+    };
+
+    int thread{static_cast<int>(gettid())}; // thread owning the ring
+    std::atomic<std::uint64_t> head{0}; // number of events recorded
+    std::atomic<std::uint64_t> tail{0}; // first event not dropped by clear()
+    std::array<Slot, ringSize> slots;
+};
+
+static_assert((Trace::ringSize & (Trace::ringSize - 1)) == 0, "ring size must be a power of two");
+
+/// @brief Live Trace instances by key.
+/// Leaked, as threads may exit and release their rings after static objects have been destroyed.
+struct LiveTraces {
+    std::mutex mutex;
+    std::map<std::uint64_t, Trace *> instances;
+    std::uint64_t lastKey{0};
+
+    static LiveTraces &get() {
+        static auto *live = new LiveTraces;
+        return *live;
+    }
+};
+
+/// @brief Rings of the calling thread, one per Trace instance; released to the free lists when the thread exits.
+struct Trace::ThreadRings {
+    struct Entry {
+        std::uint64_t key;
+        Ring *ring;
+    };
+    std::vector<Entry> entries;
+
+    ~ThreadRings() {
+        auto &live = LiveTraces::get();
+        std::lock_guard lock(live.mutex);
+        for (const auto &entry : entries)
+        {
+            if (auto it = live.instances.find(entry.key); it != live.instances.end())
+                it->second->release(entry.ring);
+        }
+    }
+};
+
+Trace::Trace()
+{
+    auto &live = LiveTraces::get();
+    std::lock_guard lock(live.mutex);
+    key = ++live.lastKey;
+    live.instances[key] = this;
+}
+
+Trace::~Trace()
+{
+    auto &live = LiveTraces::get();
+    std::lock_guard lock(live.mutex);
+    live.instances.erase(key);
+}
+
+Trace::Ring *Trace::ring()
+{
+    thread_local ThreadRings local;
+    for (const auto &entry : local.entries)
+    {
+        if (entry.key == key)
+            return entry.ring;
+    }
+
+    {
+        // forget rings of destroyed instances
+        auto &live = LiveTraces::get();
+        std::lock_guard lock(live.mutex);
+        std::erase_if(local.entries, [&](const ThreadRings::Entry &entry) { return !live.instances.contains(entry.key); });
+    }
+    std::lock_guard lock(mutex);
+    Ring *taken;
+    if (!freeRings.empty())
+    {
+        taken = freeRings.back();
+        freeRings.pop_back();
+        taken->thread = static_cast<int>(gettid());
+    }
+    else
+        taken = rings.emplace_back(std::make_unique<Ring>()).get();
+    local.entries.push_back(ThreadRings::Entry{key, taken});
+    return taken;
+}
+
+/// @brief Put the ring of an exiting thread on the free list; its events stay until they are overwritten.
+void Trace::release(Ring *ring)
+{
+    std::lock_guard lock(mutex);
+    freeRings.push_back(ring);
+}
+
+void Trace::record(const char *name, const char *category, Clock::time_point start, Clock::duration duration,
+                   int card, int value, const char *detail)
+{
+    if (!enabled())
+        return;
+    auto *r = ring();
+    auto index = r->head.load(std::memory_order_relaxed);
+    auto &slot = r->slots[index & (ringSize - 1)];
+    slot.sequence.store(2 * index + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.name.store(name, std::memory_order_relaxed);
+    slot.category.store(category, std::memory_order_relaxed);
+    slot.detail.store(detail, std::memory_order_relaxed);
+    slot.start.store(std::chrono::duration_cast<std::chrono::nanoseconds>(start.time_since_epoch()).count(),
+                     std::memory_order_relaxed);
+    slot.duration.store(std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count(), std::memory_order_relaxed);
+    slot.card.store(card, std::memory_order_relaxed);
+    slot.value.store(value, std::memory_order_relaxed);
+    slot.thread.store(r->thread, std::memory_order_relaxed);
+    slot.sequence.store(2 * index + 2, std::memory_order_release);
+    r->head.store(index + 1, std::memory_order_release);
+}
+
+std::vector<TraceEvent> Trace::collect() const
+{
+    std::vector<TraceEvent> events;
+    std::lock_guard lock(mutex);
+    for (const auto &r : rings)
+    {
+        auto head = r->head.load(std::memory_order_acquire);
+        auto first = std::max(r->tail.load(std::memory_order_relaxed), head > ringSize ? head - ringSize : 0);
+        for (auto index = first; index < head; ++index)
+        {
+            const auto &slot = r->slots[index & (ringSize - 1)];
+            auto sequence = slot.sequence.load(std::memory_order_acquire);
+            if (sequence != 2 * index + 2)
+                continue; // overwritten meanwhile
+            TraceEvent event{slot.name.load(std::memory_order_relaxed),
+                             slot.category.load(std::memory_order_relaxed),
+                             slot.detail.load(std::memory_order_relaxed),
+                             slot.start.load(std::memory_order_relaxed),
+                             slot.duration.load(std::memory_order_relaxed),
+                             slot.card.load(std::memory_order_relaxed),
+                             slot.value.load(std::memory_order_relaxed),
+                             slot.thread.load(std::memory_order_relaxed)};
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (slot.sequence.load(std::memory_order_relaxed) == sequence)
+                events.push_back(event);
+        }
+    }
+    std::ranges::sort(events, {}, &TraceEvent::start);
+    return events;
+}
+
+void Trace::clear()
+{
+    std::lock_guard lock(mutex);
+    for (auto &r : rings)
+        r->tail.store(r->head.load(std::memory_order_acquire), std::memory_order_relaxed);
+}
+
+/// @brief Escape string for JSON.
+static std::string escape(const char *text)
+{
+    std::string escaped;
+    for (; *text; ++text)
+    {
+        auto c = static_cast<unsigned char>(*text);
+        if (c == '"' || c == '\\')
+            escaped += '\\';
+        if (c < 0x20)
+            escaped += std::format("\\u{:04x}", c);
+        else
+            escaped += static_cast<char>(c);
+    }
+    return escaped;
+}
+
+std::string Trace::chromeJson() const
+{
+    auto events = collect();
+    std::string out = "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+    const char *separator = "\n";
+
+    // cards are shown as processes: pid 0 for events of no card, card + 1 otherwise
+    std::set<int> cards;
+    for (const auto &event : events)
+        cards.insert(event.card);
+    for (int card : cards)
+    {
+        auto name = card < 0 ? std::string("amixer") : std::format("card {}", card);
+        out += std::format("{}{{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":{},\"args\":{{\"name\":\"{}\"}}}}",
+                           separator, card + 1, name);
+        separator = ",\n";
+    }
+
+    for (const auto &event : events)
+    {
+        auto detail = event.detail ? std::format(",\"element\":\"{}\"", escape(event.detail)) : std::string();
+        if (event.duration > 0)
+            out += std::format("{}{{\"name\":\"{}\",\"cat\":\"{}\",\"ph\":\"X\",\"ts\":{:.3f},\"dur\":{:.3f},"
+                               "\"pid\":{},\"tid\":{},\"args\":{{\"value\":{}{}}}}}",
+                               separator, event.name, event.category, event.start / 1e3, event.duration / 1e3,
+                               event.card + 1, event.thread, event.value, detail);
+        else
+            out += std::format("{}{{\"name\":\"{}\",\"cat\":\"{}\",\"ph\":\"i\",\"s\":\"t\",\"ts\":{:.3f},"
+                               "\"pid\":{},\"tid\":{},\"args\":{{\"value\":{}{}}}}}",
+                               separator, event.name, event.category, event.start / 1e3,
+                               event.card + 1, event.thread, event.value, detail);
+        separator = ",\n";
+    }
+
+    out += "\n]}\n";
+    return out;
+}
+
+bool Trace::writeChromeJson(const std::string &path) const
+{
+    auto text = chromeJson();
+    std::FILE *file = std::fopen(path.c_str(), "w");
+    if (!file)
+        return false;
+    bool ok = std::fwrite(text.data(), 1, text.size(), file) == text.size();
+    return std::fclose(file) == 0 && ok;
+}
+
+/// @brief Get the library wide instance.
+/// @return Reference to the Trace instance.
+Trace &Trace::instance()
+{
+    static Trace trace;
+    return trace;
+}
@@ -0,0 +1,142 @@
+/*
+
+Copyright (c) 2025 Pawel Sklarow https://github.com/psklarow
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+of the Software, and to permit persons to whom the Software is furnished to do
+so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+ */
+
+ // Note: this code has been developed with AI assistance.
+
+/// @file amixer_trace.hpp
+/// @brief Timeline of mixer activity for Chrome trace viewer and Perfetto.
+
+#ifndef __AMIXER_TRACE_HPP__
+#define __AMIXER_TRACE_HPP__
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/// @brief One recorded event.
+struct TraceEvent {
+    const char *name;       // static string, e.g. "write"
+    const char *category;   // static string: "alsa", "enumeration", "event" or "scheduler"
+    const char *detail;     // element name or nullptr; must live as long as the mixer
+    std::int64_t start;     // nanoseconds on the monotonic clock
+    std::int64_t duration;  // nanoseconds, 0 for instant events
+    int card;               // ALSA card number, -1 if the event does not belong to a card
+    int value;              // event specific, e.g. ALSA result
+    int thread;             // kernel thread id of the recording thread
+};
+
+/// @brief Recorder of timestamped mixer events.
+/// Disabled by default; while disabled, recording costs one relaxed load. Every thread records into
+/// its own ring buffer without locks or read-modify-write operations; when the ring is full the oldest
+/// events are overwritten. Slots are guarded by sequence numbers, so collect() may run concurrently
+/// with recording and skips slots being overwritten. The ring of an exited thread goes to a free list
+/// and is taken over by the next new thread, keeping the older events, so the number of rings is
+/// bounded by the number of threads recording at the same time.
+///
+/// The library records ALSA reads and writes, card enumeration, ALSA event dispatch and element
+/// events, and the time scheduler tasks waited past their due time. Applications may record their
+/// own events (e.g. scene changes) the same way.
+class Trace {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    static constexpr std::size_t ringSize = 8192; // events per thread, power of two
+
+    /// @brief Records the duration of a scope as one event.
+    class Scope {
+    public:
+        Scope(const char *name, const char *category, int card, const char *detail = nullptr,
+              Trace &trace = Trace::instance())
+            : trace(trace), name(name), category(category), detail(detail), card(card),
+              start(trace.enabled() ? Clock::now() : Clock::time_point()) {}
+        ~Scope() {
+            if (start != Clock::time_point())
+                trace.record(name, category, start, Clock::now() - start, card, value, detail);
+        }
+
+        Scope(const Scope &) = delete;
+        Scope &operator=(const Scope &) = delete;
+
+        /// @brief Set value recorded with the event, e.g. result of the call.
+        void setValue(int v) { value = v; }
+
+    private:
+        Trace &trace;
+        const char *name;
+        const char *category;
+        const char *detail;
+        int card;
+        int value{0};
+        Clock::time_point start;
+    };
+
+    Trace();
+    ~Trace();
+
+    Trace(const Trace &) = delete;
+    Trace &operator=(const Trace &) = delete;
+
+    void enable(bool on) { active.store(on, std::memory_order_relaxed); }
+    bool enabled() const { return active.load(std::memory_order_relaxed); }
+
+    /// @brief Record an event if tracing is enabled.
+    /// @param duration Duration of the event, zero for an instant event
+    void record(const char *name, const char *category, Clock::time_point start, Clock::duration duration,
+                int card, int value = 0, const char *detail = nullptr);
+
+    /// @brief Get events buffered by all threads, ordered by start time.
+    std::vector<TraceEvent> collect() const;
+
+    /// @brief Drop all buffered events.
+    void clear();
+
+    /// @brief Render buffered events as Chrome trace JSON (also opened by ui.perfetto.dev).
+    /// Every card is shown as a process, with one track per recording thread.
+    std::string chromeJson() const;
+
+    /// @brief Write chromeJson() to a file.
+    /// @return false on failure (errno is set).
+    bool writeChromeJson(const std::string &path) const;
+
+    /// @brief Get the library wide instance.
+    static Trace &instance();
+
+private:
+    struct Ring;
+    struct ThreadRings;
+
+    Ring *ring();
+    void release(Ring *ring);
+
+    std::atomic<bool> active{false};
+    mutable std::mutex mutex;
+    std::uint64_t key; // identifies the instance in thread caches, never reused
+    std::vector<std::unique_ptr<Ring>> rings;
+    std::vector<Ring *> freeRings; // rings of exited threads
+};
+
+#endif // __AMIXER_TRACE_HPP__
@@ -0,0 +1,112 @@
+/*
+
+Copyright (c) 2025 Pawel Sklarow https://github.com/psklarow
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+of the Software, and to permit persons to whom the Software is furnished to do
+so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+ */
+
+/// @file amixerd.cpp
+/// @brief Volume server daemon.
+/// Owns the ALSA mixer and serves it to client processes through VolumeServer.
+/// Usage: amixerd [shared-memory-name [socket-path [state-file [metrics-socket]]]]
+/// With a state file, the saved mixer state is restored on start and changes are saved behind.
+/// With a metrics socket, metrics in Prometheus text format are served on it.
+/// With AMIXER_RECORD set to a file path, all mixer calls are recorded for amixer_replay.
+///
+/// Note: this code has been developed with AI assistance.
+///
+/// To build use e.g.:
+///     c++ -std=c++23 amixerd.cpp amixer.cpp amixer_balance.cpp amixer_scheduler.cpp amixer_metrics.cpp amixer_trace.cpp amixer_server.cpp amixer_persist.cpp amixer_prometheus.cpp amixer_record.cpp -o amixerd -lasound -Wall -Wextra -Wpedantic -Werror
+
+#include "amixer_server.hpp"
+#include "amixer_persist.hpp"
+#include "amixer_prometheus.hpp"
+#include "amixer_record.hpp"
+#include <memory>
+#include <print>
+#include <csignal>
+#include <cstring>
+#include <cerrno>
+#include <cstdlib>
+#include <thread>
+
+static VolumeServer *server = nullptr;
+static PrometheusExporter *exporter = nullptr;
+
+static void onSignal(int)
+{
+    if (server)
+        server->stop();
+    if (exporter)
+        exporter->stop();
+}
+
+int main(int argc, char *argv[])
+{
+    IMixer *mixer = &IMixer::alsaInstance();
+    std::unique_ptr<RecordingMixer> recorder;
+    if (const char *record = std::getenv("AMIXER_RECORD")) {
+        recorder = std::make_unique<RecordingMixer>(*mixer, record);
+        if (recorder->isOpen())
+            mixer = recorder.get();
+        else
+            std::println(stderr, "amixerd: cannot record to {}: {}", record, std::strerror(errno));
+    }
+
+    std::unique_ptr<StatePersistence> persistence;
+    if (argc > 3) {
+        persistence = std::make_unique<StatePersistence>(*mixer, argv[3]);
+        if (persistence->restore() < 0)
+            std::println(stderr, "amixerd: no saved state in {}", argv[3]);
+    }
+
+    VolumeServer volumeServer(*mixer,
+        argc > 1 ? argv[1] : defaultSharedMemoryName,
+        argc > 2 ? argv[2] : defaultSocketPath);
+
+    if (!volumeServer.start()) {
+        std::println(stderr, "amixerd: cannot start server: {}", std::strerror(errno));
+        return 1;
+    }
+
+    std::unique_ptr<PrometheusExporter> metrics;
+    std::thread metricsThread;
+    if (argc > 4) {
+        metrics = std::make_unique<PrometheusExporter>(*mixer, argv[4]);
+        if (metrics->start()) {
+            exporter = metrics.get();
+            metricsThread = std::thread([&metrics] { metrics->run(); });
+        } else {
+            std::println(stderr, "amixerd: cannot serve metrics on {}: {}", argv[4], std::strerror(errno));
+        }
+    }
+
+    server = &volumeServer;
+    std::signal(SIGINT, onSignal);
+    std::signal(SIGTERM, onSignal);
+
+    volumeServer.run();
+    server = nullptr;
+    if (metricsThread.joinable()) {
+        metrics->stop();
+        metricsThread.join();
+    }
+    exporter = nullptr;
+    return 0;
+}
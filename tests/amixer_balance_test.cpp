@@ -0,0 +1,139 @@
+/*
+
+Copyright (c) 2025 Pawel Sklarow https://github.com/psklarow
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+of the Software, and to permit persons to whom the Software is furnished to do
+so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+ */
+
+/// @file amixer_balance_test.cpp
+/// @brief Checks of per-channel levels for volume and balance (amixer_balance).
+/// Setting only the volume again and again, as a volume knob does, must keep the balance instead of
+/// pulling it towards the center, also with levels rounded to hardware steps and through volume 0.
+///
+/// Note: this code has been developed with AI assistance.
+///
+/// To build and run from the repository root use e.g.:
+///     c++ -std=c++23 -I. tests/amixer_balance_test.cpp amixer_balance.cpp amixer_fake.cpp amixer_scheduler.cpp amixer_metrics.cpp amixer_trace.cpp -o amixer_balance_test -Wall -Wextra -Wpedantic -Werror && ./amixer_balance_test
+
+#include "tests/amixer_test.hpp"
+#include "amixer_balance.hpp"
+#include "amixer_fake.hpp"
+#include <functional>
+#include <vector>
+
+/// @brief Element written the way the volumes write it: balance kept by keptBalance(), levels rounded by the hardware.
+struct Element {
+    std::vector<int> positions;
+    std::function<int(int)> quantize = [](int level) { return level; };
+    std::vector<int> levels = std::vector<int>(positions.size(), 0);
+    BalanceSetting setting{};
+
+    void apply(int volume, int balance) {
+        levels = balancedLevels(positions, volume, balance);
+        for (auto &level : levels)
+            level = quantize(level);
+        setting = {balance, levels};
+    }
+    void setVolume(int volume) { apply(volume, keptBalance(positions, levels, setting)); }
+};
+
+/// @brief Levels, conversion of the reported balance and the quieter side.
+static void levels()
+{
+    const std::vector<int> stereo{0, 1};
+    CHECK((balancedLevels(stereo, 50, -50) == std::vector<int>{50, 25}));
+    CHECK((balancedLevels(stereo, 80, 25) == std::vector<int>{60, 80}));
+    CHECK((balancedLevels(std::vector<int>{0, 1, 2, 3, 4, 5}, 40, -50) == std::vector<int>{40, 20, 40, 20, 40, 40}));
+    CHECK((balancedLevels(std::vector<int>{3}, 40, -50) == std::vector<int>{40}));
+
+    CHECK(appliedBalance(50, -25) == -50);
+    CHECK(appliedBalance(60, 24) == 40);
+    CHECK(appliedBalance(0, 0) == 0);
+    CHECK(appliedBalance(10, -90) == -100);
+}
+
+/// @brief Volume set repeatedly keeps the balance.
+static void volumeKeepsBalance()
+{
+    Element element{{0, 1}};
+    element.apply(50, -50);
+    for (int i = 0; i < 4; ++i)
+        element.setVolume(50);
+    CHECK((element.levels == std::vector<int>{50, 25}));
+
+    element.setVolume(0);
+    element.setVolume(80);
+    CHECK((element.levels == std::vector<int>{80, 40}));
+}
+
+/// @brief Levels rounded to 10% steps: the balance setting survives a move down and up again.
+static void quantizedKeepsBalance()
+{
+    Element element{{0, 1}, [](int level) { return (level + 5) / 10 * 10; }};
+    element.apply(60, 30);
+    CHECK((element.levels == std::vector<int>{40, 60}));
+    for (int volume : {30, 10, 0, 30, 60})
+        element.setVolume(volume);
+    CHECK((element.levels == std::vector<int>{40, 60}));
+}
+
+/// @brief Levels changed by other means than the volume: the balance follows them.
+static void changedLevelsGiveBalance()
+{
+    const std::vector<int> stereo{0, 1};
+    BalanceSetting setting{-50, {50, 25}};
+    CHECK(keptBalance(stereo, std::vector<int>{40, 80}, setting) == 50);
+    CHECK(keptBalance(stereo, std::vector<int>{0, 0}, setting) == 0);
+    CHECK(keptBalance(std::vector<int>{3}, std::vector<int>{70}, {}) == 0);
+}
+
+/// @brief FakeVolume keeps the balance as the ALSA volume does, also while muted without a switch.
+static void fakeVolumeKeepsBalance()
+{
+    FakeChannel noSwitch{0, "Headphone"};
+    noSwitch.hasSwitch = false;
+    FakeMixer mixer({FakeChannel{0, "Speaker"}, noSwitch});
+    int levels[2];
+    for (const auto &volume : mixer.channels()) {
+        volume->setVolume(50);
+        volume->setBalance(-50);
+        for (int i = 0; i < 4; ++i)
+            volume->setVolume(50);
+        volume->getChannelVolumes(levels);
+        CHECK(levels[0] == 50 && levels[1] == 25);
+
+        volume->setMute(true);
+        volume->setVolume(0);
+        volume->setVolume(80);
+        volume->setMute(false);
+        volume->getChannelVolumes(levels);
+        CHECK(levels[0] == 80 && levels[1] == 40);
+        CHECK(volume->getBalance() == -40);
+    }
+}
+
+int main()
+{
+    levels();
+    volumeKeepsBalance();
+    quantizedKeepsBalance();
+    changedLevelsGiveBalance();
+    fakeVolumeKeepsBalance();
+    return testResult("amixer_balance_test");
+}
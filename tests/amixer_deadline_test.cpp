@@ -0,0 +1,128 @@
+/*
+
+Copyright (c) 2025 Pawel Sklarow https://github.com/psklarow
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+of the Software, and to permit persons to whom the Software is furnished to do
+so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+ */
+
+/// @file amixer_deadline_test.cpp
+/// @brief DeadlineCaller against FakeMixer cards which are slow or held busy.
+/// A call waits no longer than its deadline and still lands later, while a call not started yet is
+/// skipped once a newer call for the same channel is made, so the latest value always wins.
+///
+/// Note: this code has been developed with AI assistance.
+///
+/// To build and run from the repository root use e.g.:
+///     c++ -std=c++23 -I. tests/amixer_deadline_test.cpp amixer_deadline.cpp amixer_fake.cpp amixer_balance.cpp amixer_scheduler.cpp amixer_metrics.cpp amixer_trace.cpp -o amixer_deadline_test -Wall -Wextra -Wpedantic -Werror && ./amixer_deadline_test
+
+#include "tests/amixer_test.hpp"
+#include "amixer_deadline.hpp"
+#include "amixer_fake.hpp"
+#include <future>
+#include <memory>
+#include <vector>
+
+using namespace std::chrono_literals;
+
+/// @brief Keep a card thread busy until the returned promise is set.
+static std::promise<void> holdCard(int card)
+{
+    std::promise<void> release;
+    Scheduler::forCard(card).post([released = release.get_future().share()] { released.wait(); });
+    return release;
+}
+
+/// @brief A write to a slow card returns at its deadline and lands afterwards.
+static void timeoutThenLands()
+{
+    FakeChannel slow{0, "Slow"};
+    slow.writeLatency = 50ms;
+    FakeMixer mixer({slow});
+    auto volume = mixer.channels().front();
+    DeadlineCaller caller;
+
+    auto start = std::chrono::steady_clock::now();
+    CHECK(caller.setVolume(volume, 30, 5ms).status == CallStatus::Timeout);
+    CHECK(std::chrono::steady_clock::now() - start < 40ms);
+    CHECK(eventually([&] { return volume->getVolume() == 30; }));
+
+    CHECK(caller.setVolume(volume, 40, 1s).status == CallStatus::Ok);
+    auto read = caller.getVolume(volume, 1s);
+    CHECK(read.status == CallStatus::Ok);
+    CHECK(read.value == 40);
+}
+
+/// @brief Calls queued behind a busy card are skipped for the newest call of their kind.
+static void newestCallWins()
+{
+    FakeMixer mixer({FakeChannel{0, "Busy"}});
+    auto volume = mixer.channels().front();
+    volume->setVolume(10);
+    DeadlineCaller caller;
+
+    auto release = holdCard(0);
+    CHECK(caller.getVolume(volume, 5ms).status == CallStatus::Timeout);
+    auto older = std::async(std::launch::async, [&] { return caller.setVolume(volume, 20, 2s); });
+    std::this_thread::sleep_for(20ms); // let the older write be queued first
+    auto newer = std::async(std::launch::async, [&] { return caller.setVolume(volume, 30, 2s); });
+    auto read = std::async(std::launch::async, [&] { return caller.getVolume(volume, 2s); });
+    std::this_thread::sleep_for(20ms);
+    release.set_value();
+
+    CHECK(older.get().status == CallStatus::Superseded);
+    CHECK(newer.get().status == CallStatus::Ok);
+    auto value = read.get();
+    CHECK(value.status == CallStatus::Ok);
+    CHECK(value.value == 30);
+    CHECK(volume->getVolume() == 30);
+}
+
+/// @brief A batch waits only for its deadline, and writes superseded by later calls count as done.
+static void commitAcrossCards()
+{
+    FakeChannel slow{1, "Slow"};
+    slow.writeLatency = 50ms;
+    FakeMixer mixer({FakeChannel{0, "Fast"}, slow});
+    std::vector<std::shared_ptr<IVolume>> v(mixer.channels().begin(), mixer.channels().end());
+    DeadlineCaller caller;
+
+    std::vector<VolumeLevel> levels{{v[0], 25}, {v[1], 35}};
+    CHECK(caller.commit(levels, 10ms) == CallStatus::Timeout);
+    CHECK(eventually([&] { return v[0]->getVolume() == 25 && v[1]->getVolume() == 35; }));
+
+    auto release = holdCard(0);
+    std::vector<VolumeLevel> stale{{v[0], 45}};
+    auto batch = std::async(std::launch::async, [&] { return caller.commit(stale, 2s); });
+    std::this_thread::sleep_for(20ms);
+    auto single = std::async(std::launch::async, [&] { return caller.setVolume(v[0], 55, 2s); });
+    std::this_thread::sleep_for(20ms);
+    release.set_value();
+
+    CHECK(batch.get() == CallStatus::Ok);
+    CHECK(single.get().status == CallStatus::Ok);
+    CHECK(v[0]->getVolume() == 55);
+}
+
+int main()
+{
+    timeoutThenLands();
+    newestCallWins();
+    commitAcrossCards();
+    return testResult("amixer_deadline_test");
+}
@@ -0,0 +1,151 @@
+/*
+
+Copyright (c) 2025 Pawel Sklarow https://github.com/psklarow
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+of the Software, and to permit persons to whom the Software is furnished to do
+so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+ */
+
+/// @file amixer_ducking_test.cpp
+/// @brief Checks of the Ducker engine on FakeMixer.
+/// Overlapping ducks settle on the depth of the highest priority one and, once all are released,
+/// return each channel to the volume and balance it had before, even if it was changed meanwhile.
+/// duck() must return at once when a card is slow, and the ramps of a fast card must not wait for it.
+///
+/// Note: this code has been developed with AI assistance.
+///
+/// To build and run from the repository root use e.g.:
+///     c++ -std=c++23 -I. tests/amixer_ducking_test.cpp amixer_ducking.cpp amixer_fake.cpp amixer_balance.cpp amixer_scheduler.cpp amixer_metrics.cpp amixer_trace.cpp -o amixer_ducking_test -Wall -Wextra -Wpedantic -Werror && ./amixer_ducking_test
+
+#include "tests/amixer_test.hpp"
+#include "amixer_ducking.hpp"
+#include "amixer_fake.hpp"
+#include <memory>
+#include <vector>
+
+using namespace std::chrono_literals;
+
+/// @brief Get the per-channel levels of a volume.
+static std::vector<int> levelsOf(const std::shared_ptr<IVolume> &volume)
+{
+    std::vector<int> levels(volume->channelCount());
+    volume->getChannelVolumes(levels);
+    return levels;
+}
+
+/// @brief A stereo channel is ducked on both sides and gets its levels and balance back.
+static void duckAndRestore()
+{
+    FakeMixer mixer({FakeChannel{0, "Music"}});
+    auto music = mixer.channels().front();
+    music->setVolume(80);
+    music->setBalance(-50);
+    auto before = levelsOf(music);
+    Ducker ducker(mixer);
+
+    DuckTarget targets[] = {{music, 20.0}};
+    auto id = ducker.duck(targets, 0, 10ms, 10ms);
+    CHECK(ducker.isDucked(music));
+    std::vector<int> ducked{music->volumeForGain(before[0], -20.0), music->volumeForGain(before[1], -20.0)};
+    CHECK(eventually([&] { return levelsOf(music) == ducked; }));
+
+    music->setVolume(30); // changed while ducked, the pre-duck state still wins
+    ducker.release(id);
+    CHECK(!ducker.isDucked(music));
+    CHECK(eventually([&] { return levelsOf(music) == before; }));
+}
+
+/// @brief The highest priority duck sets the depth, also when it is the shallower one.
+static void priorities()
+{
+    FakeMixer mixer({FakeChannel{0, "Kitchen", false, 1}});
+    auto kitchen = mixer.channels().front();
+    kitchen->setVolume(70);
+    Ducker ducker(mixer);
+    DuckTarget deep[] = {{kitchen, 30.0}};
+    DuckTarget shallow[] = {{kitchen, 6.0}};
+
+    auto doorbell = ducker.duck(deep, 1, 0ms, 0ms);
+    CHECK(eventually([&] { return kitchen->getVolume() == kitchen->volumeForGain(70, -30.0); }));
+    auto announcement = ducker.duck(shallow, 5, 0ms, 0ms);
+    CHECK(eventually([&] { return kitchen->getVolume() == kitchen->volumeForGain(70, -6.0); }));
+    auto nested = ducker.duck(deep, 5, 0ms, 0ms); // same priority: the deeper one wins
+    CHECK(eventually([&] { return kitchen->getVolume() == kitchen->volumeForGain(70, -30.0); }));
+
+    ducker.release(nested);
+    CHECK(eventually([&] { return kitchen->getVolume() == kitchen->volumeForGain(70, -6.0); }));
+    ducker.release(announcement);
+    CHECK(eventually([&] { return kitchen->getVolume() == kitchen->volumeForGain(70, -30.0); }));
+    CHECK(ducker.isDucked(kitchen));
+    ducker.release(doorbell);
+    CHECK(eventually([&] { return kitchen->getVolume() == 70; }));
+    CHECK(!ducker.isDucked(kitchen));
+}
+
+/// @brief duck() does not wait for a slow card, which does not hold up the ramp of a fast one.
+static void slowCard()
+{
+    FakeChannel slow{1, "Garden", false, 1};
+    slow.readLatency = slow.writeLatency = 40ms;
+    FakeMixer mixer({FakeChannel{0, "Hall", false, 1}, slow});
+    auto hall = mixer.channels().front();
+    auto garden = mixer.channels().back();
+    hall->setVolume(60);
+    garden->setVolume(60);
+    Ducker ducker(mixer);
+
+    DuckTarget targets[] = {{hall, 12.0}, {garden, 12.0}};
+    auto start = std::chrono::steady_clock::now();
+    auto id = ducker.duck(targets, 0, 100ms, 0ms);
+    CHECK(std::chrono::steady_clock::now() - start < 20ms);
+    CHECK(eventually([&] { return hall->getVolume() == hall->volumeForGain(60, -12.0); }, 150ms));
+    CHECK(eventually([&] { return garden->getVolume() == garden->volumeForGain(60, -12.0); }));
+
+    start = std::chrono::steady_clock::now();
+    ducker.release(id);
+    CHECK(std::chrono::steady_clock::now() - start < 20ms);
+    CHECK(eventually([&] { return hall->getVolume() == 60 && garden->getVolume() == 60; }));
+}
+
+/// @brief Channels of another mixer are skipped; destruction waits for a ramp in progress.
+static void foreignChannelAndDestruction()
+{
+    FakeMixer mixer({FakeChannel{0, "Bath", false, 1}});
+    FakeMixer other({FakeChannel{0, "Other", false, 1}});
+    auto bath = mixer.channels().front();
+    auto foreign = other.channels().front();
+    bath->setVolume(50);
+    foreign->setVolume(50);
+    {
+        Ducker ducker(mixer);
+        DuckTarget targets[] = {{bath, 10.0}, {foreign, 10.0}};
+        ducker.duck(targets, 0, 1s, 1s);
+        CHECK(ducker.isDucked(bath));
+        CHECK(!ducker.isDucked(foreign));
+    }
+    CHECK(foreign->getVolume() == 50);
+}
+
+int main()
+{
+    duckAndRestore();
+    priorities();
+    slowCard();
+    foreignChannelAndDestruction();
+    return testResult("amixer_ducking_test");
+}
@@ -0,0 +1,123 @@
+/*
+
+Copyright (c) 2025 Pawel Sklarow https://github.com/psklarow
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+of the Software, and to permit persons to whom the Software is furnished to do
+so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+ */
+
+/// @file amixer_execution_test.cpp
+/// @brief Checks of the sender adaptors (amixer_execution.hpp) on FakeMixer with stdexec::sync_wait().
+/// Every sender of the header is connected and waited for here, so building the test type-checks the
+/// adaptors against stdexec.
+///
+/// Note: this code has been developed with AI assistance.
+///
+/// To build and run from the repository root use e.g. (STDEXEC is a checkout of https://github.com/NVIDIA/stdexec):
+///     c++ -std=c++23 -I. -I$STDEXEC/include tests/amixer_execution_test.cpp amixer_fake.cpp amixer_balance.cpp amixer_scheduler.cpp amixer_metrics.cpp amixer_trace.cpp -o amixer_execution_test -Wall -Wextra -Wpedantic -Werror && ./amixer_execution_test
+
+#include "tests/amixer_test.hpp"
+#include "amixer_fake.hpp"
+#include "amixer_execution.hpp"
+#include <chrono>
+#include <thread>
+
+using namespace std::chrono_literals;
+
+/// @brief MixerScheduler runs continuations on the card and event threads.
+static void schedulers()
+{
+    auto onCard = stdexec::sync_wait(stdexec::then(stdexec::schedule(MixerScheduler::forCard(1)),
+                                                   [] { return Scheduler::forCard(1).isSchedulerThread(); }));
+    CHECK(onCard && std::get<0>(*onCard));
+    auto onEvents = stdexec::sync_wait(stdexec::then(stdexec::schedule(MixerScheduler::events()),
+                                                     [] { return Scheduler::instance().isSchedulerThread(); }));
+    CHECK(onEvents && std::get<0>(*onEvents));
+    CHECK(MixerScheduler::forCard(1) == MixerScheduler::forCard(1));
+    CHECK(!(MixerScheduler::forCard(1) == MixerScheduler::events()));
+}
+
+/// @brief Single and batched volume writes, and a read.
+static void volumes()
+{
+    FakeMixer mixer({FakeChannel{0, "Speaker"}, FakeChannel{1, "Sub", false, 1}});
+    auto speaker = mixer.channels().front();
+    auto sub = mixer.channels().back();
+
+    CHECK(stdexec::sync_wait(setVolumeSender(speaker, 40)));
+    CHECK(speaker->getVolume() == 40);
+    auto level = stdexec::sync_wait(getVolumeSender(speaker));
+    CHECK(level && std::get<0>(*level) == 40);
+    level = stdexec::sync_wait(getVolumeSender(MixerScheduler::events(), speaker));
+    CHECK(level && std::get<0>(*level) == 40);
+
+    CHECK(stdexec::sync_wait(setVolumesSender({{speaker, 25}, {sub, 75}})));
+    CHECK(speaker->getVolume() == 25 && sub->getVolume() == 75);
+    CHECK(stdexec::sync_wait(setVolumesSender({})));
+
+    CHECK(stdexec::sync_wait(stdexec::when_all(setVolumeSender(speaker, 10), setVolumeSender(sub, 90))));
+    CHECK(speaker->getVolume() == 10 && sub->getVolume() == 90);
+}
+
+/// @brief Fade reaches its target keeping the balance, also when run together with another write.
+static void fades()
+{
+    FakeMixer mixer({FakeChannel{0, "Speaker"}, FakeChannel{1, "Sub", false, 1}});
+    auto speaker = mixer.channels().front();
+    auto sub = mixer.channels().back();
+    speaker->setVolume(40);
+    speaker->setBalance(-50);
+
+    auto start = Scheduler::Clock::now();
+    CHECK(stdexec::sync_wait(stdexec::when_all(fadeSender(speaker, 80, 100ms, 10ms), setVolumeSender(sub, 30))));
+    CHECK(Scheduler::Clock::now() - start >= 90ms);
+    int levels[2];
+    speaker->getChannelVolumes(levels);
+    CHECK(levels[0] == 80 && levels[1] == 40);
+    CHECK(sub->getVolume() == 30);
+
+    CHECK(stdexec::sync_wait(fadeSender(sub, 0, 0ms)));
+    CHECK(sub->getVolume() == 0);
+}
+
+/// @brief Change sender completes at once when the state already holds, otherwise on the change event.
+static void changes()
+{
+    FakeMixer mixer({FakeChannel{0, "Speaker"}});
+    auto speaker = mixer.channels().front();
+    speaker->setVolume(20);
+
+    auto now = stdexec::sync_wait(changeSender(mixer, speaker, [](const ChannelSnapshot &c) { return c.volumeLevel == 20; }));
+    CHECK(now && std::get<0>(*now).volumeLevel == 20);
+
+    std::jthread writer([&] {
+        std::this_thread::sleep_for(20ms);
+        speaker->setVolume(55);
+    });
+    auto later = stdexec::sync_wait(changeSender(mixer, speaker, [](const ChannelSnapshot &c) { return c.volumeLevel == 55; }));
+    CHECK(later && std::get<0>(*later).volume == speaker);
+}
+
+int main()
+{
+    schedulers();
+    volumes();
+    fades();
+    changes();
+    return testResult("amixer_execution_test");
+}
@@ -0,0 +1,175 @@
+/*
+
+Copyright (c) 2025 Pawel Sklarow https://github.com/psklarow
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+of the Software, and to permit persons to whom the Software is furnished to do
+so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+ */
+
+/// @file amixer_group_test.cpp
+/// @brief Checks of nested channel groups (ChannelGroup) on FakeMixer.
+/// A house of rooms on two floors is turned down to silence and up again: each room must come back
+/// with its own offset and balance, even where levels were clamped at zero or rounded to hardware
+/// steps. Fades must not wait for a slow card, and group calls from card threads must not deadlock.
+///
+/// Note: this code has been developed with AI assistance.
+///
+/// To build and run from the repository root use e.g.:
+///     c++ -std=c++23 -I. tests/amixer_group_test.cpp amixer_group.cpp amixer_sync.cpp amixer_fake.cpp amixer_balance.cpp amixer_scheduler.cpp amixer_metrics.cpp amixer_trace.cpp -o amixer_group_test -Wall -Wextra -Wpedantic -Werror && ./amixer_group_test
+
+#include "tests/amixer_test.hpp"
+#include "amixer_fake.hpp"
+#include "amixer_group.hpp"
+#include <future>
+#include <memory>
+#include <string>
+#include <vector>
+
+/// @brief Check levels of the volumes once the group writes have landed.
+static bool levelsAre(const std::vector<std::shared_ptr<IVolume>> &volumes, const std::vector<int> &expected)
+{
+    return eventually([&] {
+        for (std::size_t i = 0; i < volumes.size(); ++i) {
+            if (volumes[i]->getVolume() != expected[i])
+                return false;
+        }
+        return true;
+    });
+}
+
+/// @brief Rooms on two floors: offsets survive moving the whole house down to zero and back.
+static void nestedRoundTrip()
+{
+    std::vector<FakeChannel> rooms;
+    for (int i = 0; i < 4; ++i) {
+        FakeChannel room{i / 2, "Room" + std::to_string(i)};
+        room.dbMin = room.dbMax = 0; // linear, unquantized levels
+        rooms.push_back(room);
+    }
+    FakeMixer mixer(rooms);
+    std::vector<std::shared_ptr<IVolume>> v(mixer.channels().begin(), mixer.channels().end());
+    for (std::size_t i = 0; i < v.size(); ++i)
+        v[i]->setVolume(std::vector{50, 30, 20, 10}[i]);
+
+    auto house = std::make_shared<ChannelGroup>(mixer, "house");
+    auto first = std::make_shared<ChannelGroup>(mixer, "first");
+    auto second = std::make_shared<ChannelGroup>(mixer, "second");
+    first->add(v[0]);
+    first->add(v[1]);
+    second->add(v[2]);
+    second->add(v[3]);
+    CHECK(house->add(first));
+    CHECK(house->add(second));
+    house->add(v[0]); // already a member through the first floor
+    CHECK(!first->add(house)); // cycle
+    CHECK(house->volumes().size() == 4);
+    CHECK(house->maxVolume() == 50);
+
+    house->adjust(-40);
+    CHECK(levelsAre(v, {10, 0, 0, 0}));
+    house->adjust(40);
+    CHECK(levelsAre(v, {50, 30, 20, 10}));
+
+    house->setVolume(80);
+    CHECK(levelsAre(v, {80, 60, 50, 40}));
+
+    second->fadeTo(5, std::chrono::milliseconds(100));
+    CHECK(levelsAre(v, {80, 60, 5, 0}));
+
+    house->setMute(true);
+    CHECK(eventually([&] { return house->isMuted(); }));
+    house->setMute(false);
+    CHECK(eventually([&] { return !house->isMuted(); }));
+}
+
+/// @brief Quantized member and a balanced member come back to their levels after a move through zero.
+static void quantizedRoundTrip()
+{
+    FakeChannel quantized{0, "Quantized"};
+    quantized.rawMin = 0;
+    quantized.rawMax = 10; // 11 raw steps of 5 dB
+    quantized.dbMin = -5000;
+    FakeChannel balanced{0, "Balanced"};
+    FakeMixer mixer({quantized, balanced});
+    auto q = mixer.channels().front();
+    auto b = mixer.channels().back();
+    q->setVolume(100);
+    b->setVolume(60);
+    b->setBalance(40);
+    int levels[2];
+    b->getChannelVolumes(levels);
+    CHECK(levels[0] == 36 && levels[1] == 60);
+
+    ChannelGroup group(mixer, "group");
+    group.add(q);
+    group.add(b);
+    group.setVolume(0);
+    group.setVolume(37);
+    group.setVolume(100);
+    CHECK(q->getVolume() == 100);
+    b->getChannelVolumes(levels);
+    CHECK(levels[0] == 36 && levels[1] == 60);
+}
+
+/// @brief Starting a fade does not wait for a slow card.
+static void fadeOnSlowCard()
+{
+    FakeChannel slow{1, "Slow"};
+    slow.readLatency = slow.writeLatency = std::chrono::milliseconds(30);
+    FakeMixer mixer({FakeChannel{0, "Fast"}, slow});
+    std::vector<std::shared_ptr<IVolume>> v(mixer.channels().begin(), mixer.channels().end());
+    v[0]->setVolume(60);
+    v[1]->setVolume(40);
+    ChannelGroup group(mixer, "group");
+    group.add(v[0]);
+    group.add(v[1]);
+
+    auto start = std::chrono::steady_clock::now();
+    group.fadeTo(80, std::chrono::milliseconds(100));
+    CHECK(std::chrono::steady_clock::now() - start < std::chrono::milliseconds(20));
+    CHECK(levelsAre(v, {80, 60}));
+}
+
+/// @brief Group calls made on scheduler threads do not wait for each other.
+static void callsFromSchedulerThreads()
+{
+    FakeMixer mixer({FakeChannel{0, "A"}, FakeChannel{1, "B"}});
+    ChannelGroup group(mixer, "group");
+    for (const auto &volume : mixer.channels())
+        group.add(volume);
+
+    std::promise<void> volumeSet, muted;
+    Scheduler::forCard(0).post([&] { group.setVolume(40); volumeSet.set_value(); });
+    Scheduler::forCard(1).post([&] { group.setMute(true); muted.set_value(); });
+    CHECK(volumeSet.get_future().wait_for(std::chrono::seconds(2)) == std::future_status::ready);
+    CHECK(muted.get_future().wait_for(std::chrono::seconds(2)) == std::future_status::ready);
+
+    group.setMute(false);
+    group.setVolume(70);
+    std::vector<std::shared_ptr<IVolume>> v(mixer.channels().begin(), mixer.channels().end());
+    CHECK(levelsAre(v, {70, 70}));
+}
+
+int main()
+{
+    nestedRoundTrip();
+    quantizedRoundTrip();
+    fadeOnSlowCard();
+    callsFromSchedulerThreads();
+    return testResult("amixer_group_test");
+}
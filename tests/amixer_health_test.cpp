@@ -0,0 +1,157 @@
+/*
+
+Copyright (c) 2025 Pawel Sklarow https://github.com/psklarow
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+of the Software, and to permit persons to whom the Software is furnished to do
+so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+ */
+
+/// @file amixer_health_test.cpp
+/// @brief Checks of the retry and backoff policy of CardHealthState, driven by scripted call results.
+/// A busy card is retried with growing pauses and, if it stays busy, fails fast until the backoff
+/// expires; a card reporting ENODEV fails without any call until it is reset, and errors which are
+/// not card failures are returned as they are. The health FakeMixer reports is checked as well.
+///
+/// Note: this code has been developed with AI assistance.
+///
+/// To build and run from the repository root use e.g.:
+///     c++ -std=c++23 -I. tests/amixer_health_test.cpp amixer_fake.cpp amixer_balance.cpp amixer_scheduler.cpp amixer_metrics.cpp amixer_trace.cpp -o amixer_health_test -Wall -Wextra -Wpedantic -Werror && ./amixer_health_test
+
+#include "tests/amixer_test.hpp"
+#include "amixer_fake.hpp"
+#include "amixer_health.hpp"
+#include <vector>
+
+using namespace std::chrono_literals;
+
+/// @brief ALSA call returning scripted results, the last one for all further calls.
+struct Script {
+    std::vector<int> results;
+    std::size_t calls{0};
+    std::vector<CardHealthState::Clock::duration> pauses{};
+
+    int run(CardHealthState &health) {
+        return health.call(
+            [this] { return results[std::min(calls++, results.size() - 1)]; },
+            [this](CardHealthState::Clock::duration delay) { pauses.push_back(delay); return true; });
+    }
+};
+
+/// @brief Transient errors are retried with doubling pauses and leave the card healthy on success.
+static void transientErrors()
+{
+    CardHealthState health;
+    Script script{{-EBUSY, -EAGAIN, 5}};
+    CHECK(script.run(health) == 5);
+    CHECK(script.calls == 3);
+    CHECK((script.pauses == std::vector<CardHealthState::Clock::duration>{1ms, 2ms}));
+    CHECK(health.state() == CardHealth::Healthy);
+}
+
+/// @brief A card busy through all retries is degraded and fails fast until the backoff expires.
+static void backoff()
+{
+    CardHealthState health;
+    Script busy{{-EBUSY}};
+    CHECK(busy.run(health) == -EBUSY);
+    CHECK(busy.calls == 4);
+    CHECK((busy.pauses == std::vector<CardHealthState::Clock::duration>{1ms, 2ms, 4ms}));
+    CHECK(health.state() == CardHealth::Degraded);
+
+    CHECK(busy.run(health) == -EBUSY);
+    CHECK(busy.calls == 4); // failed fast
+
+    std::this_thread::sleep_for(15ms); // first backoff is 10 ms
+    CHECK(busy.run(health) == -EBUSY);
+    CHECK(busy.calls == 8);
+    CHECK(busy.run(health) == -EBUSY); // backoff doubled to 20 ms
+    CHECK(busy.calls == 8);
+
+    Script recovered{{0}};
+    CHECK(eventually([&] { return recovered.run(health) == 0; }, 100ms));
+    CHECK(health.state() == CardHealth::Healthy);
+    CHECK(busy.run(health) == -EBUSY);
+    CHECK(health.state() == CardHealth::Degraded);
+    CHECK(recovered.calls == 1);
+}
+
+/// @brief A removed card fails without calls until reset; other errors do not change the health.
+static void goneAndOtherErrors()
+{
+    CardHealthState health;
+    Script invalid{{-EINVAL}};
+    CHECK(invalid.run(health) == -EINVAL);
+    CHECK(invalid.calls == 1);
+    CHECK(health.state() == CardHealth::Healthy);
+
+    Script gone{{-ENXIO}};
+    CHECK(gone.run(health) == -ENXIO);
+    CHECK(health.state() == CardHealth::Gone);
+    CHECK(gone.run(health) == -ENODEV);
+    CHECK(gone.calls == 1);
+    health.reset();
+    CHECK(health.state() == CardHealth::Healthy);
+    health.markGone();
+    CHECK(health.state() == CardHealth::Gone);
+}
+
+/// @brief A retry refused by the pause (e.g. the element changed meanwhile) returns the error at once.
+static void refusedRetry()
+{
+    CardHealthState health;
+    int calls = 0;
+    CHECK(health.call([&] { ++calls; return -EINTR; }, [](CardHealthState::Clock::duration) { return false; }) == -EINTR);
+    CHECK(calls == 1);
+    CHECK(health.state() == CardHealth::Healthy);
+    CHECK(&CardHealthState::of(2) == &CardHealthState::of(2));
+    CHECK(&CardHealthState::of(2) != &CardHealthState::of(3));
+}
+
+/// @brief Fallible calls of FakeMixer report the health set for the card.
+static void fakeCardHealth()
+{
+    FakeMixer mixer({FakeChannel{0, "Speaker"}, FakeChannel{1, "Sub"}});
+    auto speaker = mixer.channels().front();
+    auto sub = mixer.channels().back();
+    CHECK(speaker->trySetVolume(30).has_value());
+
+    mixer.setCardHealth(0, CardHealth::Degraded);
+    CHECK(mixer.cardHealth(0) == CardHealth::Degraded);
+    auto busy = speaker->trySetVolume(40);
+    CHECK(!busy && busy.error() == std::errc::device_or_resource_busy);
+    CHECK(sub->trySetVolume(40).has_value());
+
+    mixer.setCardHealth(0, CardHealth::Gone);
+    auto gone = speaker->tryGetVolume();
+    CHECK(!gone && gone.error() == std::errc::no_such_device);
+    CHECK(speaker->getVolume() == 30);
+
+    mixer.setCardHealth(0, CardHealth::Healthy);
+    CHECK(speaker->trySetVolume(50).has_value());
+    CHECK(speaker->getVolume() == 50);
+}
+
+int main()
+{
+    transientErrors();
+    backoff();
+    goneAndOtherErrors();
+    refusedRetry();
+    fakeCardHealth();
+    return testResult("amixer_health_test");
+}
@@ -0,0 +1,113 @@
+/*
+
+Copyright (c) 2025 Pawel Sklarow https://github.com/psklarow
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+of the Software, and to permit persons to whom the Software is furnished to do
+so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+ */
+
+/// @file amixer_link_test.cpp
+/// @brief Checks of IMixer::link() and unlink() on FakeMixer.
+/// A slave channel tracks volume, mute and balance of its master at a dB offset, links chain and
+/// can be replaced, loops and channels of another mixer are refused, and an unlinked slave keeps
+/// the level it had.
+///
+/// Note: this code has been developed with AI assistance.
+///
+/// To build and run from the repository root use e.g.:
+///     c++ -std=c++23 -I. tests/amixer_link_test.cpp amixer_fake.cpp amixer_balance.cpp amixer_scheduler.cpp amixer_metrics.cpp amixer_trace.cpp -o amixer_link_test -Wall -Wextra -Wpedantic -Werror && ./amixer_link_test
+
+#include "tests/amixer_test.hpp"
+#include "amixer_fake.hpp"
+#include "amixer_balance.hpp"
+#include <cerrno>
+#include <cmath>
+#include <cstdlib>
+#include <memory>
+
+/// @brief Expected slave volume for a master volume, both on linear dB scales.
+static int followed(int masterVolume, long masterDbMin, double offsetDb, long slaveDbMin)
+{
+    double masterDb = masterDbMin - masterDbMin * masterVolume / 100.0; // 1/100 dB, scale up to 0 dB
+    double slaveDb = masterDb + offsetDb * 100.0;
+    return std::clamp(static_cast<int>(std::lround(100.0 * (slaveDb - slaveDbMin) / -slaveDbMin)), 0, 100);
+}
+
+int main()
+{
+    FakeChannel speaker{0, "Speaker"};
+    speaker.dbMin = -6400;
+    FakeChannel woofer{1, "Woofer", false, 1};
+    woofer.dbMin = -4000;
+    FakeChannel rear{1, "Rear"};
+    rear.dbMin = -4000;
+    FakeMixer mixer({speaker, woofer, rear});
+
+    auto it = mixer.channels().begin();
+    auto master = *it++;
+    auto slave = *it++;
+    auto chained = *it;
+
+    // linking applies the master state at once
+    master->setVolume(80);
+    master->setBalance(-20);
+    CHECK(mixer.link(master, slave, -6.0));
+    CHECK(slave->getVolume() == followed(80, -6400, -6.0, -4000));
+
+    // volume and mute follow the master
+    master->setVolume(50);
+    CHECK(slave->getVolume() == followed(50, -6400, -6.0, -4000));
+    master->setMute(true);
+    CHECK(slave->isMuted());
+    master->setMute(false);
+    CHECK(!slave->isMuted());
+    CHECK(slave->getVolume() == followed(50, -6400, -6.0, -4000));
+
+    // a stereo slave follows the balance too, and links chain
+    CHECK(mixer.link(slave, chained, 0.0));
+    master->setVolume(90);
+    CHECK(chained->getVolume() == slave->getVolume());
+    CHECK(mixer.link(master, chained, -3.0)); // relinking replaces the previous master
+    master->setVolume(70);
+    CHECK(chained->getVolume() == followed(70, -6400, -3.0, -4000));
+    CHECK(std::abs(appliedBalance(chained->getVolume(), chained->getBalance()) - appliedBalance(70, master->getBalance())) <= 2);
+
+    // loops and foreign channels are rejected
+    errno = 0;
+    CHECK(!mixer.link(slave, master, 0.0));
+    CHECK(errno == EINVAL);
+    FakeMixer other({speaker});
+    errno = 0;
+    CHECK(!mixer.link(master, other.channels().front(), 0.0));
+    CHECK(errno == EINVAL);
+
+    // master at zero silences the slave
+    master->setVolume(0);
+    CHECK(slave->getVolume() == 0);
+
+    // unlinked slaves keep their state and stop following
+    master->setVolume(60);
+    int kept = slave->getVolume();
+    CHECK(mixer.unlink(slave));
+    CHECK(!mixer.unlink(slave));
+    master->setVolume(20);
+    CHECK(slave->getVolume() == kept);
+    CHECK(mixer.unlink(chained));
+
+    return testResult("amixer_link_test");
+}
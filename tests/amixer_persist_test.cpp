@@ -0,0 +1,117 @@
+/*
+
+Copyright (c) 2025 Pawel Sklarow https://github.com/psklarow
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+of the Software, and to permit persons to whom the Software is furnished to do
+so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+ */
+
+/// @file amixer_persist_test.cpp
+/// @brief Checks of StatePersistence against a temporary state file.
+/// Two identical USB DACs swap card numbers between saving and restoring; each must still get its
+/// own volume, balance and mute back. Also covers the delayed write-behind and a missing file.
+///
+/// Note: this code has been developed with AI assistance.
+///
+/// To build and run from the repository root use e.g.:
+///     c++ -std=c++23 -I. tests/amixer_persist_test.cpp amixer_persist.cpp amixer_fake.cpp amixer_balance.cpp amixer_scheduler.cpp amixer_metrics.cpp amixer_trace.cpp -o amixer_persist_test -Wall -Wextra -Wpedantic -Werror && ./amixer_persist_test
+
+#include "tests/amixer_test.hpp"
+#include "amixer_fake.hpp"
+#include "amixer_persist.hpp"
+#include <filesystem>
+#include <string>
+#include <unistd.h>
+
+/// @brief Two identical DACs on different USB ports swap card numbers between save and restore.
+static void renumberedRoundTrip(const std::string &path)
+{
+    FakeChannel first{1, "PCM"};
+    first.cardId = "DAC";
+    first.cardLongName = "DAC at usb-1";
+    FakeChannel second{2, "PCM"};
+    second.cardId = "DAC";
+    second.cardLongName = "DAC at usb-2";
+
+    int saved[2];
+    {
+        FakeMixer mixer({first, second});
+        StatePersistence persistence(mixer, path);
+        mixer.channels().front()->setVolume(30);
+        mixer.channels().back()->setVolume(70);
+        mixer.channels().back()->setBalance(-20);
+        mixer.channels().back()->setMute(true);
+        mixer.channels().back()->getChannelVolumes(saved);
+        CHECK(persistence.flush());
+    }
+
+    first.card = 3;
+    second.card = 1;
+    FakeMixer mixer({first, second});
+    StatePersistence persistence(mixer, path);
+    CHECK(persistence.restore() == 2);
+    int levels[2];
+    for (const auto &volume : mixer.channels()) {
+        if (volume->getCard() == 3) {
+            CHECK(volume->getVolume() == 30);
+            CHECK(!volume->isMuted());
+        } else {
+            volume->getChannelVolumes(levels);
+            CHECK(levels[0] == saved[0] && levels[1] == saved[1]);
+            CHECK(volume->isMuted());
+        }
+    }
+}
+
+/// @brief Changes are written behind after the flush delay, and pending changes on destruction.
+static void writeBehind(const std::string &path)
+{
+    {
+        FakeMixer mixer({FakeChannel{0, "Master"}});
+        StatePersistence persistence(mixer, path, StatePersistence::Duration(20));
+        mixer.channels().front()->setVolume(42);
+        CHECK(eventually([&] { return std::filesystem::exists(path); }));
+        mixer.channels().front()->setVolume(43);
+    }
+
+    FakeMixer mixer({FakeChannel{0, "Master"}});
+    mixer.channels().front()->setVolume(0);
+    StatePersistence persistence(mixer, path);
+    CHECK(persistence.restore() == 1);
+    CHECK(mixer.channels().front()->getVolume() == 43);
+}
+
+/// @brief A missing file restores nothing.
+static void missingFile(const std::string &path)
+{
+    FakeMixer mixer({FakeChannel{0, "Master"}});
+    StatePersistence persistence(mixer, path);
+    CHECK(persistence.restore() == -1);
+}
+
+int main()
+{
+    const std::string path = (std::filesystem::temp_directory_path() / ("amixer_persist_test." + std::to_string(getpid()))).string();
+    unlink(path.c_str());
+    missingFile(path);
+    renumberedRoundTrip(path);
+    unlink(path.c_str());
+    writeBehind(path);
+    unlink(path.c_str());
+    return testResult("amixer_persist_test");
+}
@@ -0,0 +1,113 @@
+/*
+
+Copyright (c) 2025 Pawel Sklarow https://github.com/psklarow
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+of the Software, and to permit persons to whom the Software is furnished to do
+so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+ */
+
+/// @file amixer_record_test.cpp
+/// @brief Checks of RecordingMixer and replay() on FakeMixer.
+/// A session of volume sweeps, links, capture levels and switches is written to a call log and
+/// replayed on a second mixer with the same channels, which must end up identical to the first.
+/// Replaying onto a mixer lacking some of the channels skips their calls and applies the rest.
+///
+/// Note: this code has been developed with AI assistance.
+///
+/// To build and run from the repository root use e.g.:
+///     c++ -std=c++23 -I. tests/amixer_record_test.cpp amixer_record.cpp amixer_fake.cpp amixer_balance.cpp amixer_scheduler.cpp amixer_metrics.cpp amixer_trace.cpp -o amixer_record_test -Wall -Wextra -Wpedantic -Werror && ./amixer_record_test
+
+#include "tests/amixer_test.hpp"
+#include "amixer_fake.hpp"
+#include "amixer_record.hpp"
+#include <filesystem>
+#include <iterator>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+/// @brief State of one channel compared after the replay.
+struct ChannelState {
+    std::vector<int> levels;
+    bool muted;
+    bool on;
+
+    bool operator==(const ChannelState &) const = default;
+};
+
+/// @brief Get state of all playback and capture channels of a mixer.
+static std::vector<ChannelState> stateOf(IMixer &mixer)
+{
+    std::vector<ChannelState> state;
+    for (const auto *list : {&mixer.channels(), &mixer.captureChannels()}) {
+        for (const auto &volume : *list) {
+            ChannelState channel{std::vector<int>(volume->channelCount()), volume->isMuted(), volume->getSwitch()};
+            volume->getChannelVolumes(channel.levels);
+            state.push_back(std::move(channel));
+        }
+    }
+    return state;
+}
+
+int main()
+{
+    const std::string path = (std::filesystem::temp_directory_path() / ("amixer_record_test." + std::to_string(getpid()))).string();
+    const std::vector<FakeChannel> layout{{0, "Speaker"}, {1, "Sub", false, 1}, {0, "Mic", true}};
+
+    FakeMixer recorded(layout);
+    {
+        RecordingMixer recording(recorded, path);
+        CHECK(recording.isOpen());
+        auto speaker = recording.channels().front();
+        auto sub = recording.channels().back();
+        auto mic = recording.captureChannels().front();
+
+        CHECK(recording.link(speaker, sub, -6.0));
+        for (int level = 0; level <= 100; level += 5)
+            speaker->setVolume(level);
+        speaker->setVolume(70);
+        speaker->setBalance(-30);
+        const int levels[] = {25, 55};
+        mic->setChannelVolumes(levels);
+        mic->setSwitch(false);
+        CHECK(recording.unlink(sub));
+        sub->setMute(true);
+        recording.getSnapshot();
+        recording.flush();
+    }
+
+    CallLog log;
+    CHECK(log.load(path));
+    CHECK(log.channels.size() == layout.size());
+    CHECK(log.calls.size() == 29); // link, 22 volumes, balance, channel volumes, switch, unlink, mute, snapshot
+
+    FakeMixer target(layout);
+    auto stats = replay(target, log, 0);
+    CHECK(stats.calls == log.calls.size());
+    CHECK(stats.skipped == 0);
+    CHECK(eventually([&] { return stateOf(target) == stateOf(recorded); }));
+
+    // channels missing in the target are skipped, the others are still replayed
+    FakeMixer partial({layout.front()});
+    stats = replay(partial, log, 0);
+    CHECK(stats.skipped > 0);
+    CHECK(partial.channels().front()->getVolume() == recorded.channels().front()->getVolume());
+
+    unlink(path.c_str());
+    return testResult("amixer_record_test");
+}
@@ -0,0 +1,122 @@
+/*
+
+Copyright (c) 2025 Pawel Sklarow https://github.com/psklarow
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+of the Software, and to permit persons to whom the Software is furnished to do
+so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+ */
+
+/// @file amixer_scene_test.cpp
+/// @brief Checks of SceneRegistry on FakeMixer.
+/// Activating a scene spanning two cards and a capture channel sets its levels and balances; an
+/// unknown scene is refused, and a card leaving and returning forces the scene to be recompiled.
+/// Activations issued from different card threads proceed independently.
+///
+/// Note: this code has been developed with AI assistance.
+///
+/// To build and run from the repository root use e.g.:
+///     c++ -std=c++23 -I. tests/amixer_scene_test.cpp amixer_scene.cpp amixer_fake.cpp amixer_balance.cpp amixer_scheduler.cpp amixer_metrics.cpp amixer_trace.cpp -o amixer_scene_test -Wall -Wextra -Wpedantic -Werror && ./amixer_scene_test
+
+#include "tests/amixer_test.hpp"
+#include "amixer_fake.hpp"
+#include "amixer_scene.hpp"
+#include <cerrno>
+#include <future>
+
+/// @brief Scene over two cards and a capture channel: levels, balance, missing scene and recompilation.
+static void activateRoundTrip()
+{
+    FakeChannel mic{1, "Mic", true};
+    mic.channels = 1;
+    FakeMixer mixer({FakeChannel{0, "Speaker"}, FakeChannel{1, "Speaker"}, mic});
+    SceneRegistry scenes(mixer);
+
+    CHECK(scenes.define("movie", {{0, "Speaker", false, 80, -50},
+                                  {1, "Speaker", false, 40, 0},
+                                  {1, "Mic", true, 30, 0},
+                                  {2, "Missing", false, 10, 0}}) == 3);
+    CHECK(scenes.define("quiet", {{-1, "Speaker", false, 20, 0}}) == 1);
+    CHECK((scenes.names() == std::vector<std::string>{"movie", "quiet"}));
+
+    CHECK(scenes.activate("movie") == 3);
+    int levels[2];
+    mixer.channels().front()->getChannelVolumes(levels);
+    CHECK(levels[0] == 80 && levels[1] == 40);
+    mixer.channels().back()->getChannelVolumes(levels);
+    CHECK(levels[0] == 40 && levels[1] == 40);
+    CHECK(mixer.captureChannels().front()->getVolume() == 30);
+
+    CHECK(scenes.activate("quiet") == 1);
+    CHECK(mixer.channels().front()->getVolume() == 20);
+    CHECK(mixer.channels().back()->getVolume() == 40);
+
+    errno = 0;
+    CHECK(scenes.activate("none") == -1 && errno == ENOENT);
+
+    scenes.invalidate();
+    CHECK(scenes.activate("movie") == 3);
+    mixer.channels().front()->getChannelVolumes(levels);
+    CHECK(levels[0] == 80 && levels[1] == 40);
+
+    CHECK(scenes.remove("quiet"));
+    CHECK(!scenes.remove("quiet"));
+    CHECK(scenes.names().size() == 1);
+}
+
+/// @brief A card going away and coming back bumps the layout generation; the scene still applies afterwards.
+static void layoutChange()
+{
+    FakeMixer mixer({FakeChannel{0, "A"}, FakeChannel{1, "B"}});
+    SceneRegistry scenes(mixer);
+    CHECK(scenes.define("scene", {{0, "A", false, 10, 0}, {1, "B", false, 20, 0}}) == 2);
+
+    auto layout = mixer.layoutGeneration();
+    mixer.setCardHealth(1, CardHealth::Gone);
+    CHECK(mixer.layoutGeneration() > layout);
+    mixer.setCardHealth(1, CardHealth::Healthy);
+    CHECK(scenes.activate("scene") == 2);
+    CHECK(mixer.channels().front()->getVolume() == 10);
+    CHECK(mixer.channels().back()->getVolume() == 20);
+}
+
+/// @brief Scenes activated on scheduler threads of different cards do not wait for each other.
+static void activateFromSchedulerThreads()
+{
+    FakeMixer mixer({FakeChannel{0, "A"}, FakeChannel{1, "B"}});
+    SceneRegistry scenes(mixer);
+    scenes.define("first", {{0, "A", false, 10, 0}, {1, "B", false, 20, 0}});
+    scenes.define("second", {{0, "A", false, 30, 0}, {1, "B", false, 40, 0}});
+
+    std::promise<void> first, second;
+    Scheduler::forCard(0).post([&] { scenes.activate("first"); first.set_value(); });
+    Scheduler::forCard(1).post([&] { scenes.activate("second"); second.set_value(); });
+    CHECK(first.get_future().wait_for(std::chrono::seconds(2)) == std::future_status::ready);
+    CHECK(second.get_future().wait_for(std::chrono::seconds(2)) == std::future_status::ready);
+
+    CHECK(scenes.activate("first") == 2);
+    CHECK(mixer.channels().front()->getVolume() == 10);
+    CHECK(mixer.channels().back()->getVolume() == 20);
+}
+
+int main()
+{
+    activateRoundTrip();
+    layoutChange();
+    activateFromSchedulerThreads();
+    return testResult("amixer_scene_test");
+}
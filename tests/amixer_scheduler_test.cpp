@@ -0,0 +1,175 @@
+/*
+
+Copyright (c) 2025 Pawel Sklarow https://github.com/psklarow
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+of the Software, and to permit persons to whom the Software is furnished to do
+so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+ */
+
+/// @file amixer_scheduler_test.cpp
+/// @brief Checks of the timer task scheduler and the card schedulers.
+/// Tasks run in time order and, for equal times, in the order they were posted; each card has its
+/// own thread, so a card kept busy does not hold up another. forEachCard() waits for all cards from
+/// an application thread, but must neither wait nor deadlock when card threads fan out to each other.
+///
+/// Note: this code has been developed with AI assistance.
+///
+/// To build and run from the repository root use e.g.:
+///     c++ -std=c++23 -I. tests/amixer_scheduler_test.cpp amixer_scheduler.cpp amixer_metrics.cpp amixer_trace.cpp -o amixer_scheduler_test -Wall -Wextra -Wpedantic -Werror && ./amixer_scheduler_test
+
+#include "tests/amixer_test.hpp"
+#include "amixer_scheduler.hpp"
+#include <atomic>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+using namespace std::chrono_literals;
+
+/// @brief Tasks run by due time; equal times keep the posting order.
+static void taskOrder()
+{
+    Scheduler scheduler;
+    std::mutex mutex;
+    std::vector<int> order;
+    auto append = [&](int value) {
+        return [&, value] {
+            std::lock_guard lock(mutex);
+            order.push_back(value);
+        };
+    };
+
+    std::promise<void> hold;
+    scheduler.post([held = hold.get_future().share()] { held.wait(); });
+    auto now = Scheduler::Clock::now();
+    scheduler.schedule(now + 30ms, append(4));
+    scheduler.schedule(now + 10ms, append(2));
+    scheduler.schedule(now + 10ms, append(3));
+    scheduler.post(append(0));
+    scheduler.post(append(1));
+    hold.set_value();
+
+    CHECK(eventually([&] { std::lock_guard lock(mutex); return order.size() == 5; }));
+    std::lock_guard lock(mutex);
+    CHECK((order == std::vector<int>{0, 1, 2, 3, 4}));
+}
+
+/// @brief A delayed task does not run early, and runs on the scheduler thread.
+static void delayedTask()
+{
+    Scheduler scheduler;
+    CHECK(!scheduler.isSchedulerThread());
+    CHECK(!Scheduler::onSchedulerThread());
+
+    std::promise<Scheduler::Clock::time_point> ran;
+    std::atomic<bool> onThread{false};
+    auto start = Scheduler::Clock::now();
+    scheduler.scheduleAfter(20ms, [&] {
+        onThread = scheduler.isSchedulerThread() && Scheduler::onSchedulerThread();
+        ran.set_value(Scheduler::Clock::now());
+    });
+    auto result = ran.get_future();
+    CHECK(result.wait_for(2s) == std::future_status::ready);
+    CHECK(result.get() - start >= 20ms);
+    CHECK(onThread);
+}
+
+/// @brief Each card gets one scheduler of its own; a busy card does not delay another.
+static void cardSchedulers()
+{
+    CHECK(&Scheduler::forCard(0) == &Scheduler::forCard(0));
+    CHECK(&Scheduler::forCard(0) != &Scheduler::forCard(1));
+
+    std::promise<void> hold;
+    Scheduler::forCard(0).post([held = hold.get_future().share()] { held.wait(); });
+    std::promise<void> other;
+    Scheduler::forCard(1).post([&] { other.set_value(); });
+    CHECK(other.get_future().wait_for(2s) == std::future_status::ready);
+    hold.set_value();
+}
+
+/// @brief forEachCard() from an application thread runs on every card thread and waits for them.
+static void fanOutWaits()
+{
+    const int cards[] = {0, 1, 2};
+    auto ran = std::make_shared<std::vector<std::atomic<bool>>>(3);
+    CHECK(Scheduler::forEachCard(cards, [ran, cards](std::size_t i) {
+        (*ran)[i] = Scheduler::forCard(cards[i]).isSchedulerThread();
+    }));
+    for (const auto &card : *ran)
+        CHECK(card);
+}
+
+/// @brief Card threads fanning out to each other at the same time do not deadlock.
+/// The task of the calling card runs inline and the call returns without waiting for the others.
+static void fanOutFromCardThreads()
+{
+    const int cards[] = {0, 1};
+    auto count = std::make_shared<std::atomic<int>>(0);
+    std::promise<void> first, second;
+    std::atomic<bool> waited{false}, inlined{false};
+    Scheduler::forCard(0).post([&, count, cards] {
+        bool inlineRun = false;
+        waited = Scheduler::forEachCard(cards, [count, &inlineRun](std::size_t i) {
+            if (i == 0)
+                inlineRun = true;
+            ++*count;
+        });
+        inlined = inlineRun;
+        first.set_value();
+    });
+    Scheduler::forCard(1).post([&, count, cards] {
+        Scheduler::forEachCard(cards, [count](std::size_t) { ++*count; });
+        second.set_value();
+    });
+    CHECK(first.get_future().wait_for(2s) == std::future_status::ready);
+    CHECK(second.get_future().wait_for(2s) == std::future_status::ready);
+    CHECK(!waited);
+    CHECK(inlined);
+    CHECK(eventually([&] { return *count == 4; }));
+}
+
+/// @brief Fade step intervals follow the measured round trip, within the limits.
+static void stepIntervals()
+{
+    ControlLatency latency;
+    CHECK(latency.stepInterval(3, 7ms) == 7ms);
+    latency.record(3, 6ms);
+    CHECK(latency.roundTrip(3) == 6ms);
+    CHECK(latency.stepInterval(3, 7ms) == 12ms);
+    latency.record(3, 10ms);
+    CHECK(latency.roundTrip(3) == 7ms); // smoothed with weight 1/4
+    latency.record(4, 50us);
+    CHECK(latency.stepInterval(4, 7ms) == ControlLatency::minStep);
+    latency.record(5, 1s);
+    CHECK(latency.stepInterval(5, 7ms) == ControlLatency::maxStep);
+    CHECK(latency.resolve(3, 5ms, 7ms) == 5ms);
+    CHECK(latency.resolve(4, std::chrono::milliseconds::zero(), 7ms) == 1ms);
+}
+
+int main()
+{
+    taskOrder();
+    delayedTask();
+    cardSchedulers();
+    fanOutWaits();
+    fanOutFromCardThreads();
+    stepIntervals();
+    return testResult("amixer_scheduler_test");
+}
@@ -0,0 +1,218 @@
+/*
+
+Copyright (c) 2025 Pawel Sklarow https://github.com/psklarow
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+of the Software, and to permit persons to whom the Software is furnished to do
+so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+ */
+
+/// @file amixer_server_test.cpp
+/// @brief Checks of the shared memory command ring of the volume server.
+/// Producers on several threads must never lose, duplicate or reorder their own commands, and a full
+/// ring must refuse a command instead of overwriting one. A slot claimed by a process which died
+/// before publishing it must neither block the consumer nor other producers for good. Finally a
+/// VolumeServer on FakeMixer applies commands a client posts through the ring.
+///
+/// Note: this code has been developed with AI assistance.
+///
+/// To build and run from the repository root use e.g.:
+///     c++ -std=c++23 -I. tests/amixer_server_test.cpp amixer_server.cpp amixer_fake.cpp amixer_balance.cpp amixer_scheduler.cpp amixer_metrics.cpp amixer_trace.cpp -o amixer_server_test -Wall -Wextra -Wpedantic -Werror && ./amixer_server_test
+
+#include "tests/amixer_test.hpp"
+#include "amixer_fake.hpp"
+#include "amixer_server.hpp"
+#include <memory>
+#include <string>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <vector>
+
+using namespace std::chrono_literals;
+
+/// @brief Make a command carrying a value, to identify it when popped.
+static VolumeCommand command(std::uint32_t channel, std::int32_t value)
+{
+    return VolumeCommand{VolumeCommand::SetVolume, channel, value, 0};
+}
+
+/// @brief Get pid of a process which has exited and been reaped.
+static pid_t deadProcess()
+{
+    pid_t child = fork();
+    if (child == 0)
+        _exit(0);
+    waitpid(child, nullptr, 0);
+    return child;
+}
+
+/// @brief Commands come out in order; a full ring refuses more until a slot is consumed.
+static void orderAndCapacity()
+{
+    auto ring = std::make_unique<SharedCommandRing>();
+    ring->init();
+    VolumeCommand popped{};
+    CHECK(!ring->pop(popped));
+
+    for (std::size_t i = 0; i < SharedCommandRing::capacity; ++i)
+        CHECK(ring->push(command(0, static_cast<std::int32_t>(i))));
+    CHECK(!ring->push(command(0, -1)));
+    CHECK(ring->pop(popped));
+    CHECK(popped.value == 0);
+    CHECK(ring->push(command(0, -1)));
+
+    for (std::size_t i = 1; i < SharedCommandRing::capacity; ++i) {
+        CHECK(ring->pop(popped));
+        CHECK(popped.value == static_cast<std::int32_t>(i));
+    }
+    CHECK(ring->pop(popped));
+    CHECK(popped.value == -1);
+    CHECK(!ring->pop(popped));
+    CHECK(!ring->stalled());
+}
+
+/// @brief Concurrent producers: every command arrives once, in the order of its producer.
+static void concurrentProducers()
+{
+    constexpr std::uint32_t producers = 4;
+    constexpr std::int32_t perProducer = 20000;
+    auto ring = std::make_unique<SharedCommandRing>();
+    ring->init();
+
+    std::vector<std::thread> threads;
+    for (std::uint32_t p = 0; p < producers; ++p) {
+        threads.emplace_back([&ring, p] {
+            for (std::int32_t k = 0; k < perProducer; ++k) {
+                while (!ring->push(command(p, k)))
+                    std::this_thread::yield();
+            }
+        });
+    }
+
+    std::vector<std::int32_t> next(producers, 0);
+    bool ordered = true;
+    for (std::int64_t received = 0; received < producers * perProducer;) {
+        VolumeCommand popped{};
+        if (!ring->pop(popped)) {
+            ring->wait(1ms);
+            continue;
+        }
+        ordered = ordered && popped.channel < producers && popped.value == next[popped.channel];
+        if (popped.channel < producers)
+            ++next[popped.channel];
+        ++received;
+    }
+    for (auto &thread : threads)
+        thread.join();
+    CHECK(ordered);
+    CHECK((next == std::vector<std::int32_t>(producers, perProducer)));
+}
+
+/// @brief A slot claimed by a dead producer is skipped by the consumer, one of a live producer is not.
+static void abandonedSlot()
+{
+    auto ring = std::make_unique<SharedCommandRing>();
+    ring->init();
+    CHECK(ring->push(command(0, 1)));
+
+    // claim the next slot the way a producer does before it publishes the command
+    auto claim = [&](pid_t owner) {
+        auto position = ring->head.load();
+        ring->slots[position & (SharedCommandRing::capacity - 1)].owner = owner;
+        ring->head = position + 1;
+    };
+    claim(deadProcess());
+    CHECK(ring->push(command(0, 3)));
+
+    VolumeCommand popped{};
+    CHECK(ring->pop(popped));
+    CHECK(popped.value == 1);
+    CHECK(!ring->pop(popped));
+    CHECK(ring->stalled());
+    CHECK(ring->skipAbandoned());
+    CHECK(!ring->stalled());
+    CHECK(ring->pop(popped));
+    CHECK(popped.value == 3);
+
+    claim(getpid()); // still publishing
+    CHECK(ring->stalled());
+    CHECK(!ring->skipAbandoned());
+}
+
+/// @brief A producer takes over a slot whose owner died before claiming its position.
+static void deadOwnerTakeover()
+{
+    auto ring = std::make_unique<SharedCommandRing>();
+    ring->init();
+    ring->slots[0].owner = deadProcess();
+    CHECK(ring->push(command(0, 7)));
+    VolumeCommand popped{};
+    CHECK(ring->pop(popped));
+    CHECK(popped.value == 7);
+}
+
+/// @brief A sleeping consumer wakes up when a command is pushed.
+static void wakeUp()
+{
+    auto ring = std::make_unique<SharedCommandRing>();
+    ring->init();
+    auto producer = std::thread([&ring] {
+        std::this_thread::sleep_for(20ms);
+        ring->push(command(0, 9));
+    });
+    auto start = std::chrono::steady_clock::now();
+    ring->wait(5000ms);
+    CHECK(std::chrono::steady_clock::now() - start < 2000ms);
+    producer.join();
+    VolumeCommand popped{};
+    CHECK(ring->pop(popped));
+    CHECK(popped.value == 9);
+}
+
+/// @brief Commands posted through the ring reach the mixer; the last volume of a burst wins.
+static void serverRoundTrip()
+{
+    FakeMixer mixer({FakeChannel{0, "Speaker"}, FakeChannel{1, "Sub"}});
+    auto name = "/amixer-server-test-" + std::to_string(getpid());
+    auto socket = "/tmp/amixer-server-test-" + std::to_string(getpid()) + ".sock";
+    VolumeServer server(mixer, name, socket);
+    CHECK(server.start());
+    std::thread serving([&server] { server.run(); });
+
+    VolumeClient client(name, socket);
+    CHECK(client.connect());
+    for (int level = 40; level <= 60; ++level)
+        CHECK(client.postVolume(1, level));
+    CHECK(client.postMute(0, true));
+    CHECK(eventually([&] { return client.getVolume(1) == 60 && client.isMuted(0); }));
+    CHECK(mixer.channels().back()->getVolume() == 60);
+    CHECK(mixer.channels().front()->isMuted());
+
+    server.stop();
+    serving.join();
+}
+
+int main()
+{
+    orderAndCapacity();
+    concurrentProducers();
+    abandonedSlot();
+    deadOwnerTakeover();
+    wakeUp();
+    serverRoundTrip();
+    return testResult("amixer_server_test");
+}
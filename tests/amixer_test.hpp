@@ -0,0 +1,74 @@
+/*
+
+Copyright (c) 2025 Pawel Sklarow https://github.com/psklarow
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies
+of the Software, and to permit persons to whom the Software is furnished to do
+so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+ */
+
+ // Note: this code has been developed with AI assistance.
+
+/// @file amixer_test.hpp
+/// @brief Minimal checks shared by the standalone test programs in this directory.
+/// Every test program builds against FakeMixer, needs no sound card and exits with 1 on failure.
+
+#ifndef __AMIXER_TEST_HPP__
+#define __AMIXER_TEST_HPP__
+
+#include <chrono>
+#include <print>
+#include <thread>
+
+/// @brief Number of failed checks of the test program.
+inline int testFailures = 0;
+
+/// @brief Check condition, reporting the failed expression with its location.
+#define CHECK(condition)                                                                      \
+    do {                                                                                      \
+        if (!(condition)) {                                                                   \
+            std::println(stderr, "{}:{}: check failed: {}", __FILE__, __LINE__, #condition);  \
+            ++testFailures;                                                                   \
+        }                                                                                     \
+    } while (0)
+
+/// @brief Wait until a condition holds, for changes applied on the Scheduler threads.
+/// @return true if the condition holds before the timeout.
+template <class Predicate>
+bool eventually(Predicate predicate, std::chrono::milliseconds timeout = std::chrono::milliseconds(2000))
+{
+    auto deadline = std::chrono::steady_clock::now() + timeout;
+    while (!predicate()) {
+        if (std::chrono::steady_clock::now() >= deadline)
+            return false;
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return true;
+}
+
+/// @brief Report the result of the test program.
+/// @return Exit code of the program, 0 if all checks passed.
+inline int testResult(const char *name)
+{
+    if (testFailures)
+        std::println(stderr, "{}: {} check(s) failed", name, testFailures);
+    else
+        std::println("{}: OK", name);
+    return testFailures ? 1 : 0;
+}
+
+#endif // __AMIXER_TEST_HPP__